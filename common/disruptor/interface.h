@@ -220,6 +220,14 @@ template <typename T> class ExceptionHandlerInterface {
                         const int64_t &sequence, T *event) = 0;
 };
 
+// Counters that describe how often consumers had to wait on a cursor
+// {@link Sequence}, and how far they had to back off while waiting.
+struct WaitStatistics {
+    int64_t waits = 0;  // calls in which the sequence was not yet available
+    int64_t yields = 0; // waits that gave up spinning and yielded the CPU
+    int64_t parks = 0;  // waits in which the consumer was put to sleep
+};
+
 // Strategy employed for making {@link EventProcessor}s wait on a cursor
 // {@link Sequence}.
 class WaitStrategyInterface {
@@ -262,6 +270,13 @@ class WaitStrategyInterface {
 
     // Signal those waiting that the cursor has advanced.
     virtual void SignalAllWhenBlocking() = 0;
+
+    // Statistics of the waits so far. Strategies that do not keep track of
+    // their waits report zero counts.
+    virtual WaitStatistics statistics() const { return WaitStatistics(); }
+
+    // Reset the wait statistics.
+    virtual void ResetStatistics() {}
 };
 
 }; // namespace disruptor
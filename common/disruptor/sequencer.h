@@ -157,6 +157,13 @@ class Sequencer {
         wait_strategy_->SignalAllWhenBlocking();
     }
 
+    // Statistics of the waits of consumers on this sequencer.
+    WaitStatistics wait_statistics() const {
+        return wait_strategy_->statistics();
+    }
+
+    void ResetWaitStatistics() { wait_strategy_->ResetStatistics(); }
+
     // TODO(fsaintjacques): This was added to overcome
     // NoOpEventProcessor::GetSequence(), this is not a clean solution.
     Sequence *GetSequencePtr() { return &cursor_; }
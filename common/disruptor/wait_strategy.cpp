@@ -1,5 +1,11 @@
 #include "wait_strategy.h"
 
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 namespace disruptor {
 
 WaitStrategyInterface *CreateWaitStrategy(WaitStrategyOption wait_option) {
@@ -12,9 +18,52 @@ WaitStrategyInterface *CreateWaitStrategy(WaitStrategyOption wait_option) {
         return new YieldingStrategy();
     case kBusySpinStrategy:
         return new BusySpinStrategy();
+    case kHybridStrategy:
+        return new HybridStrategy();
     default:
         return NULL;
     }
 }
 
+int64_t HybridStrategy::CalibratedSpinTries() {
+    // the latency of a pause instruction differs by an order of magnitude
+    // between CPU generations, so measure it once rather than hard-coding a
+    // number of iterations
+    static const int64_t tries = []() {
+        const int kIterations = 2000;
+        int64_t best_nanos = INT64_MAX;
+        for (int run = 0; run < 5; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            for (int k = 0; k < kIterations; ++k) {
+                CpuRelax();
+            }
+            int64_t nanos =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+            best_nanos = std::min(best_nanos, nanos);
+        }
+        best_nanos = std::max<int64_t>(best_nanos, 1);
+        int64_t n = kSpinMicros * 1000 * kIterations / best_nanos;
+        return std::min<int64_t>(std::max<int64_t>(n, 100), 1000000);
+    }();
+    return tries;
+}
+
+void HybridStrategy::FutexWait(std::atomic<int32_t> *word, int32_t expected,
+                               int64_t timeout_micros) {
+    struct timespec timeout;
+    timeout.tv_sec = timeout_micros / 1000000;
+    timeout.tv_nsec = (timeout_micros % 1000000) * 1000;
+    // returns immediately if the word no longer holds the expected value,
+    // spurious wake-ups are dealt with by the caller
+    syscall(SYS_futex, reinterpret_cast<int32_t *>(word), FUTEX_WAIT_PRIVATE,
+            expected, &timeout, NULL, 0);
+}
+
+void HybridStrategy::FutexWakeAll(std::atomic<int32_t> *word) {
+    syscall(SYS_futex, reinterpret_cast<int32_t *>(word), FUTEX_WAKE_PRIVATE,
+            INT_MAX, NULL, NULL, 0);
+}
+
 }; // namespace disruptor
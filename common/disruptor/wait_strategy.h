@@ -28,6 +28,12 @@
 
 #include <sys/time.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
@@ -56,7 +62,12 @@ enum WaitStrategyOption {
     kYieldingStrategy,
     // This strategy call spins in a loop as a waiting strategy which is
     // lowest and most consistent latency but ties up a CPU.
-    kBusySpinStrategy
+    kBusySpinStrategy,
+    // This strategy spins for a calibrated period, then yields and finally
+    // parks the waiting thread on a futex until the publisher signals. This
+    // gives close to busy spin latency for bursts of data, without tying up
+    // a CPU when there is no data.
+    kHybridStrategy
 };
 
 // Blocking strategy that uses a lock and condition variable for
@@ -374,6 +385,167 @@ class BusySpinStrategy : public WaitStrategyInterface {
     DISALLOW_COPY_AND_ASSIGN(BusySpinStrategy);
 };
 
+// Hybrid strategy for {@link EventProcessor}s waiting on a barrier. The
+// consumer first spins (with a pause instruction to go easy on the sibling
+// hyper-thread) for a period that is calibrated once at start-up, then yields
+// the CPU for a number of tries and finally parks on a futex. The publisher
+// only makes the wake-up system call if consumers are actually parked, so
+// that the cost of publishing stays close to that of the busy spin strategy.
+class HybridStrategy : public WaitStrategyInterface {
+  public:
+    HybridStrategy() : spin_tries_(CalibratedSpinTries()) {}
+
+    virtual int64_t WaitFor(const std::vector<Sequence *> &dependents,
+                            const Sequence &cursor,
+                            const SequenceBarrierInterface &barrier,
+                            const int64_t &sequence) {
+        return Wait(dependents, cursor, barrier, sequence, false, 0);
+    }
+
+    virtual int64_t WaitFor(const std::vector<Sequence *> &dependents,
+                            const Sequence &cursor,
+                            const SequenceBarrierInterface &barrier,
+                            const int64_t &sequence,
+                            const int64_t &timeout_micros) {
+        return Wait(dependents, cursor, barrier, sequence, true,
+                    timeout_micros);
+    }
+
+    virtual void SignalAllWhenBlocking() {
+        // pairs with the fence in Park: either the parking consumer sees the
+        // new cursor value, or we see the consumer in the waiters count
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            FutexWakeAll(&epoch_);
+        }
+    }
+
+    virtual WaitStatistics statistics() const {
+        WaitStatistics stats;
+        stats.waits = nwaits_.load(std::memory_order_relaxed);
+        stats.yields = nyields_.load(std::memory_order_relaxed);
+        stats.parks = nparks_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    virtual void ResetStatistics() {
+        nwaits_.store(0, std::memory_order_relaxed);
+        nyields_.store(0, std::memory_order_relaxed);
+        nparks_.store(0, std::memory_order_relaxed);
+    }
+
+    // target duration of the spinning phase
+    static const int64_t kSpinMicros = 20;
+    // number of times the CPU is yielded before parking
+    static const int kYieldTries = 50;
+    // upper bound on a single park, after which alerts are checked again
+    static const int64_t kParkMicros = 10000;
+
+    // number of pause iterations that take about kSpinMicros on this CPU
+    static int64_t CalibratedSpinTries();
+
+  private:
+    static inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    int64_t Wait(const std::vector<Sequence *> &dependents,
+                 const Sequence &cursor,
+                 const SequenceBarrierInterface &barrier,
+                 const int64_t &sequence, bool timed, int64_t timeout_micros) {
+        int64_t available_sequence = 0;
+
+        if ((available_sequence = cursor.sequence()) < sequence &&
+            (!timed || timeout_micros > 0)) {
+            nwaits_.fetch_add(1, std::memory_order_relaxed);
+
+            auto start = std::chrono::steady_clock::now();
+            int64_t counter = 0;
+            bool parked = false;
+
+            while ((available_sequence = cursor.sequence()) < sequence) {
+                barrier.CheckAlert();
+
+                int64_t remaining = kParkMicros;
+                if (timed) {
+                    int64_t elapsed =
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+                    if (timeout_micros < elapsed)
+                        break;
+                    remaining = std::min(remaining, timeout_micros - elapsed);
+                }
+
+                if (counter < spin_tries_) {
+                    CpuRelax();
+                } else if (counter < spin_tries_ + kYieldTries) {
+                    if (counter == spin_tries_) {
+                        nyields_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    std::this_thread::yield();
+                } else {
+                    if (!parked) {
+                        nparks_.fetch_add(1, std::memory_order_relaxed);
+                        parked = true;
+                    }
+                    Park(cursor, sequence, remaining);
+                }
+                ++counter;
+            }
+        }
+
+        if (0 != dependents.size()) {
+            int64_t counter = 0;
+            while ((available_sequence = GetMinimumSequence(dependents)) <
+                   sequence) {
+                barrier.CheckAlert();
+                if (counter < spin_tries_) {
+                    ++counter;
+                    CpuRelax();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        return available_sequence;
+    }
+
+    void Park(const Sequence &cursor, const int64_t &sequence,
+              int64_t timeout_micros) {
+        int32_t epoch = epoch_.load(std::memory_order_acquire);
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (cursor.sequence() < sequence) {
+            FutexWait(&epoch_, epoch, timeout_micros);
+        }
+        waiters_.fetch_sub(1, std::memory_order_release);
+    }
+
+    static void FutexWait(std::atomic<int32_t> *word, int32_t expected,
+                          int64_t timeout_micros);
+    static void FutexWakeAll(std::atomic<int32_t> *word);
+
+    const int64_t spin_tries_;
+
+    // futex word and number of parked consumers, on their own cache line
+    // since they are touched by the publisher for every published batch
+    alignas(CACHE_LINE_SIZE_IN_BYTES) std::atomic<int32_t> epoch_{0};
+    std::atomic<int32_t> waiters_{0};
+
+    alignas(CACHE_LINE_SIZE_IN_BYTES) std::atomic<int64_t> nwaits_{0};
+    std::atomic<int64_t> nyields_{0};
+    std::atomic<int64_t> nparks_{0};
+
+    DISALLOW_COPY_AND_ASSIGN(HybridStrategy);
+};
+
 WaitStrategyInterface *CreateWaitStrategy(WaitStrategyOption wait_option);
 
 }; // namespace disruptor
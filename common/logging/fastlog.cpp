@@ -0,0 +1,385 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "fastlog.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sstream>
+#include <thread>
+
+#include "g3log/logmessage.hpp"
+#include "logging/log.hpp"
+#include "utilities/spscqueue.hpp"
+
+namespace fastlog {
+
+namespace {
+
+using SystemClock = std::chrono::system_clock;
+using SteadyClock = std::chrono::steady_clock;
+
+struct Ring {
+    Ring(std::size_t capacity, std::string name)
+        : queue(capacity), thread(std::move(name)),
+          id(std::this_thread::get_id()) {}
+
+    SpscQueue<Record> queue;
+    // only written by the logging thread
+    std::atomic<uint64_t> nlogged{0};
+    std::atomic<uint64_t> ndropped{0};
+    std::atomic<bool> retired{false};
+    const std::string thread;
+    const std::thread::id id;
+    // only used by the background thread
+    uint64_t nreported = 0;
+    SteadyClock::time_point last_report;
+};
+
+// marks the ring of a thread as retired when the thread exits, so that the
+// background thread can release it once it is empty
+struct RingHandle {
+    ~RingHandle() {
+        if (ring) {
+            ring->retired.store(true, std::memory_order_release);
+        }
+    }
+    std::shared_ptr<Ring> ring;
+};
+
+thread_local RingHandle ring_handle;
+
+void increment(std::atomic<uint64_t> &counter) {
+    // single writer, avoids a locked read-modify-write
+    counter.store(counter.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+}
+
+std::string thread_name() {
+    char name[16] = {0};
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) != 0) {
+        return "unknown";
+    }
+    return name;
+}
+
+// converts time stamp counter readings to wall clock time: the tick rate is
+// measured against the monotonic clock since the start and the wall clock is
+// only used as reference for the most recent reading
+class TickConverter {
+  public:
+    TickConverter() : start_ticks_(ticks()), start_(SteadyClock::now()) {
+        update();
+    }
+
+    void update() {
+        ticks_ = ticks();
+        now_ = SystemClock::now();
+        double elapsed = std::chrono::duration<double, std::nano>(
+                             SteadyClock::now() - start_)
+                             .count();
+        if (ticks_ > start_ticks_ && elapsed > 0) {
+            nanos_per_tick_ = elapsed / (ticks_ - start_ticks_);
+        }
+    }
+
+    SystemClock::time_point convert(uint64_t ticks) const {
+        double delta = (static_cast<double>(ticks_) - ticks) * nanos_per_tick_;
+        return now_ - std::chrono::duration_cast<SystemClock::duration>(
+                          std::chrono::duration<double, std::nano>(delta));
+    }
+
+  protected:
+    const uint64_t start_ticks_;
+    const SteadyClock::time_point start_;
+    uint64_t ticks_ = 0;
+    SystemClock::time_point now_;
+    double nanos_per_tick_ = 1.;
+};
+
+void forward(const Record &record, SystemClock::time_point time,
+             std::thread::id thread) {
+    if (!g3::internal::isLoggingInitialized()) {
+        return;
+    }
+    const Site &site = *record.site;
+    g3::LogMessagePtr message{std::make_unique<g3::LogMessage>(
+        site.file, site.line, site.function, site.level)};
+    using LogTime = decltype(message.get()->_timestamp);
+    message.get()->_timestamp = LogTime(
+        std::chrono::duration_cast<LogTime::duration>(time.time_since_epoch()));
+    message.get()->_call_thread_id = thread;
+    message.get()->write().append(internal::format(record));
+    g3::internal::pushMessageToLogger(message);
+}
+
+class Logger {
+  public:
+    static Logger &instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    void Start(std::size_t capacity, std::chrono::milliseconds interval) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (thread_.joinable()) {
+            return;
+        }
+        capacity_ = capacity;
+        interval_ = interval;
+        stop_ = false;
+        thread_ = std::thread(&Logger::Run, this);
+        running_.store(true, std::memory_order_release);
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!thread_.joinable()) {
+                return;
+            }
+            running_.store(false, std::memory_order_release);
+            stop_ = true;
+        }
+        condition_.notify_one();
+        thread_.join();
+    }
+
+    std::shared_ptr<Ring> Register() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto ring = std::make_shared<Ring>(capacity_, thread_name());
+        rings_.push_back(ring);
+        return ring;
+    }
+
+    std::vector<ThreadStats> stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<ThreadStats> result;
+        for (auto &ring : rings_) {
+            if (!ring->retired.load(std::memory_order_acquire)) {
+                result.push_back(
+                    {ring->thread,
+                     ring->nlogged.load(std::memory_order_relaxed),
+                     ring->ndropped.load(std::memory_order_relaxed)});
+            }
+        }
+        return result;
+    }
+
+    uint64_t ndropped() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t n = ndropped_retired_;
+        for (auto &ring : rings_) {
+            n += ring->ndropped.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+  protected:
+    void Run() {
+        pthread_setname_np(pthread_self(), "fastlog");
+
+        TickConverter converter;
+        std::vector<std::shared_ptr<Ring>> rings;
+        std::vector<std::pair<Record, const Ring *>> batch;
+        Record record;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            bool stopping = stop_;
+            rings = rings_;
+            lock.unlock();
+
+            // a retired ring no longer receives records, so it can be
+            // released once it has been emptied
+            std::vector<const Ring *> released;
+            batch.clear();
+            for (auto &ring : rings) {
+                bool retired = ring->retired.load(std::memory_order_acquire);
+                while (ring->queue.pop(record)) {
+                    batch.emplace_back(record, ring.get());
+                }
+                report_drops(*ring, retired);
+                if (retired) {
+                    released.push_back(ring.get());
+                }
+            }
+
+            // restore the order between threads
+            std::stable_sort(batch.begin(), batch.end(),
+                             [](const auto &a, const auto &b) {
+                                 return a.first.ticks < b.first.ticks;
+                             });
+            converter.update();
+            for (auto &item : batch) {
+                forward(item.first, converter.convert(item.first.ticks),
+                        item.second->id);
+            }
+            rings.clear();
+
+            lock.lock();
+            if (!released.empty()) {
+                for (auto ring : released) {
+                    ndropped_retired_ +=
+                        ring->ndropped.load(std::memory_order_relaxed);
+                }
+                rings_.erase(
+                    std::remove_if(rings_.begin(), rings_.end(),
+                                   [&released](const auto &ring) {
+                                       return std::find(released.begin(),
+                                                        released.end(),
+                                                        ring.get()) !=
+                                              released.end();
+                                   }),
+                    rings_.end());
+            }
+            if (stopping) {
+                break;
+            }
+            condition_.wait_for(lock, interval_, [this] { return stop_; });
+        }
+    }
+
+    void report_drops(Ring &ring, bool retired) {
+        uint64_t n = ring.ndropped.load(std::memory_order_relaxed);
+        auto now = SteadyClock::now();
+        if (n > ring.nreported &&
+            (retired || now - ring.last_report >= std::chrono::seconds(1))) {
+            LOG(WARNING) << "Fast logging ring of thread " << ring.thread
+                         << " is full, dropped " << n - ring.nreported
+                         << " messages (" << n << " in total).";
+            ring.nreported = n;
+            ring.last_report = now;
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    bool stop_ = false;
+    std::size_t capacity_ = 1024;
+    std::chrono::milliseconds interval_{2};
+    std::vector<std::shared_ptr<Ring>> rings_;
+    uint64_t ndropped_retired_ = 0;
+};
+
+} // namespace
+
+void Start(std::size_t capacity, std::chrono::milliseconds interval) {
+    Logger::instance().Start(capacity, interval);
+}
+
+void Stop() { Logger::instance().Stop(); }
+
+bool running() { return Logger::instance().running(); }
+
+std::vector<ThreadStats> stats() { return Logger::instance().stats(); }
+
+uint64_t ndropped() { return Logger::instance().ndropped(); }
+
+namespace internal {
+
+void submit(const Record &record) {
+    Logger &logger = Logger::instance();
+    if (!logger.running()) {
+        forward(record, SystemClock::now(), std::this_thread::get_id());
+        return;
+    }
+
+    auto &ring = ring_handle.ring;
+    if (!ring) {
+        ring = logger.Register();
+    }
+    if (ring->queue.push(record)) {
+        increment(ring->nlogged);
+    } else {
+        increment(ring->ndropped);
+    }
+}
+
+std::string format(const Record &record) {
+    std::ostringstream out;
+    std::size_t pos = 0;
+    uint8_t arg = 0;
+
+    auto write_arg = [&]() {
+        switch (record.types[arg]) {
+        case ArgType::STRING: {
+            auto n = static_cast<uint8_t>(record.payload[pos++]);
+            out.write(record.payload + pos, n);
+            pos += n;
+            break;
+        }
+        case ArgType::INT: {
+            int64_t value;
+            std::memcpy(&value, record.payload + pos, sizeof(value));
+            out << value;
+            pos += sizeof(value);
+            break;
+        }
+        case ArgType::DOUBLE: {
+            double value;
+            std::memcpy(&value, record.payload + pos, sizeof(value));
+            out << value;
+            pos += sizeof(value);
+            break;
+        }
+        default: {
+            uint64_t value;
+            std::memcpy(&value, record.payload + pos, sizeof(value));
+            if (record.types[arg] == ArgType::CHAR) {
+                out << static_cast<char>(value);
+            } else {
+                out << value;
+            }
+            pos += sizeof(value);
+        }
+        }
+        ++arg;
+    };
+
+    for (const char *c = record.site->format; *c != '\0'; ++c) {
+        if (c[0] == '{' && c[1] == '}' && arg < record.nargs) {
+            write_arg();
+            ++c;
+        } else {
+            out << *c;
+        }
+    }
+    // arguments without placeholder are appended
+    while (arg < record.nargs) {
+        out << ' ';
+        write_arg();
+    }
+    if (record.truncated) {
+        out << " [truncated]";
+    }
+    return out.str();
+}
+
+} // namespace internal
+
+} // namespace fastlog
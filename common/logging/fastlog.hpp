@@ -0,0 +1,208 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "g3log/g3log.hpp"
+#include "logging/g3loglevels.hpp"
+
+// Asynchronous binary logging for the processing hot path.
+//
+//   FASTLOG(UPDATE, "{}: received target event {}.", name(), data->event());
+//
+// The calling thread only copies a pointer to the static call site, a time
+// stamp counter reading and the raw arguments into a fixed size record in its
+// own lock-free ring. A background thread formats the records, replacing each
+// {} in the format string by the next argument, and forwards them to the g3log
+// sinks with the time at which they were logged. When the ring of a thread is
+// full, the message is dropped and counted. Arguments can be integers,
+// floating point numbers, bools, chars and strings; long strings are
+// truncated to fit the record. Without a running background thread (see
+// fastlog::Start), messages are formatted and forwarded synchronously.
+namespace fastlog {
+
+// static description of a FASTLOG statement, its address identifies the
+// format string in the binary records
+struct Site {
+    LEVELS level;
+    const char *file;
+    int line;
+    const char *function;
+    const char *format;
+};
+
+constexpr std::size_t RECORD_SIZE = 128;
+constexpr std::size_t MAX_ARGS = 8;
+
+enum class ArgType : uint8_t { INT, UINT, DOUBLE, BOOL, CHAR, STRING };
+
+struct Record {
+    const Site *site;
+    uint64_t ticks;
+    uint8_t nargs;
+    uint8_t truncated;
+    ArgType types[MAX_ARGS];
+    char payload[RECORD_SIZE - 2 * sizeof(uint64_t) - 2 - MAX_ARGS];
+};
+
+static_assert(sizeof(Record) == RECORD_SIZE, "unexpected log record size");
+
+// time stamp counter on x86, monotonic clock in nanoseconds elsewhere
+inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+struct ThreadStats {
+    std::string thread;
+    uint64_t nlogged;
+    uint64_t ndropped;
+};
+
+// Starts the background thread. Each logging thread gets a ring of
+// <capacity> records, the rings are emptied every <interval>.
+void Start(std::size_t capacity = 1024,
+           std::chrono::milliseconds interval = std::chrono::milliseconds(2));
+
+// Forwards all pending messages and stops the background thread.
+void Stop();
+
+bool running();
+
+// logged and dropped messages for each thread that is currently logging
+std::vector<ThreadStats> stats();
+
+// total number of dropped messages since the start
+uint64_t ndropped();
+
+namespace internal {
+
+class Encoder {
+  public:
+    explicit Encoder(Record &record) : record_(record), pos_(0) {
+        record_.nargs = 0;
+        record_.truncated = 0;
+    }
+
+    template <typename T> void put(const T &value) {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same<U, bool>::value) {
+            put_value(ArgType::BOOL, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_same<U, char>::value) {
+            put_value(ArgType::CHAR, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_enum<U>::value) {
+            put(static_cast<std::underlying_type_t<U>>(value));
+        } else if constexpr (std::is_integral<U>::value &&
+                             std::is_signed<U>::value) {
+            put_value(ArgType::INT, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral<U>::value) {
+            put_value(ArgType::UINT, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point<U>::value) {
+            put_value(ArgType::DOUBLE, static_cast<double>(value));
+        } else {
+            static_assert(
+                std::is_convertible<const T &, std::string_view>::value,
+                "unsupported FASTLOG argument type");
+            put_string(std::string_view(value));
+        }
+    }
+
+  protected:
+    template <typename V> void put_value(ArgType type, V value) {
+        if (record_.truncated || pos_ + sizeof(V) > sizeof(record_.payload)) {
+            record_.truncated = 1;
+            return;
+        }
+        std::memcpy(record_.payload + pos_, &value, sizeof(V));
+        pos_ += sizeof(V);
+        record_.types[record_.nargs++] = type;
+    }
+
+    void put_string(std::string_view value) {
+        if (record_.truncated || pos_ + 1 >= sizeof(record_.payload)) {
+            record_.truncated = 1;
+            return;
+        }
+        std::size_t n = std::min<std::size_t>(
+            {value.size(), sizeof(record_.payload) - pos_ - 1, 255});
+        record_.truncated = n < value.size();
+        record_.payload[pos_++] = static_cast<char>(n);
+        std::memcpy(record_.payload + pos_, value.data(), n);
+        pos_ += n;
+        record_.types[record_.nargs++] = ArgType::STRING;
+    }
+
+    Record &record_;
+    std::size_t pos_;
+};
+
+// hands the record to the ring of the calling thread
+void submit(const Record &record);
+
+// formats the message text of a record
+std::string format(const Record &record);
+
+} // namespace internal
+
+template <typename... Args>
+void log(const Site &site, const Args &... args) {
+    static_assert(sizeof...(Args) <= MAX_ARGS,
+                  "too many arguments for a FASTLOG message");
+    Record record;
+    record.ticks = ticks();
+    record.site = &site;
+    internal::Encoder encoder(record);
+    (encoder.put(args), ...);
+    internal::submit(record);
+}
+
+} // namespace fastlog
+
+#define FASTLOG(level, format, ...)                                           \
+    do {                                                                       \
+        if (g3::logLevel(level)) {                                             \
+            static const fastlog::Site fastlog_site_{                          \
+                level, __FILE__, __LINE__, __PRETTY_FUNCTION__, format};       \
+            fastlog::log(fastlog_site_, ##__VA_ARGS__);                        \
+        }                                                                      \
+    } while (0)
+
+#define FASTLOG_IF(level, condition, format, ...)                             \
+    do {                                                                       \
+        if ((condition) && g3::logLevel(level)) {                              \
+            static const fastlog::Site fastlog_site_{                          \
+                level, __FILE__, __LINE__, __PRETTY_FUNCTION__, format};       \
+            fastlog::log(fastlog_site_, ##__VA_ARGS__);                        \
+        }                                                                      \
+    } while (0)
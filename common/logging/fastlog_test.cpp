@@ -0,0 +1,127 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "logging/fastlog.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+template <typename... Args>
+std::string encode(const char *format, const Args &... args) {
+    fastlog::Site site{INFO, __FILE__, __LINE__, __PRETTY_FUNCTION__, format};
+    fastlog::Record record;
+    record.site = &site;
+    record.ticks = 0;
+    fastlog::internal::Encoder encoder(record);
+    (encoder.put(args), ...);
+    return fastlog::internal::format(record);
+}
+
+TEST(FastLogTest, FormatPlaceholders) {
+    std::string name = "proc";
+    EXPECT_EQ(encode("{}. {} events, {} ms.", name, 42, 1.5),
+              "proc. 42 events, 1.5 ms.");
+    EXPECT_EQ(encode("{} {} {} {}", true, 'x', -7, uint64_t(9)), "1 x -7 9");
+    EXPECT_EQ(encode("no arguments {}"), "no arguments {}");
+}
+
+TEST(FastLogTest, FormatExtraArguments) {
+    EXPECT_EQ(encode("{} and {}", 1, 2, 3, "four"), "1 and 2 3 four");
+}
+
+TEST(FastLogTest, FormatTruncatedString) {
+    const std::size_t payload = sizeof(fastlog::Record::payload);
+    std::string text(2 * payload, 'z');
+
+    // one byte of the payload holds the length of the string
+    EXPECT_EQ(encode("long {}", text),
+              "long " + std::string(payload - 1, 'z') + " [truncated]");
+
+    // arguments after a truncated one are dropped
+    EXPECT_EQ(encode("{} {}", text, 5),
+              std::string(payload - 1, 'z') + " {} [truncated]");
+
+    std::string fits(payload - 1, 'y');
+    EXPECT_EQ(encode("{}", fits), fits);
+}
+
+TEST(FastLogTest, CountLoggedAndDropped) {
+    static const fastlog::Site site{INFO, __FILE__, __LINE__,
+                                    __PRETTY_FUNCTION__, "message {}"};
+    const std::size_t capacity = 8;
+    const std::size_t nmessages = 20;
+
+    // the background thread empties the rings once when it starts and then
+    // only when it is stopped, so that a burst overflows the ring
+    fastlog::Start(capacity, std::chrono::hours(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    uint64_t ndropped_before = fastlog::ndropped();
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool logged = false;
+    bool checked = false;
+
+    // stats only lists the rings of threads that are still running
+    std::thread thread([&] {
+        pthread_setname_np(pthread_self(), "fastlog_test");
+        for (std::size_t k = 0; k < nmessages; ++k) {
+            fastlog::log(site, k);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        logged = true;
+        condition.notify_all();
+        condition.wait(lock, [&] { return checked; });
+    });
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&] { return logged; });
+    }
+
+    bool found = false;
+    for (auto &stats : fastlog::stats()) {
+        if (stats.thread == "fastlog_test") {
+            found = true;
+            EXPECT_EQ(stats.nlogged, capacity);
+            EXPECT_EQ(stats.ndropped, nmessages - capacity);
+        }
+    }
+    EXPECT_TRUE(found);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        checked = true;
+        condition.notify_all();
+    }
+    thread.join();
+    fastlog::Stop();
+
+    // drops of exited threads are still accounted for
+    EXPECT_EQ(fastlog::ndropped() - ndropped_before, nmessages - capacity);
+    EXPECT_FALSE(fastlog::running());
+}
+
+} // namespace
@@ -25,4 +25,5 @@
 #include "g3log/g3log.hpp"
 #include "g3log/logmessage.hpp"
 #include "g3log/logworker.hpp"
+#include "logging/fastlog.hpp"
 #include "logging/g3loglevels.hpp"
@@ -0,0 +1,314 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "asyncwriter.hpp"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+// alignment of buffers, offsets and lengths for O_DIRECT
+constexpr std::size_t DIRECT_IO_ALIGNMENT = 4096;
+
+// write all iovecs, resuming after short writes
+bool write_all(int fd, struct iovec *iov, int n, uint64_t offset) {
+    while (n > 0) {
+        ssize_t rc = pwritev(fd, iov, n, offset);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        offset += rc;
+        while (n > 0 && static_cast<std::size_t>(rc) >= iov->iov_len) {
+            rc -= iov->iov_len;
+            ++iov;
+            --n;
+        }
+        if (n > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + rc;
+            iov->iov_len -= rc;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+class AsyncFileWriter::FileBuffer : public std::streambuf {
+  public:
+    FileBuffer(AsyncFileWriter &writer, int fd) : writer_(writer), fd_(fd) {}
+
+    ~FileBuffer() {
+        SubmitCurrent();
+        writer_.Drain(fd_);
+        close(fd_);
+    }
+
+  protected:
+    // Note that sync() is not overridden: flushing the stream does not force
+    // out a partially filled chunk, which would break O_DIRECT alignment.
+    // The remainder is written when the stream is destroyed.
+    int_type overflow(int_type c) override {
+        if (current_ != nullptr) {
+            SubmitCurrent();
+        }
+        current_ = writer_.Acquire();
+        setp(current_->data, current_->data + writer_.chunk_size_);
+        if (writer_.failed()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        std::streamsize written = 0;
+        while (written < n) {
+            if (pptr() == epptr() &&
+                traits_type::eq_int_type(overflow(traits_type::eof()),
+                                         traits_type::eof())) {
+                break;
+            }
+            std::streamsize chunk =
+                std::min<std::streamsize>(n - written, epptr() - pptr());
+            memcpy(pptr(), s + written, chunk);
+            pbump(static_cast<int>(chunk));
+            written += chunk;
+        }
+        return written;
+    }
+
+    void SubmitCurrent() {
+        if (current_ == nullptr) {
+            return;
+        }
+        current_->length = pptr() - pbase();
+        current_->fd = fd_;
+        current_->offset = offset_;
+        offset_ += current_->length;
+        if (current_->length > 0) {
+            writer_.Submit(current_);
+        } else {
+            writer_.Release(current_);
+        }
+        current_ = nullptr;
+        setp(nullptr, nullptr);
+    }
+
+  protected:
+    AsyncFileWriter &writer_;
+    int fd_;
+    Chunk *current_ = nullptr;
+    uint64_t offset_ = 0;
+};
+
+class AsyncFileWriter::Stream : public std::ostream {
+  public:
+    Stream(AsyncFileWriter &writer, int fd)
+        : std::ostream(nullptr), buffer_(writer, fd) {
+        rdbuf(&buffer_);
+    }
+
+  protected:
+    FileBuffer buffer_;
+};
+
+AsyncFileWriter::AsyncFileWriter(std::size_t chunk_size,
+                                 unsigned int queue_depth, bool direct_io,
+                                 FlushCallback callback)
+    : chunk_size_(std::max<std::size_t>(
+          (chunk_size + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT *
+              DIRECT_IO_ALIGNMENT,
+          DIRECT_IO_ALIGNMENT)),
+      queue_depth_(std::max(queue_depth, 1u)), direct_io_(direct_io),
+      callback_(std::move(callback)) {
+    for (unsigned int k = 0; k < queue_depth_; ++k) {
+        AddChunk();
+    }
+    thread_ = std::thread(&AsyncFileWriter::Run, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    queued_.notify_one();
+    thread_.join();
+    for (auto &chunk : chunks_) {
+        free(chunk.data);
+    }
+}
+
+std::unique_ptr<std::ostream> AsyncFileWriter::Open(const std::string &filename) {
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    int fd = open(filename.c_str(), flags | (direct_io_ ? O_DIRECT : 0), 0644);
+    if (fd < 0 && direct_io_ && errno == EINVAL) {
+        // file system does not support direct I/O
+        fd = open(filename.c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open " + filename + ": " +
+                                 strerror(errno));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        AddChunk();
+    }
+    return std::unique_ptr<std::ostream>(new Stream(*this, fd));
+}
+
+double AsyncFileWriter::fill_level() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::min(1.0, static_cast<double>(pending_.size()) / queue_depth_);
+}
+
+void AsyncFileWriter::AddChunk() {
+    void *memory = nullptr;
+    if (posix_memalign(&memory, DIRECT_IO_ALIGNMENT, chunk_size_) != 0) {
+        throw std::bad_alloc();
+    }
+    chunks_.push_back(Chunk{static_cast<char *>(memory), 0, -1, 0});
+    free_.push_back(&chunks_.back());
+}
+
+AsyncFileWriter::Chunk *AsyncFileWriter::Acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+        nstalls_.fetch_add(1, std::memory_order_relaxed);
+        released_.wait(lock, [this] { return !free_.empty(); });
+    }
+    Chunk *chunk = free_.back();
+    free_.pop_back();
+    return chunk;
+}
+
+void AsyncFileWriter::Submit(Chunk *chunk) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(chunk);
+        pending_.push_back(chunk->fd);
+    }
+    queued_.notify_one();
+}
+
+void AsyncFileWriter::Release(Chunk *chunk) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(chunk);
+    }
+    released_.notify_all();
+}
+
+void AsyncFileWriter::Drain(int fd) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    released_.wait(lock, [this, fd] {
+        return std::find(pending_.begin(), pending_.end(), fd) ==
+               pending_.end();
+    });
+}
+
+void AsyncFileWriter::Run() {
+    std::vector<Chunk *> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queued_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            batch.assign(queue_.begin(), queue_.end());
+            queue_.clear();
+        }
+
+        Flush(batch);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto chunk : batch) {
+                pending_.erase(
+                    std::find(pending_.begin(), pending_.end(), chunk->fd));
+                free_.push_back(chunk);
+            }
+        }
+        released_.notify_all();
+    }
+}
+
+void AsyncFileWriter::Flush(const std::vector<Chunk *> &batch) {
+    std::vector<struct iovec> iovecs;
+    std::size_t first = 0;
+    while (first < batch.size()) {
+        // merge chunks that continue the same file
+        std::size_t last = first + 1;
+        while (last < batch.size() && last - first < IOV_MAX &&
+               batch[last]->fd == batch[first]->fd &&
+               batch[last]->offset ==
+                   batch[last - 1]->offset + batch[last - 1]->length) {
+            ++last;
+        }
+
+        iovecs.clear();
+        std::size_t nbytes = 0;
+        for (std::size_t k = first; k < last; ++k) {
+            iovecs.push_back({batch[k]->data, batch[k]->length});
+            nbytes += batch[k]->length;
+        }
+
+        int fd = batch[first]->fd;
+        if (direct_io_ && nbytes % DIRECT_IO_ALIGNMENT != 0) {
+            // the unaligned tail of a file is written through the page cache
+            int flags = fcntl(fd, F_GETFL);
+            if (flags >= 0 && (flags & O_DIRECT)) {
+                fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (!failed_.load(std::memory_order_relaxed) &&
+            !write_all(fd, iovecs.data(), static_cast<int>(iovecs.size()),
+                       batch[first]->offset)) {
+            failed_.store(true, std::memory_order_relaxed);
+        }
+        if (callback_) {
+            callback_(nbytes, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count());
+        }
+
+        first = last;
+    }
+}
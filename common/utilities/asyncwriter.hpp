@@ -0,0 +1,110 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Write-behind engine for file output. Writers serialize into large
+// preallocated chunks; a full chunk is queued and a background I/O thread
+// flushes queued chunks with pwritev (optionally with O_DIRECT), merging
+// consecutive chunks of the same file into a single call. Writers only block
+// when all chunks are queued or being written.
+class AsyncFileWriter {
+  public:
+    // called from the I/O thread after every write, with the number of bytes
+    // and the duration of the system call
+    using FlushCallback = std::function<void(std::size_t, int64_t)>;
+
+    // queue_depth is the number of chunks that can be queued or in flight;
+    // every open file holds one additional chunk that it is filling
+    AsyncFileWriter(std::size_t chunk_size, unsigned int queue_depth,
+                    bool direct_io = false, FlushCallback callback = nullptr);
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter &) = delete;
+    AsyncFileWriter &operator=(const AsyncFileWriter &) = delete;
+
+    // Create (or truncate) a file and return an output stream that writes
+    // through this engine. Destroying the stream flushes the remaining data
+    // and waits until all of it has been written.
+    std::unique_ptr<std::ostream> Open(const std::string &filename);
+
+    // fraction of the queue depth that is queued or being written
+    double fill_level() const;
+
+    std::size_t chunk_size() const { return chunk_size_; }
+    // true if files are opened with O_DIRECT
+    bool direct_io() const { return direct_io_; }
+    // number of times a writer had to wait for a free chunk
+    uint64_t nstalls() const { return nstalls_.load(std::memory_order_relaxed); }
+    bool failed() const { return failed_.load(std::memory_order_relaxed); }
+
+  protected:
+    class FileBuffer;
+    class Stream;
+
+    struct Chunk {
+        char *data;
+        std::size_t length;
+        int fd;
+        uint64_t offset;
+    };
+
+    Chunk *Acquire();
+    void Submit(Chunk *chunk);
+    void Release(Chunk *chunk);
+    // wait until all chunks of a file have been written
+    void Drain(int fd);
+    void AddChunk();
+    void Run();
+    void Flush(const std::vector<Chunk *> &batch);
+
+  protected:
+    std::size_t chunk_size_;
+    unsigned int queue_depth_;
+    bool direct_io_;
+    FlushCallback callback_;
+
+    std::deque<Chunk> chunks_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable queued_;
+    std::condition_variable released_;
+    std::vector<Chunk *> free_;
+    std::deque<Chunk *> queue_;
+    std::vector<int> pending_; // file descriptor of every queued chunk
+    bool stop_ = false;
+
+    std::atomic<uint64_t> nstalls_{0};
+    std::atomic<bool> failed_{false};
+
+    std::thread thread_;
+};
@@ -0,0 +1,174 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "bitpack.hpp"
+
+#include <emmintrin.h>
+
+#include <cstring>
+
+namespace {
+
+void pack_block(const uint32_t *in, unsigned int width, uint8_t *out) {
+    if (width == 0) {
+        return;
+    }
+    __m128i *dst = reinterpret_cast<__m128i *>(out);
+    __m128i word = _mm_setzero_si128();
+    unsigned int shift = 0;
+    for (std::size_t k = 0; k < BITPACK_BLOCK_SIZE; k += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + k));
+        word = _mm_or_si128(word, _mm_sll_epi32(v, _mm_cvtsi32_si128(shift)));
+        shift += width;
+        if (shift >= 32) {
+            _mm_storeu_si128(dst++, word);
+            shift -= 32;
+            // remaining high bits of v (a shift by 32 yields zero)
+            word = _mm_srl_epi32(v, _mm_cvtsi32_si128(width - shift));
+        }
+    }
+}
+
+void unpack_block(const uint8_t *in, unsigned int width, uint32_t *out) {
+    if (width == 0) {
+        memset(out, 0, BITPACK_BLOCK_SIZE * sizeof(uint32_t));
+        return;
+    }
+    const __m128i *src = reinterpret_cast<const __m128i *>(in);
+    const __m128i mask = _mm_set1_epi32(
+        width == 32 ? -1 : static_cast<int32_t>((1u << width) - 1));
+    __m128i word = _mm_loadu_si128(src++);
+    unsigned int shift = 0;
+    for (std::size_t k = 0; k < BITPACK_BLOCK_SIZE; k += 4) {
+        __m128i v = _mm_srl_epi32(word, _mm_cvtsi32_si128(shift));
+        shift += width;
+        if (shift >= 32 && k + 4 < BITPACK_BLOCK_SIZE) {
+            word = _mm_loadu_si128(src++);
+            shift -= 32;
+            if (shift > 0) {
+                v = _mm_or_si128(
+                    v, _mm_sll_epi32(word, _mm_cvtsi32_si128(width - shift)));
+            }
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k),
+                         _mm_and_si128(v, mask));
+    }
+}
+
+std::size_t tail_bytes(std::size_t n, unsigned int width) {
+    return (n * width + 7) / 8;
+}
+
+void pack_tail(const uint32_t *in, std::size_t n, unsigned int width,
+               uint8_t *out) {
+    uint64_t bits = 0;
+    unsigned int nbits = 0;
+    for (std::size_t k = 0; k < n; ++k) {
+        bits |= static_cast<uint64_t>(in[k]) << nbits;
+        nbits += width;
+        while (nbits >= 8) {
+            *out++ = static_cast<uint8_t>(bits);
+            bits >>= 8;
+            nbits -= 8;
+        }
+    }
+    if (nbits > 0) {
+        *out = static_cast<uint8_t>(bits);
+    }
+}
+
+void unpack_tail(const uint8_t *in, std::size_t n, unsigned int width,
+                 uint32_t *out) {
+    const uint64_t mask = (uint64_t(1) << width) - 1;
+    uint64_t bits = 0;
+    unsigned int nbits = 0;
+    for (std::size_t k = 0; k < n; ++k) {
+        while (nbits < width) {
+            bits |= static_cast<uint64_t>(*in++) << nbits;
+            nbits += 8;
+        }
+        out[k] = static_cast<uint32_t>(bits & mask);
+        bits >>= width;
+        nbits -= width;
+    }
+}
+
+} // namespace
+
+unsigned int bitpack_width(const uint32_t *values, std::size_t n) {
+    uint32_t acc = 0;
+    std::size_t nvector = n - n % 4;
+    std::size_t k = 0;
+    __m128i v = _mm_setzero_si128();
+    for (; k < nvector; k += 4) {
+        v = _mm_or_si128(
+            v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + k)));
+    }
+    v = _mm_or_si128(v, _mm_srli_si128(v, 8));
+    v = _mm_or_si128(v, _mm_srli_si128(v, 4));
+    acc = static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+    for (; k < n; ++k) {
+        acc |= values[k];
+    }
+    return acc == 0 ? 0 : 32 - __builtin_clz(acc);
+}
+
+void bitpack_encode(const uint32_t *values, std::size_t n,
+                    std::vector<uint8_t> &out) {
+    std::size_t k = 0;
+    for (; k + BITPACK_BLOCK_SIZE <= n; k += BITPACK_BLOCK_SIZE) {
+        unsigned int width = bitpack_width(values + k, BITPACK_BLOCK_SIZE);
+        std::size_t offset = out.size();
+        out.resize(offset + 1 + 16 * width);
+        out[offset] = static_cast<uint8_t>(width);
+        pack_block(values + k, width, out.data() + offset + 1);
+    }
+    if (k < n) {
+        unsigned int width = bitpack_width(values + k, n - k);
+        std::size_t offset = out.size();
+        out.resize(offset + 1 + tail_bytes(n - k, width));
+        out[offset] = static_cast<uint8_t>(width);
+        pack_tail(values + k, n - k, width, out.data() + offset + 1);
+    }
+}
+
+const uint8_t *bitpack_decode(const uint8_t *in, const uint8_t *end,
+                              uint32_t *values, std::size_t n) {
+    std::size_t k = 0;
+    for (; k + BITPACK_BLOCK_SIZE <= n; k += BITPACK_BLOCK_SIZE) {
+        if (in >= end || *in > 32 ||
+            static_cast<std::size_t>(end - in) < 1u + 16 * *in) {
+            return nullptr;
+        }
+        unsigned int width = *in++;
+        unpack_block(in, width, values + k);
+        in += 16 * width;
+    }
+    if (k < n) {
+        if (in >= end || *in > 32 ||
+            static_cast<std::size_t>(end - in) <
+                1 + tail_bytes(n - k, *in)) {
+            return nullptr;
+        }
+        unsigned int width = *in++;
+        unpack_tail(in, n - k, width, values + k);
+        in += tail_bytes(n - k, width);
+    }
+    return in;
+}
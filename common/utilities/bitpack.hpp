@@ -0,0 +1,53 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bit packing of unsigned 32-bit integers in the style of SIMD-BP128
+// (FastPFor). Values are packed in blocks of 128 that are split over four
+// interleaved 32-bit lanes, so that a block is packed and unpacked with a
+// handful of SSE2 shifts per value. Every block is preceded by a byte with its
+// bit width; the last (partial) block is packed as a plain bit stream.
+
+constexpr std::size_t BITPACK_BLOCK_SIZE = 128;
+
+inline uint32_t zigzag_encode(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^
+           static_cast<uint32_t>(value >> 31);
+}
+
+inline int32_t zigzag_decode(uint32_t value) {
+    return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1)));
+}
+
+// number of bits needed to represent the largest of n values
+unsigned int bitpack_width(const uint32_t *values, std::size_t n);
+
+// append n packed values to out
+void bitpack_encode(const uint32_t *values, std::size_t n,
+                    std::vector<uint8_t> &out);
+
+// unpack n values; returns a pointer past the packed data or nullptr if the
+// input ends prematurely
+const uint8_t *bitpack_decode(const uint8_t *in, const uint8_t *end,
+                              uint32_t *values, std::size_t n);
@@ -0,0 +1,112 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "chunkedrecording.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+ChunkedRecordWriter::ColumnBuffer::int_type
+ChunkedRecordWriter::ColumnBuffer::overflow(int_type c) {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        data.push_back(traits_type::to_char_type(c));
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize ChunkedRecordWriter::ColumnBuffer::xsputn(const char *s,
+                                                          std::streamsize n) {
+    data.insert(data.end(), s, s + n);
+    return n;
+}
+
+ChunkedRecordWriter::ChunkedRecordWriter(std::ostream &out,
+                                         std::size_t chunk_size)
+    : out_(out), chunk_size_(chunk_size), stream_(&buffer_) {
+    buffer_.data.reserve(chunk_size_ + chunk_size_ / 4);
+}
+
+ChunkedRecordWriter::~ChunkedRecordWriter() { Close(); }
+
+bool ChunkedRecordWriter::BeginRecord(uint64_t packet, uint64_t timestamp) {
+    if (!packets_.empty() && buffer_.data.size() >= chunk_size_) {
+        FlushChunk();
+    }
+    offsets_.push_back(static_cast<uint32_t>(buffer_.data.size()));
+    packets_.push_back(packet);
+    timestamps_.push_back(timestamp);
+    return packets_.size() == 1;
+}
+
+void ChunkedRecordWriter::FlushChunk() {
+    if (packets_.empty()) {
+        return;
+    }
+
+    ChunkHeader header;
+    memcpy(header.magic, CHUNK_MAGIC, sizeof(header.magic));
+    header.nrecords = static_cast<uint32_t>(packets_.size());
+    header.first_packet = packets_.front();
+    header.first_timestamp =
+        *std::min_element(timestamps_.begin(), timestamps_.end());
+    header.last_timestamp =
+        *std::max_element(timestamps_.begin(), timestamps_.end());
+    header.data_size = buffer_.data.size();
+
+    out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out_.write(reinterpret_cast<const char *>(packets_.data()),
+               packets_.size() * sizeof(uint64_t));
+    out_.write(reinterpret_cast<const char *>(timestamps_.data()),
+               timestamps_.size() * sizeof(uint64_t));
+    out_.write(reinterpret_cast<const char *>(offsets_.data()),
+               offsets_.size() * sizeof(uint32_t));
+    out_.write(buffer_.data.data(), buffer_.data.size());
+
+    index_.push_back(ChunkIndexEntry{offset_, header.first_timestamp,
+                                     header.last_timestamp,
+                                     header.first_packet, header.nrecords});
+    offset_ += sizeof(header) +
+               packets_.size() * (2 * sizeof(uint64_t) + sizeof(uint32_t)) +
+               buffer_.data.size();
+
+    packets_.clear();
+    timestamps_.clear();
+    offsets_.clear();
+    buffer_.data.clear();
+}
+
+void ChunkedRecordWriter::Close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+
+    FlushChunk();
+
+    ChunkFooter footer;
+    footer.index_offset = offset_;
+    footer.nchunks = index_.size();
+    footer.version = CHUNKED_RECORDING_VERSION;
+    memcpy(footer.magic, CHUNK_INDEX_MAGIC, sizeof(footer.magic));
+
+    out_.write(reinterpret_cast<const char *>(index_.data()),
+               index_.size() * sizeof(ChunkIndexEntry));
+    out_.write(reinterpret_cast<const char *>(&footer), sizeof(footer));
+    out_.flush();
+}
@@ -0,0 +1,118 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+// Chunked, indexed container for serialized records of a single stream.
+//
+// The records are grouped in chunks. Every chunk starts with a ChunkHeader,
+// followed by three columns (packet numbers as uint64, hardware timestamps as
+// uint64 and the offsets of the records in the data column as uint32) and
+// the data column with the serialized records. After the last chunk follows
+// an index with a ChunkIndexEntry per chunk and a ChunkFooter at the very end
+// of the file, so that a reader can locate any chunk by timestamp with a
+// binary search. All offsets are relative to the start of the first chunk
+// (which may be preceded by a preamble) and all values are stored in native
+// byte order.
+
+constexpr uint32_t CHUNKED_RECORDING_VERSION = 1;
+constexpr char CHUNK_MAGIC[4] = {'F', 'C', 'H', 'K'};
+constexpr char CHUNK_INDEX_MAGIC[4] = {'F', 'I', 'D', 'X'};
+
+struct ChunkHeader {
+    char magic[4];
+    uint32_t nrecords;
+    uint64_t first_packet;
+    uint64_t first_timestamp; // smallest hardware timestamp in chunk
+    uint64_t last_timestamp;  // largest hardware timestamp in chunk
+    uint64_t data_size;       // size of the data column in bytes
+};
+
+struct ChunkIndexEntry {
+    uint64_t offset; // of the chunk header
+    uint64_t first_timestamp;
+    uint64_t last_timestamp;
+    uint64_t first_packet;
+    uint64_t nrecords;
+};
+
+struct ChunkFooter {
+    uint64_t index_offset;
+    uint64_t nchunks;
+    uint32_t version;
+    char magic[4];
+};
+
+static_assert(sizeof(ChunkHeader) == 40, "unexpected padding");
+static_assert(sizeof(ChunkIndexEntry) == 40, "unexpected padding");
+static_assert(sizeof(ChunkFooter) == 24, "unexpected padding");
+
+// Writes records to an output stream in the chunked format. Records are
+// collected in memory and a chunk is written as soon as its data column
+// exceeds the chunk size.
+class ChunkedRecordWriter {
+  public:
+    ChunkedRecordWriter(std::ostream &out, std::size_t chunk_size = 1 << 20);
+    ~ChunkedRecordWriter();
+
+    ChunkedRecordWriter(const ChunkedRecordWriter &) = delete;
+    ChunkedRecordWriter &operator=(const ChunkedRecordWriter &) = delete;
+
+    // Start a new record, whose data should then be written to stream().
+    // Returns true if the record is the first of a new chunk, in which case
+    // stateful encoders should restart, so that chunks can be decoded
+    // independently.
+    bool BeginRecord(uint64_t packet, uint64_t timestamp);
+    std::ostream &stream() { return stream_; }
+
+    // write the last chunk and the index
+    void Close();
+
+    uint64_t nchunks() const { return index_.size(); }
+
+  protected:
+    // stream buffer that appends to the data column
+    class ColumnBuffer : public std::streambuf {
+      public:
+        std::vector<char> data;
+
+      protected:
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(const char *s, std::streamsize n) override;
+    };
+
+    void FlushChunk();
+
+  protected:
+    std::ostream &out_;
+    std::size_t chunk_size_;
+    ColumnBuffer buffer_;
+    std::ostream stream_;
+    std::vector<uint64_t> packets_;
+    std::vector<uint64_t> timestamps_;
+    std::vector<uint32_t> offsets_;
+    std::vector<ChunkIndexEntry> index_;
+    uint64_t offset_ = 0;
+    bool closed_ = false;
+};
@@ -0,0 +1,508 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "iouring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <ctime>
+
+#if HAVE_IO_URING
+
+namespace {
+
+int io_uring_setup(unsigned int entries, struct io_uring_params *params) {
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                   unsigned int flags, void *arg, std::size_t size) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                   arg, size);
+}
+
+int io_uring_register(int fd, unsigned int opcode, void *arg,
+                      unsigned int nargs) {
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nargs);
+}
+
+std::string error_string(const std::string &what, int error) {
+    return what + ": " + strerror(error);
+}
+
+} // namespace
+
+IoUring::IoUring(unsigned int entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    fd_ = io_uring_setup(entries, &params);
+    if (fd_ < 0) {
+        throw std::runtime_error(error_string("Unable to set up io_uring", errno));
+    }
+
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) ||
+        !(params.features & IORING_FEAT_EXT_ARG)) {
+        close(fd_);
+        throw std::runtime_error("Kernel io_uring support is too old.");
+    }
+
+    ring_map_size_ = std::max<std::size_t>(
+        params.sq_off.array + params.sq_entries * sizeof(unsigned int),
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+    ring_map_ = mmap(NULL, ring_map_size_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (ring_map_ == MAP_FAILED) {
+        int error = errno;
+        ring_map_ = nullptr;
+        close(fd_);
+        throw std::runtime_error(error_string("Unable to map io_uring", error));
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(NULL, sqes_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        int error = errno;
+        munmap(ring_map_, ring_map_size_);
+        close(fd_);
+        throw std::runtime_error(error_string("Unable to map io_uring", error));
+    }
+    sqes_ = static_cast<struct io_uring_sqe *>(sqes);
+
+    char *base = static_cast<char *>(ring_map_);
+    sq_entries_ = params.sq_entries;
+    sq_head_ = reinterpret_cast<unsigned int *>(base + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned int *>(base + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned int *>(base + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned int *>(base + params.sq_off.array);
+    sq_local_tail_ = sq_submitted_ = *sq_tail_;
+
+    cq_head_ = reinterpret_cast<unsigned int *>(base + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned int *>(base + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned int *>(base + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe *>(base + params.cq_off.cqes);
+}
+
+IoUring::~IoUring() {
+    munmap(sqes_, sqes_size_);
+    munmap(ring_map_, ring_map_size_);
+    close(fd_);
+}
+
+bool IoUring::supported() {
+    static const bool result = []() {
+        try {
+            IoUring ring(2);
+        } catch (std::runtime_error &) {
+            return false;
+        }
+        return true;
+    }();
+    return result;
+}
+
+struct io_uring_sqe *IoUring::GetSqe() {
+    unsigned int head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_local_tail_ - head >= sq_entries_) {
+        return nullptr;
+    }
+    unsigned int index = sq_local_tail_ & *sq_mask_;
+    struct io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    ++sq_local_tail_;
+    return sqe;
+}
+
+int IoUring::Submit() {
+    unsigned int n = sq_local_tail_ - sq_submitted_;
+    if (n == 0) {
+        return 0;
+    }
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    int rc = io_uring_enter(fd_, n, 0, 0, NULL, 0);
+    if (rc > 0) {
+        sq_submitted_ += rc;
+    }
+    return rc;
+}
+
+bool IoUring::completion_available() const {
+    return *cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+}
+
+const struct io_uring_cqe *IoUring::PeekCompletion() const {
+    if (!completion_available()) {
+        return nullptr;
+    }
+    return &cqes_[*cq_head_ & *cq_mask_];
+}
+
+bool IoUring::SubmitAndWait(int timeout) {
+    unsigned int n = sq_local_tail_ - sq_submitted_;
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+
+    if (n == 0 && completion_available()) {
+        return true;
+    }
+
+    int rc;
+    if (timeout < 0) {
+        rc = io_uring_enter(fd_, n, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+    } else {
+        struct __kernel_timespec ts;
+        ts.tv_sec = timeout / 1000;
+        ts.tv_nsec = (timeout % 1000) * 1000000L;
+        struct io_uring_getevents_arg arg;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        rc = io_uring_enter(fd_, n, 1,
+                            IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg,
+                            sizeof(arg));
+    }
+    if (rc > 0) {
+        sq_submitted_ += std::min<unsigned int>(rc, n);
+    }
+
+    return completion_available();
+}
+
+void IoUring::RegisterBuffers(const struct iovec *iovecs, unsigned int n) {
+    if (io_uring_register(fd_, IORING_REGISTER_BUFFERS,
+                          const_cast<struct iovec *>(iovecs), n) < 0) {
+        throw std::runtime_error(
+            error_string("Unable to register io_uring buffers", errno));
+    }
+}
+
+void IoUring::RegisterBufferRing(struct io_uring_buf_ring *ring,
+                                 unsigned int entries, uint16_t group) {
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = entries;
+    reg.bgid = group;
+    if (io_uring_register(fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        throw std::runtime_error(
+            error_string("Unable to register io_uring buffer ring", errno));
+    }
+}
+
+IoUringReceiver::IoUringReceiver(int socket, unsigned int nbuffers,
+                                 unsigned int max_payload_size,
+                                 unsigned int control_size)
+    : ring_(4), socket_(socket) {
+    nbuffers_ = 1;
+    while (nbuffers_ < nbuffers) {
+        nbuffers_ <<= 1;
+    }
+    if (nbuffers_ > 32768) {
+        throw std::runtime_error("Too many io_uring receive buffers.");
+    }
+
+    memset(&message_, 0, sizeof(message_));
+    message_.msg_controllen = control_size;
+
+    buffer_size_ = sizeof(struct io_uring_recvmsg_out) + control_size +
+                   max_payload_size;
+    buffers_.assign(static_cast<std::size_t>(nbuffers_) * buffer_size_, 0);
+
+    buffer_ring_size_ = nbuffers_ * sizeof(struct io_uring_buf);
+    void *map = mmap(NULL, buffer_ring_size_, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error(
+            error_string("Unable to allocate io_uring buffer ring", errno));
+    }
+    buffer_ring_ = static_cast<struct io_uring_buf_ring *>(map);
+
+    try {
+        ring_.RegisterBufferRing(buffer_ring_, nbuffers_, BUFFER_GROUP);
+    } catch (std::runtime_error &) {
+        munmap(buffer_ring_, buffer_ring_size_);
+        throw;
+    }
+
+    for (unsigned int k = 0; k < nbuffers_; ++k) {
+        ReturnBuffer(k);
+    }
+    __atomic_store_n(&buffer_ring_->tail, buffer_ring_tail_, __ATOMIC_RELEASE);
+
+    Arm();
+
+    // kernels without multishot receive support reject the request right
+    // away
+    const struct io_uring_cqe *cqe = ring_.PeekCompletion();
+    if (cqe != nullptr && cqe->res == -EINVAL) {
+        munmap(buffer_ring_, buffer_ring_size_);
+        throw std::runtime_error(
+            "Kernel does not support multishot receive in io_uring.");
+    }
+}
+
+IoUringReceiver::~IoUringReceiver() {
+    // cancel the outstanding request and wait until it has terminated, so
+    // that the kernel no longer writes into the buffers
+    struct io_uring_sqe *sqe = ring_.GetSqe();
+    if (sqe != nullptr) {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = RECEIVE_TAG;
+        sqe->user_data = CANCEL_TAG;
+    }
+    bool terminated = false;
+    while (!terminated && ring_.SubmitAndWait(100)) {
+        ring_.ForEachCompletion([&](const struct io_uring_cqe &cqe) {
+            if (cqe.user_data == RECEIVE_TAG &&
+                !(cqe.flags & IORING_CQE_F_MORE)) {
+                terminated = true;
+            }
+        });
+    }
+    munmap(buffer_ring_, buffer_ring_size_);
+}
+
+void IoUringReceiver::Arm() {
+    struct io_uring_sqe *sqe = ring_.GetSqe();
+    if (sqe == nullptr) {
+        throw std::runtime_error("io_uring submission queue is full.");
+    }
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = socket_;
+    sqe->addr = reinterpret_cast<uint64_t>(&message_);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = RECEIVE_TAG;
+    ring_.Submit();
+}
+
+void IoUringReceiver::ReturnBuffer(uint16_t id) {
+    // the entries are indexed explicitly: in C++ the flexible bufs member of
+    // io_uring_buf_ring does not start at offset 0
+    struct io_uring_buf *buf = reinterpret_cast<struct io_uring_buf *>(
+                                   buffer_ring_) +
+                               (buffer_ring_tail_ & (nbuffers_ - 1));
+    buf->addr = reinterpret_cast<uint64_t>(buffers_.data() +
+                                           static_cast<std::size_t>(id) *
+                                               buffer_size_);
+    buf->len = buffer_size_;
+    buf->bid = id;
+    ++buffer_ring_tail_;
+}
+
+bool IoUringReceiver::Wait(int timeout) { return ring_.SubmitAndWait(timeout); }
+
+IoUringFileBuffer::IoUringFileBuffer(const std::string &filename,
+                                     unsigned int nbuffers,
+                                     unsigned int buffer_size)
+    : ring_(2 * nbuffers), nbuffers_(nbuffers), buffer_size_(buffer_size),
+      buffers_(static_cast<std::size_t>(nbuffers) * buffer_size),
+      in_flight_(nbuffers, false), offsets_(nbuffers, 0),
+      lengths_(nbuffers, 0) {
+    std::vector<struct iovec> iovecs(nbuffers_);
+    for (unsigned int k = 0; k < nbuffers_; ++k) {
+        iovecs[k].iov_base = buffer(k);
+        iovecs[k].iov_len = buffer_size_;
+    }
+    ring_.RegisterBuffers(iovecs.data(), nbuffers_);
+
+    fd_ = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+               0644);
+    if (fd_ < 0) {
+        throw std::runtime_error(
+            error_string("Unable to open " + filename, errno));
+    }
+
+    setp(buffer(current_), buffer(current_) + buffer_size_);
+}
+
+IoUringFileBuffer::~IoUringFileBuffer() {
+    sync();
+    close(fd_);
+}
+
+IoUringFileBuffer::int_type IoUringFileBuffer::overflow(int_type c) {
+    SubmitCurrent();
+    if (error_) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize IoUringFileBuffer::xsputn(const char *s, std::streamsize n) {
+    std::streamsize written = 0;
+    while (written < n && !error_) {
+        if (pptr() == epptr()) {
+            SubmitCurrent();
+            continue;
+        }
+        std::streamsize chunk = std::min<std::streamsize>(
+            n - written, epptr() - pptr());
+        memcpy(pptr(), s + written, chunk);
+        pbump(static_cast<int>(chunk));
+        written += chunk;
+    }
+    return written;
+}
+
+int IoUringFileBuffer::sync() {
+    SubmitCurrent();
+    for (unsigned int k = 0; k < nbuffers_; ++k) {
+        WaitForBuffer(k);
+    }
+    return error_ ? -1 : 0;
+}
+
+void IoUringFileBuffer::SubmitCurrent() {
+    uint32_t length = static_cast<uint32_t>(pptr() - pbase());
+    if (length == 0) {
+        return;
+    }
+
+    struct io_uring_sqe *sqe = ring_.GetSqe();
+    while (sqe == nullptr) {
+        ring_.SubmitAndWait(-1);
+        Reap();
+        sqe = ring_.GetSqe();
+    }
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(pbase());
+    sqe->len = length;
+    sqe->off = offset_;
+    sqe->buf_index = current_;
+    sqe->user_data = current_;
+    ring_.Submit();
+
+    in_flight_[current_] = true;
+    offsets_[current_] = offset_;
+    lengths_[current_] = length;
+    offset_ += length;
+
+    // continue in the next buffer, once its previous write has completed
+    current_ = (current_ + 1) % nbuffers_;
+    WaitForBuffer(current_);
+    setp(buffer(current_), buffer(current_) + buffer_size_);
+}
+
+void IoUringFileBuffer::WaitForBuffer(unsigned int index) {
+    Reap();
+    while (in_flight_[index]) {
+        ring_.SubmitAndWait(-1);
+        Reap();
+    }
+}
+
+void IoUringFileBuffer::Reap() {
+    ring_.ForEachCompletion([this](const struct io_uring_cqe &cqe) {
+        unsigned int index = static_cast<unsigned int>(cqe.user_data);
+        in_flight_[index] = false;
+        if (cqe.res < 0) {
+            error_ = true;
+            return;
+        }
+        // complete short writes synchronously
+        uint32_t done = static_cast<uint32_t>(cqe.res);
+        while (done < lengths_[index]) {
+            ssize_t rc = pwrite(fd_, buffer(index) + done,
+                                lengths_[index] - done,
+                                offsets_[index] + done);
+            if (rc <= 0) {
+                error_ = true;
+                return;
+            }
+            done += rc;
+        }
+    });
+}
+
+#else
+
+// io_uring objects cannot be created, so the remaining members are never used
+
+IoUring::IoUring(unsigned int entries) {
+    throw std::runtime_error("Falcon was built without io_uring support.");
+}
+
+IoUring::~IoUring() {}
+
+bool IoUring::supported() { return false; }
+
+struct io_uring_sqe *IoUring::GetSqe() { return nullptr; }
+
+int IoUring::Submit() { return 0; }
+
+bool IoUring::completion_available() const { return false; }
+
+const struct io_uring_cqe *IoUring::PeekCompletion() const { return nullptr; }
+
+bool IoUring::SubmitAndWait(int timeout) { return false; }
+
+void IoUring::RegisterBuffers(const struct iovec *iovecs, unsigned int n) {}
+
+void IoUring::RegisterBufferRing(struct io_uring_buf_ring *ring,
+                                 unsigned int entries, uint16_t group) {}
+
+IoUringReceiver::IoUringReceiver(int socket, unsigned int nbuffers,
+                                 unsigned int max_payload_size,
+                                 unsigned int control_size)
+    : ring_(4), socket_(socket) {}
+
+IoUringReceiver::~IoUringReceiver() {}
+
+void IoUringReceiver::Arm() {}
+
+void IoUringReceiver::ReturnBuffer(uint16_t id) {}
+
+bool IoUringReceiver::Wait(int timeout) { return false; }
+
+IoUringFileBuffer::IoUringFileBuffer(const std::string &filename,
+                                     unsigned int nbuffers,
+                                     unsigned int buffer_size)
+    : ring_(2 * nbuffers) {}
+
+IoUringFileBuffer::~IoUringFileBuffer() {}
+
+IoUringFileBuffer::int_type IoUringFileBuffer::overflow(int_type c) {
+    return traits_type::eof();
+}
+
+std::streamsize IoUringFileBuffer::xsputn(const char *s, std::streamsize n) {
+    return 0;
+}
+
+int IoUringFileBuffer::sync() { return -1; }
+
+void IoUringFileBuffer::SubmitCurrent() {}
+
+void IoUringFileBuffer::WaitForBuffer(unsigned int index) {}
+
+void IoUringFileBuffer::Reap() {}
+
+#endif
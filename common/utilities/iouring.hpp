@@ -0,0 +1,252 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "yaml-cpp/yaml.h"
+
+// Multishot receive into provided buffer rings needs the io_uring definitions
+// of Linux 6.0. With older kernel headers the io_uring classes below are still
+// declared, but cannot be constructed and IoUring::supported() returns false.
+#ifdef IORING_RECV_MULTISHOT
+#define HAVE_IO_URING 1
+#else
+#define HAVE_IO_URING 0
+#endif
+
+// Backend for socket reads and file writes: plain blocking system calls, or
+// asynchronous submission through io_uring.
+enum class IoBackend { SYNC = 0, IO_URING };
+
+inline std::string iobackend_to_string(IoBackend x) {
+    std::string s;
+#define MATCH(p, name)                                                         \
+    case (IoBackend::p):                                                       \
+        s = name;                                                              \
+        break;
+    switch (x) {
+        MATCH(SYNC, "sync");
+        MATCH(IO_URING, "io_uring");
+    }
+#undef MATCH
+    return s;
+}
+
+inline IoBackend string_to_iobackend(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), (int (*)(int))std::tolower);
+#define MATCH(p, name)                                                         \
+    if (s == name) {                                                           \
+        return IoBackend::p;                                                   \
+    }
+    MATCH(SYNC, "sync");
+    MATCH(IO_URING, "io_uring");
+    MATCH(IO_URING, "iouring");
+    throw std::runtime_error("Invalid IoBackend value.");
+#undef MATCH
+}
+
+namespace YAML {
+template <> struct convert<IoBackend> {
+    static Node encode(const IoBackend &rhs) {
+        Node node;
+        node = iobackend_to_string(rhs);
+        return node;
+    }
+
+    static bool decode(const Node &node, IoBackend &rhs) {
+        rhs = string_to_iobackend(node.as<std::string>());
+        return true;
+    }
+};
+} // namespace YAML
+
+// Minimal io_uring instance (submission and completion queue) that is driven
+// from a single thread. The constructor throws std::runtime_error if the
+// kernel lacks support for the features that are used here (Linux 5.11), or
+// if Falcon was built without io_uring support (see HAVE_IO_URING).
+class IoUring {
+  public:
+    explicit IoUring(unsigned int entries);
+    ~IoUring();
+
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+
+    // whether io_uring can be used at all (tested once)
+    static bool supported();
+
+    int fd() const { return fd_; }
+
+    // Returns a cleared submission queue entry, or nullptr if the queue is
+    // full. Entries are passed to the kernel by Submit or SubmitAndWait.
+    struct io_uring_sqe *GetSqe();
+    int Submit();
+
+    // Submit pending entries and wait for at most timeout milliseconds
+    // (forever if negative) for a completion. Returns false on time-out.
+    bool SubmitAndWait(int timeout);
+
+    // Call handler(const io_uring_cqe &) for all available completions.
+    template <typename Handler> unsigned int ForEachCompletion(Handler &&handler);
+    // oldest available completion (without consuming it), or nullptr
+    const struct io_uring_cqe *PeekCompletion() const;
+
+    void RegisterBuffers(const struct iovec *iovecs, unsigned int n);
+    void RegisterBufferRing(struct io_uring_buf_ring *ring,
+                            unsigned int entries, uint16_t group);
+
+  protected:
+    bool completion_available() const;
+
+  protected:
+    int fd_ = -1;
+    void *ring_map_ = nullptr;
+    std::size_t ring_map_size_ = 0;
+    struct io_uring_sqe *sqes_ = nullptr;
+    std::size_t sqes_size_ = 0;
+
+    unsigned int sq_entries_;
+    unsigned int *sq_head_;
+    unsigned int *sq_tail_;
+    unsigned int *sq_mask_;
+    unsigned int *sq_array_;
+    unsigned int sq_local_tail_ = 0;
+    unsigned int sq_submitted_ = 0;
+
+    unsigned int *cq_head_;
+    unsigned int *cq_tail_;
+    unsigned int *cq_mask_;
+    struct io_uring_cqe *cqes_;
+};
+
+// Receives datagrams from a socket with a single multishot recvmsg request
+// into a ring of kernel-selected (provided) buffers, so that no system call
+// is needed per datagram once the request is armed.
+class IoUringReceiver {
+  public:
+    // The number of buffers is rounded up to a power of two. Control data
+    // (e.g. for receive timestamps) is requested if control_size > 0.
+    IoUringReceiver(int socket, unsigned int nbuffers,
+                    unsigned int max_payload_size,
+                    unsigned int control_size = 0);
+    ~IoUringReceiver();
+
+    IoUringReceiver(const IoUringReceiver &) = delete;
+    IoUringReceiver &operator=(const IoUringReceiver &) = delete;
+
+    // Wait for at most timeout milliseconds for received datagrams.
+    bool Wait(int timeout);
+
+    // Call handler(payload, length, message) for every received datagram,
+    // where message holds the control data and flags (e.g. MSG_TRUNC), and
+    // hand the buffers back. Returns the number of datagrams.
+    template <typename Handler> uint64_t ForEachDatagram(Handler &&handler);
+
+    // number of times that the request had to be re-armed, e.g. because all
+    // buffers were in use
+    uint64_t nrearmed() const { return nrearmed_; }
+
+  protected:
+    void Arm();
+    void ReturnBuffer(uint16_t id);
+
+  protected:
+    static constexpr uint16_t BUFFER_GROUP = 0;
+    static constexpr uint64_t RECEIVE_TAG = 1;
+    static constexpr uint64_t CANCEL_TAG = 2;
+
+    IoUring ring_;
+    int socket_;
+    struct msghdr message_;
+    unsigned int nbuffers_;
+    unsigned int buffer_size_;
+    std::vector<char> buffers_;
+    struct io_uring_buf_ring *buffer_ring_ = nullptr;
+    std::size_t buffer_ring_size_ = 0;
+    uint16_t buffer_ring_tail_ = 0;
+    uint64_t nrearmed_ = 0;
+};
+
+// Stream buffer that writes a file through io_uring. Data is collected in a
+// small number of registered buffers; a full buffer is submitted as a single
+// write and the caller only waits when it needs a buffer that is still in
+// flight.
+class IoUringFileBuffer : public std::streambuf {
+  public:
+    IoUringFileBuffer(const std::string &filename, unsigned int nbuffers = 4,
+                      unsigned int buffer_size = 1 << 20);
+    ~IoUringFileBuffer();
+
+  protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+    int sync() override;
+
+    void SubmitCurrent();
+    void WaitForBuffer(unsigned int index);
+    void Reap();
+    char *buffer(unsigned int index) {
+        return buffers_.data() + static_cast<std::size_t>(index) * buffer_size_;
+    }
+
+  protected:
+    IoUring ring_;
+    int fd_ = -1;
+    unsigned int nbuffers_;
+    unsigned int buffer_size_;
+    std::vector<char> buffers_;
+    std::vector<bool> in_flight_;
+    std::vector<uint64_t> offsets_;
+    std::vector<uint32_t> lengths_;
+    unsigned int current_ = 0;
+    uint64_t offset_ = 0;
+    bool error_ = false;
+};
+
+// Output file stream backed by IoUringFileBuffer.
+class IoUringOfstream : public std::ostream {
+  public:
+    explicit IoUringOfstream(const std::string &filename,
+                             unsigned int nbuffers = 4,
+                             unsigned int buffer_size = 1 << 20)
+        : std::ostream(nullptr), buffer_(filename, nbuffers, buffer_size) {
+        rdbuf(&buffer_);
+    }
+
+  protected:
+    IoUringFileBuffer buffer_;
+};
+
+#include "iouring.ipp"
@@ -0,0 +1,100 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#if HAVE_IO_URING
+
+template <typename Handler>
+unsigned int IoUring::ForEachCompletion(Handler &&handler) {
+    unsigned int head = *cq_head_;
+    unsigned int tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    unsigned int n = tail - head;
+
+    for (; head != tail; ++head) {
+        handler(cqes_[head & *cq_mask_]);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+    return n;
+}
+
+template <typename Handler>
+uint64_t IoUringReceiver::ForEachDatagram(Handler &&handler) {
+    uint64_t n = 0;
+    bool armed = true;
+
+    ring_.ForEachCompletion([&](const struct io_uring_cqe &cqe) {
+        if (cqe.user_data != RECEIVE_TAG) {
+            return;
+        }
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            armed = false;
+        }
+        if (cqe.res < 0 || !(cqe.flags & IORING_CQE_F_BUFFER)) {
+            return;
+        }
+
+        uint16_t id = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+        char *data = buffers_.data() + static_cast<std::size_t>(id) * buffer_size_;
+        auto out = reinterpret_cast<struct io_uring_recvmsg_out *>(data);
+
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_control =
+            data + sizeof(struct io_uring_recvmsg_out) + message_.msg_namelen;
+        message.msg_controllen = out->controllen;
+        message.msg_flags = out->flags;
+
+        // the payload follows the full control buffer and is truncated to the
+        // space that is left in the buffer
+        const char *payload = static_cast<const char *>(message.msg_control) +
+                              message_.msg_controllen;
+        uint32_t length = std::min<uint32_t>(
+            out->payloadlen, data + buffer_size_ - payload);
+        if (length < out->payloadlen) {
+            message.msg_flags |= MSG_TRUNC;
+        }
+
+        handler(payload, length, static_cast<const struct msghdr &>(message));
+        ReturnBuffer(id);
+        ++n;
+    });
+
+    __atomic_store_n(&buffer_ring_->tail, buffer_ring_tail_, __ATOMIC_RELEASE);
+
+    if (!armed) {
+        ++nrearmed_;
+        Arm();
+    }
+
+    return n;
+}
+
+#else
+
+template <typename Handler>
+unsigned int IoUring::ForEachCompletion(Handler &&handler) {
+    return 0;
+}
+
+template <typename Handler>
+uint64_t IoUringReceiver::ForEachDatagram(Handler &&handler) {
+    return 0;
+}
+
+#endif
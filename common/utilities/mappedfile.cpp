@@ -0,0 +1,160 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "mappedfile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+MappedFileBuffer::MappedFileBuffer(const std::string &filename,
+                                   std::size_t extent_size) {
+    std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    extent_size_ =
+        std::max<std::size_t>((extent_size + page_size - 1) / page_size, 1) *
+        page_size;
+
+    fd_ = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Unable to open " + filename + ": " +
+                                 strerror(errno));
+    }
+
+    // the first extent is mapped up front, so that a file system without
+    // support for shared mappings is detected when the file is opened
+    if (!MapNextExtent()) {
+        int error = errno;
+        close(fd_);
+        fd_ = -1;
+        throw std::runtime_error("Unable to map " + filename + ": " +
+                                 strerror(error));
+    }
+}
+
+MappedFileBuffer::~MappedFileBuffer() { Close(); }
+
+uint64_t MappedFileBuffer::length() const {
+    return extent_offset_ + (pptr() - pbase());
+}
+
+bool MappedFileBuffer::Close() {
+    if (fd_ < 0) {
+        return !error_;
+    }
+    uint64_t n = length();
+    UnmapExtent();
+    if (ftruncate(fd_, n) != 0) {
+        error_ = true;
+    }
+    close(fd_);
+    fd_ = -1;
+    return !error_;
+}
+
+MappedFileBuffer::int_type MappedFileBuffer::overflow(int_type c) {
+    if (error_ || !MapNextExtent()) {
+        error_ = true;
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize MappedFileBuffer::xsputn(const char *s, std::streamsize n) {
+    std::streamsize written = 0;
+    while (written < n) {
+        if (pptr() == epptr() &&
+            traits_type::eq_int_type(overflow(traits_type::eof()),
+                                     traits_type::eof())) {
+            break;
+        }
+        std::streamsize chunk =
+            std::min<std::streamsize>(n - written, epptr() - pptr());
+        memcpy(pptr(), s + written, chunk);
+        pbump(static_cast<int>(chunk));
+        written += chunk;
+    }
+    return written;
+}
+
+int MappedFileBuffer::sync() {
+    // only a hint, data in the mapping is visible to readers of the file
+    if (extent_ != nullptr && msync(extent_, extent_size_, MS_ASYNC) != 0) {
+        return -1;
+    }
+    return error_ ? -1 : 0;
+}
+
+bool MappedFileBuffer::MapNextExtent() {
+    uint64_t offset = 0;
+    if (extent_ != nullptr) {
+        offset = extent_offset_ + extent_size_;
+        UnmapExtent();
+    }
+
+    // reserve blocks for the whole extent at once, so that writing into the
+    // mapping does not trigger block allocation for every page (and cannot
+    // fail with SIGBUS on a full disk)
+    if (fallocate(fd_, 0, offset, extent_size_) != 0) {
+        if (errno != EOPNOTSUPP ||
+            ftruncate(fd_, offset + extent_size_) != 0) {
+            return false;
+        }
+    }
+
+    void *p = mmap(nullptr, extent_size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd_, offset);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    madvise(p, extent_size_, MADV_SEQUENTIAL);
+
+    extent_ = static_cast<char *>(p);
+    extent_offset_ = offset;
+    setp(extent_, extent_ + extent_size_);
+    return true;
+}
+
+void MappedFileBuffer::UnmapExtent() {
+    if (extent_ == nullptr) {
+        return;
+    }
+    std::size_t n = pptr() - pbase();
+    msync(extent_, extent_size_, MS_ASYNC);
+    munmap(extent_, extent_size_);
+    extent_ = nullptr;
+    setp(nullptr, nullptr);
+
+    // start writeback of the finished extent without waiting for it, and
+    // drop the (by now mostly clean) pages of the extent before it
+    sync_file_range(fd_, extent_offset_, n, SYNC_FILE_RANGE_WRITE);
+    if (extent_offset_ >= extent_size_) {
+        posix_fadvise(fd_, extent_offset_ - extent_size_, extent_size_,
+                      POSIX_FADV_DONTNEED);
+    }
+    extent_offset_ += n;
+}
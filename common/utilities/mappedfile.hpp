@@ -0,0 +1,75 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+// Stream buffer that writes a file through a shared memory mapping. The file
+// is preallocated in large extents and only one extent is mapped at a time;
+// data is copied straight into the mapping. When an extent is full, writeback
+// of its pages is started and the pages of the extent before it are dropped
+// from the page cache. On close, the file is truncated to the length that
+// was actually written.
+class MappedFileBuffer : public std::streambuf {
+  public:
+    explicit MappedFileBuffer(const std::string &filename,
+                              std::size_t extent_size = 64 << 20);
+    ~MappedFileBuffer();
+
+    MappedFileBuffer(const MappedFileBuffer &) = delete;
+    MappedFileBuffer &operator=(const MappedFileBuffer &) = delete;
+
+    // unmap, truncate and close the file
+    bool Close();
+
+    // number of bytes written so far
+    uint64_t length() const;
+
+  protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+    int sync() override;
+
+    bool MapNextExtent();
+    void UnmapExtent();
+
+  protected:
+    int fd_ = -1;
+    std::size_t extent_size_;
+    char *extent_ = nullptr;
+    uint64_t extent_offset_ = 0;
+    bool error_ = false;
+};
+
+// Output file stream backed by MappedFileBuffer.
+class MappedOfstream : public std::ostream {
+  public:
+    explicit MappedOfstream(const std::string &filename,
+                            std::size_t extent_size = 64 << 20)
+        : std::ostream(nullptr), buffer_(filename, extent_size) {
+        rdbuf(&buffer_);
+    }
+
+  protected:
+    MappedFileBuffer buffer_;
+};
@@ -0,0 +1,211 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "packetring.hpp"
+
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+PacketRing::~PacketRing() { Close(); }
+
+void PacketRing::Open(const std::string &interface, uint32_t address,
+                      uint16_t port, unsigned int block_size,
+                      unsigned int nblocks, unsigned int block_timeout) {
+    Close();
+
+    if (block_size == 0 || block_size % getpagesize() != 0 || nblocks == 0) {
+        throw std::runtime_error(
+            "Packet ring block size should be a multiple of the page size.");
+    }
+
+    unsigned int ifindex = if_nametoindex(interface.c_str());
+    if (ifindex == 0) {
+        throw std::runtime_error("Unknown network interface: " + interface);
+    }
+
+    // a datagram socket strips the link layer header, so that the filter and
+    // the frames start at the IP header
+    fd_ = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+    if (fd_ < 0) {
+        throw std::runtime_error(
+            "Unable to create packet socket (requires CAP_NET_RAW): " +
+            std::string(strerror(errno)));
+    }
+
+    // classic BPF: unfragmented IPv4/UDP to the given destination
+    struct sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 9), // protocol
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 0, 9),
+        BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 6), // flags and fragment offset
+        BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x3fff, 7, 0),
+        BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, 0), // IP header length
+        BPF_STMT(BPF_LD | BPF_H | BPF_IND, 2),  // UDP destination port
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, port, 0, 4),
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 16), // IP destination address
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ntohl(address), 1, 0),
+        BPF_STMT(BPF_RET | BPF_K, address == INADDR_ANY ? 0xffffu : 0u),
+        BPF_STMT(BPF_RET | BPF_K, 0xffff),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    struct sock_fprog filter = {sizeof(code) / sizeof(code[0]), code};
+
+    int version = TPACKET_V3;
+
+    struct tpacket_req3 request;
+    memset(&request, 0, sizeof(request));
+    request.tp_block_size = block_size;
+    request.tp_block_nr = nblocks;
+    request.tp_frame_size = TPACKET_ALIGNMENT << 7;
+    request.tp_frame_nr = block_size / request.tp_frame_size * nblocks;
+    request.tp_retire_blk_tov = block_timeout;
+
+    if (setsockopt(fd_, SOL_SOCKET, SO_ATTACH_FILTER, &filter,
+                   sizeof(filter)) < 0 ||
+        setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version,
+                   sizeof(version)) < 0 ||
+        setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &request,
+                   sizeof(request)) < 0) {
+        std::string error(strerror(errno));
+        Close();
+        throw std::runtime_error("Unable to set up packet ring: " + error);
+    }
+
+    map_size_ = static_cast<std::size_t>(block_size) * nblocks;
+    void *map = mmap(NULL, map_size_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_LOCKED, fd_, 0);
+    if (map == MAP_FAILED) {
+        map = mmap(NULL, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    }
+    if (map == MAP_FAILED) {
+        std::string error(strerror(errno));
+        map_size_ = 0;
+        Close();
+        throw std::runtime_error("Unable to map packet ring: " + error);
+    }
+    map_ = static_cast<char *>(map);
+    block_size_ = block_size;
+    nblocks_ = nblocks;
+    current_block_ = 0;
+
+    struct sockaddr_ll link_address;
+    memset(&link_address, 0, sizeof(link_address));
+    link_address.sll_family = AF_PACKET;
+    link_address.sll_protocol = htons(ETH_P_IP);
+    link_address.sll_ifindex = ifindex;
+    if (bind(fd_, reinterpret_cast<struct sockaddr *>(&link_address),
+             sizeof(link_address)) < 0) {
+        std::string error(strerror(errno));
+        Close();
+        throw std::runtime_error("Unable to bind packet socket to " +
+                                 interface + ": " + error);
+    }
+
+    ndropped(); // reset kernel statistics
+}
+
+void PacketRing::Close() {
+    if (map_ != nullptr) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool PacketRing::Wait(int timeout) {
+    if (block_ready(current_block_)) {
+        return true;
+    }
+    struct pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLIN | POLLERR;
+    pfd.revents = 0;
+    poll(&pfd, 1, timeout);
+    return block_ready(current_block_);
+}
+
+uint64_t PacketRing::ndropped() {
+    struct tpacket_stats_v3 stats;
+    socklen_t length = sizeof(stats);
+    if (getsockopt(fd_, SOL_PACKET, PACKET_STATISTICS, &stats, &length) < 0) {
+        return 0;
+    }
+    return stats.tp_drops;
+}
+
+struct tpacket_block_desc *PacketRing::block(unsigned int index) const {
+    return reinterpret_cast<struct tpacket_block_desc *>(
+        map_ + static_cast<std::size_t>(index) * block_size_);
+}
+
+bool PacketRing::block_ready(unsigned int index) const {
+    auto status = reinterpret_cast<std::atomic<uint32_t> *>(
+        &block(index)->hdr.bh1.block_status);
+    return status->load(std::memory_order_acquire) & TP_STATUS_USER;
+}
+
+void PacketRing::release_block(unsigned int index) {
+    auto status = reinterpret_cast<std::atomic<uint32_t> *>(
+        &block(index)->hdr.bh1.block_status);
+    status->store(TP_STATUS_KERNEL, std::memory_order_release);
+}
+
+bool PacketRing::datagram(const struct tpacket3_hdr *header,
+                          const char *&payload, uint32_t &length) const {
+    // on loopback, sent datagrams are seen twice
+    auto link_address = reinterpret_cast<const struct sockaddr_ll *>(
+        reinterpret_cast<const char *>(header) +
+        TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+    if (link_address->sll_pkttype == PACKET_OUTGOING) {
+        return false;
+    }
+
+    auto ip = reinterpret_cast<const char *>(header) + header->tp_net;
+    uint32_t ip_header_length = (ip[0] & 0x0f) * 4;
+    if (header->tp_snaplen < ip_header_length + sizeof(struct udphdr)) {
+        return false;
+    }
+
+    auto udp = reinterpret_cast<const struct udphdr *>(ip + ip_header_length);
+    uint32_t udp_length = ntohs(udp->len);
+    if (udp_length < sizeof(struct udphdr) ||
+        ip_header_length + udp_length > header->tp_snaplen) {
+        return false;
+    }
+
+    payload = reinterpret_cast<const char *>(udp) + sizeof(struct udphdr);
+    length = udp_length - sizeof(struct udphdr);
+    return true;
+}
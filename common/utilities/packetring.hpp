@@ -0,0 +1,85 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <linux/if_packet.h>
+#include <sys/uio.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "time.hpp"
+
+// Memory-mapped TPACKET_V3 receive ring on an AF_PACKET socket, with a BPF
+// filter that only lets through UDP datagrams for a single destination
+// address and port. Received datagrams are read in place from the ring,
+// without a system call per datagram.
+class PacketRing {
+  public:
+    PacketRing() = default;
+    ~PacketRing();
+
+    PacketRing(const PacketRing &) = delete;
+    PacketRing &operator=(const PacketRing &) = delete;
+
+    // Open the ring on a network interface (e.g. "eth0" or "lo"). The address
+    // is in network byte order (INADDR_ANY matches all addresses) and the port
+    // in host byte order. The kernel hands over a block to user space when
+    // it is full or when block_timeout milliseconds have passed.
+    void Open(const std::string &interface, uint32_t address, uint16_t port,
+              unsigned int block_size = 1 << 16, unsigned int nblocks = 64,
+              unsigned int block_timeout = 1);
+    void Close();
+
+    bool is_open() const { return fd_ >= 0; }
+    int fd() const { return fd_; }
+
+    // Wait for at most timeout milliseconds until a block is available.
+    // Returns false on time-out.
+    bool Wait(int timeout);
+
+    // Call handler(payload, length, arrival_time) for every UDP payload in
+    // the blocks that are available and hand the blocks back to the kernel.
+    // The arrival time is the kernel receive time converted to Clock.
+    // Returns the number of datagrams.
+    template <typename Handler> uint64_t ForEachDatagram(Handler &&handler);
+
+    // number of datagrams that the kernel dropped because the ring was full,
+    // since the last call
+    uint64_t ndropped();
+
+  protected:
+    struct tpacket_block_desc *block(unsigned int index) const;
+    bool block_ready(unsigned int index) const;
+    void release_block(unsigned int index);
+    bool datagram(const struct tpacket3_hdr *header, const char *&payload,
+                  uint32_t &length) const;
+
+  protected:
+    int fd_ = -1;
+    char *map_ = nullptr;
+    std::size_t map_size_ = 0;
+    unsigned int block_size_ = 0;
+    unsigned int nblocks_ = 0;
+    unsigned int current_block_ = 0;
+};
+
+#include "packetring.ipp"
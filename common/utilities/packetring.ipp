@@ -0,0 +1,55 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+
+#include "socketutil.hpp"
+
+template <typename Handler>
+uint64_t PacketRing::ForEachDatagram(Handler &&handler) {
+    uint64_t n = 0;
+    auto offset = system_clock_offset();
+
+    while (block_ready(current_block_)) {
+        auto desc = block(current_block_);
+        auto header = reinterpret_cast<struct tpacket3_hdr *>(
+            reinterpret_cast<char *>(desc) + desc->hdr.bh1.offset_to_first_pkt);
+
+        for (uint32_t k = 0; k < desc->hdr.bh1.num_pkts; ++k) {
+            const char *payload;
+            uint32_t length;
+            if (datagram(header, payload, length)) {
+                TimePoint arrival_time(
+                    std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::seconds(header->tp_sec) +
+                        std::chrono::nanoseconds(header->tp_nsec) - offset));
+                handler(payload, length, arrival_time);
+                ++n;
+            }
+            header = reinterpret_cast<struct tpacket3_hdr *>(
+                reinterpret_cast<char *>(header) + header->tp_next_offset);
+        }
+
+        release_block(current_block_);
+        current_block_ = (current_block_ + 1) % nblocks_;
+    }
+
+    return n;
+}
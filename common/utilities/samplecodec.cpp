@@ -0,0 +1,228 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "samplecodec.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+#include "bitpack.hpp"
+
+namespace {
+
+// counts are limited such that the difference of two counts fits an int32
+constexpr double MAX_COUNT = 1 << 30;
+
+template <typename T> void append(std::vector<uint8_t> &out, const T &value) {
+    std::size_t offset = out.size();
+    out.resize(offset + sizeof(T));
+    memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+template <typename T> void append(std::vector<uint8_t> &out, const T *values,
+                                  std::size_t n) {
+    std::size_t offset = out.size();
+    out.resize(offset + n * sizeof(T));
+    memcpy(out.data() + offset, values, n * sizeof(T));
+}
+
+template <typename T>
+const uint8_t *read(const uint8_t *in, const uint8_t *end, T *values,
+                    std::size_t n = 1) {
+    if (in == nullptr || static_cast<std::size_t>(end - in) < n * sizeof(T)) {
+        return nullptr;
+    }
+    memcpy(values, in, n * sizeof(T));
+    return in + n * sizeof(T);
+}
+
+template <typename T> double effective_step(double step) {
+    return std::is_integral<T>::value ? 1.0 : step;
+}
+
+// quantize samples to counts; fails if any sample is not exactly a count
+// times the step
+template <typename T>
+bool quantize(const T *data, std::size_t n, double step, int32_t *counts) {
+    double inverse = 1.0 / step;
+    for (std::size_t k = 0; k < n; ++k) {
+        double q = std::nearbyint(static_cast<double>(data[k]) * inverse);
+        if (!(std::fabs(q) < MAX_COUNT) ||
+            static_cast<T>(q * step) != data[k]) {
+            return false;
+        }
+        counts[k] = static_cast<int32_t>(q);
+    }
+    return true;
+}
+
+} // namespace
+
+template <typename T>
+SampleBlockMode SampleBlockEncoder::Encode(const T *data,
+                                           const uint64_t *timestamps,
+                                           std::size_t nchannels,
+                                           std::size_t nsamples,
+                                           std::vector<uint8_t> &out) {
+    std::size_t n = nchannels * nsamples;
+    double step = effective_step<T>(step_);
+
+    if (previous_.size() != nchannels) {
+        previous_.assign(nchannels, 0);
+    }
+
+    // timestamps relative to a constant stride
+    uint64_t base = nsamples > 0 ? timestamps[0] : 0;
+    int64_t stride = nsamples > 1 ? static_cast<int64_t>(timestamps[1] - base)
+                                  : 0;
+    values_.resize(std::max(n, nsamples));
+    bool packable = step > 0;
+    for (std::size_t s = 0; s < nsamples && packable; ++s) {
+        int64_t residual = static_cast<int64_t>(
+            timestamps[s] - base - static_cast<uint64_t>(stride) * s);
+        packable = residual >= INT32_MIN && residual <= INT32_MAX;
+        values_[s] = zigzag_encode(static_cast<int32_t>(residual));
+    }
+
+    counts_.resize(n);
+    if (packable) {
+        packable = quantize(data, n, step, counts_.data());
+    }
+
+    if (!packable) {
+        out.push_back(static_cast<uint8_t>(SampleBlockMode::RAW));
+        append(out, timestamps, nsamples);
+        append(out, data, n);
+        std::fill(previous_.begin(), previous_.end(), 0);
+        ++nraw_;
+        return SampleBlockMode::RAW;
+    }
+
+    out.push_back(static_cast<uint8_t>(SampleBlockMode::PACKED));
+    append(out, step);
+    append(out, base);
+    append(out, stride);
+    bitpack_encode(values_.data(), nsamples, out);
+
+    // per channel deltas, channel by channel
+    uint32_t *value = values_.data();
+    for (std::size_t c = 0; c < nchannels; ++c) {
+        int32_t previous = previous_[c];
+        const int32_t *count = counts_.data() + c;
+        for (std::size_t s = 0; s < nsamples; ++s) {
+            *value++ = zigzag_encode(*count - previous);
+            previous = *count;
+            count += nchannels;
+        }
+        previous_[c] = previous;
+    }
+    bitpack_encode(values_.data(), n, out);
+
+    ++npacked_;
+    return SampleBlockMode::PACKED;
+}
+
+template <typename T>
+const uint8_t *SampleBlockDecoder::Decode(const uint8_t *in,
+                                          const uint8_t *end,
+                                          std::size_t nchannels,
+                                          std::size_t nsamples, T *data,
+                                          uint64_t *timestamps) {
+    std::size_t n = nchannels * nsamples;
+
+    if (previous_.size() != nchannels) {
+        previous_.assign(nchannels, 0);
+    }
+
+    uint8_t mode;
+    in = read(in, end, &mode);
+    if (in == nullptr) {
+        return nullptr;
+    }
+
+    if (mode == static_cast<uint8_t>(SampleBlockMode::RAW)) {
+        in = read(in, end, timestamps, nsamples);
+        in = read(in, end, data, n);
+        std::fill(previous_.begin(), previous_.end(), 0);
+        mode_ = SampleBlockMode::RAW;
+        return in;
+    }
+
+    if (mode != static_cast<uint8_t>(SampleBlockMode::PACKED)) {
+        return nullptr;
+    }
+
+    uint64_t base;
+    int64_t stride;
+    in = read(in, end, &step_);
+    in = read(in, end, &base);
+    in = read(in, end, &stride);
+    if (in == nullptr) {
+        return nullptr;
+    }
+
+    values_.resize(std::max(n, nsamples));
+    in = bitpack_decode(in, end, values_.data(), nsamples);
+    if (in == nullptr) {
+        return nullptr;
+    }
+    for (std::size_t s = 0; s < nsamples; ++s) {
+        timestamps[s] = base + static_cast<uint64_t>(stride) * s +
+                        static_cast<uint64_t>(static_cast<int64_t>(
+                            zigzag_decode(values_[s])));
+    }
+
+    in = bitpack_decode(in, end, values_.data(), n);
+    if (in == nullptr) {
+        return nullptr;
+    }
+    const uint32_t *value = values_.data();
+    for (std::size_t c = 0; c < nchannels; ++c) {
+        int32_t count = previous_[c];
+        T *sample = data + c;
+        for (std::size_t s = 0; s < nsamples; ++s) {
+            count += zigzag_decode(*value++);
+            *sample = static_cast<T>(count * step_);
+            sample += nchannels;
+        }
+        previous_[c] = count;
+    }
+
+    mode_ = SampleBlockMode::PACKED;
+    return in;
+}
+
+#define INSTANTIATE(T)                                                         \
+    template SampleBlockMode SampleBlockEncoder::Encode<T>(                    \
+        const T *, const uint64_t *, std::size_t, std::size_t,                 \
+        std::vector<uint8_t> &);                                               \
+    template const uint8_t *SampleBlockDecoder::Decode<T>(                     \
+        const uint8_t *, const uint8_t *, std::size_t, std::size_t, T *,       \
+        uint64_t *);
+
+INSTANTIATE(double)
+INSTANTIATE(float)
+INSTANTIATE(int16_t)
+INSTANTIATE(int32_t)
+INSTANTIATE(uint32_t)
+
+#undef INSTANTIATE
@@ -0,0 +1,99 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lossless codec for blocks of multichannel samples that are stored sample by
+// sample (as in MultiChannelData) with a timestamp per sample.
+//
+// Samples are quantized to integer counts of a fixed step (e.g. the AD bit
+// value of the acquisition system), delta encoded per channel, continuing
+// from the last sample of the previous block, zigzag encoded and bit packed.
+// Timestamps are stored as a base and a stride plus packed residuals. If a
+// block cannot be represented exactly in this way (e.g. samples are not a
+// multiple of the step after filtering), it is stored raw.
+//
+// Block layout (native byte order):
+//   uint8 mode (0 = raw, 1 = packed)
+//   raw:    uint64 timestamps[nsamples], T samples[nsamples * nchannels]
+//   packed: double step, uint64 base, int64 stride,
+//           bitpacked residuals[nsamples],
+//           bitpacked deltas[nchannels * nsamples] (channel by channel)
+//
+// A decoder needs to see the blocks of a stream in the same order as the
+// encoder to reconstruct the deltas.
+
+enum class SampleBlockMode : uint8_t { RAW = 0, PACKED = 1 };
+
+class SampleBlockEncoder {
+  public:
+    explicit SampleBlockEncoder(double step = 1.0) : step_(step) {}
+
+    // quantization step for floating point samples; integer samples are
+    // always stored as is
+    double step() const { return step_; }
+    void set_step(double step) { step_ = step; }
+
+    // forget the last samples of the previous block
+    void Reset() { previous_.clear(); }
+
+    // append an encoded block to out and return the mode that was used
+    template <typename T>
+    SampleBlockMode Encode(const T *data, const uint64_t *timestamps,
+                           std::size_t nchannels, std::size_t nsamples,
+                           std::vector<uint8_t> &out);
+
+    // number of raw and packed blocks so far
+    uint64_t nraw() const { return nraw_; }
+    uint64_t npacked() const { return npacked_; }
+
+  protected:
+    double step_;
+    std::vector<int32_t> previous_;
+    std::vector<int32_t> counts_;
+    std::vector<uint32_t> values_;
+    uint64_t nraw_ = 0;
+    uint64_t npacked_ = 0;
+};
+
+class SampleBlockDecoder {
+  public:
+    void Reset() { previous_.clear(); }
+
+    // Decode a block into data and timestamps; returns a pointer past the
+    // block or nullptr if the block is malformed or incomplete.
+    template <typename T>
+    const uint8_t *Decode(const uint8_t *in, const uint8_t *end,
+                          std::size_t nchannels, std::size_t nsamples,
+                          T *data, uint64_t *timestamps);
+
+    // mode and quantization step of the last decoded block
+    SampleBlockMode mode() const { return mode_; }
+    double step() const { return step_; }
+
+  protected:
+    std::vector<int32_t> previous_;
+    std::vector<uint32_t> values_;
+    SampleBlockMode mode_ = SampleBlockMode::RAW;
+    double step_ = 1.0;
+};
@@ -0,0 +1,67 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include <linux/filter.h>
+
+#include <cstring>
+
+#include "socketutil.hpp"
+
+bool enable_receive_timestamps(int socket) {
+    int enable = 1;
+    return setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable,
+                      sizeof(enable)) == 0;
+}
+
+bool discard_socket_input(int socket) {
+    struct sock_filter code[] = {BPF_STMT(BPF_RET | BPF_K, 0)};
+    struct sock_fprog filter = {1, code};
+    return setsockopt(socket, SOL_SOCKET, SO_ATTACH_FILTER, &filter,
+                      sizeof(filter)) == 0;
+}
+
+std::chrono::nanoseconds system_clock_offset() {
+    struct timespec realtime;
+    auto before = Clock::now();
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    auto after = Clock::now();
+
+    auto midpoint = before + (after - before) / 2;
+    return std::chrono::seconds(realtime.tv_sec) +
+           std::chrono::nanoseconds(realtime.tv_nsec) -
+           std::chrono::duration_cast<std::chrono::nanoseconds>(
+               midpoint.time_since_epoch());
+}
+
+bool receive_timestamp(const struct msghdr &message,
+                       std::chrono::nanoseconds offset, TimePoint &timestamp) {
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(const_cast<struct msghdr *>(&message), cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET &&
+            cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec t;
+            memcpy(&t, CMSG_DATA(cmsg), sizeof(t));
+            timestamp = TimePoint(std::chrono::duration_cast<Clock::duration>(
+                std::chrono::seconds(t.tv_sec) +
+                std::chrono::nanoseconds(t.tv_nsec) - offset));
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,53 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <sys/socket.h>
+#include <time.h>
+
+#include <chrono>
+#include <cstddef>
+
+#include "time.hpp"
+
+// space that is needed in the control buffer of a received message to hold
+// the kernel receive timestamp
+constexpr std::size_t RECEIVE_TIMESTAMP_CONTROL_SIZE =
+    CMSG_SPACE(sizeof(struct timespec));
+
+// Ask the kernel to attach the time at which a datagram arrived on the
+// socket to each received message (SO_TIMESTAMPNS). Returns false if the
+// socket option is not supported.
+bool enable_receive_timestamps(int socket);
+
+// Drop all datagrams that arrive on a socket before they are queued. This
+// keeps a port claimed (so that the kernel does not reply with ICMP port
+// unreachable messages) when the data is captured by other means.
+bool discard_socket_input(int socket);
+
+// Offset of the system clock (which is used for kernel timestamps) relative
+// to Clock. The offset drifts slowly, so it needs to be updated regularly.
+std::chrono::nanoseconds system_clock_offset();
+
+// Extract the kernel receive timestamp from the control messages of a
+// received message and convert it to Clock time, given the offset returned
+// by system_clock_offset. Returns false if there is no timestamp.
+bool receive_timestamp(const struct msghdr &message,
+                       std::chrono::nanoseconds offset, TimePoint &timestamp);
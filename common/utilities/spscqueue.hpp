@@ -0,0 +1,88 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// The capacity is rounded up to a power of two. Both sides keep a cached copy
+// of the other side's index, so that the shared cache lines are only touched
+// when the queue looks full (producer) or empty (consumer).
+template <typename T> class SpscQueue {
+  public:
+    explicit SpscQueue(std::size_t capacity) {
+        std::size_t n = 2;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        items_.resize(n);
+        mask_ = n - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    std::size_t capacity() const { return items_.size(); }
+
+    // producer side, returns false if the queue is full
+    bool push(const T &item) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ >= items_.size()) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ >= items_.size()) {
+                return false;
+            }
+        }
+        items_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, returns false if the queue is empty
+    bool pop(T &item) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+        item = items_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate when called concurrently with push or pop
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+  protected:
+    std::vector<T> items_;
+    std::size_t mask_;
+    alignas(64) std::atomic<uint64_t> head_{0};
+    uint64_t tail_cache_ = 0; // consumer's copy of tail_
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    uint64_t head_cache_ = 0; // producer's copy of head_
+};
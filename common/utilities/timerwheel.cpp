@@ -0,0 +1,263 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "timerwheel.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <immintrin.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+TimerWheel::TimerWheel(std::chrono::microseconds tick,
+                       std::chrono::microseconds max_spin)
+    : tick_(std::max<std::chrono::nanoseconds>(tick,
+                                               std::chrono::microseconds(1))),
+      max_spin_(max_spin), spin_threshold_(max_spin) {
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (timer_fd_ < 0) {
+        throw std::runtime_error(std::string("Unable to create timerfd: ") +
+                                 std::strerror(errno));
+    }
+    event_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fd_ < 0) {
+        close(timer_fd_);
+        throw std::runtime_error(std::string("Unable to create eventfd: ") +
+                                 std::strerror(errno));
+    }
+    current_tick_ = tick_of(Clock::now());
+    thread_ = std::thread(&TimerWheel::Run, this);
+}
+
+TimerWheel::~TimerWheel() {
+    stop_ = true;
+    Wake();
+    thread_.join();
+    close(timer_fd_);
+    close(event_fd_);
+}
+
+TimerWheel::TimerID TimerWheel::Schedule(TimePoint deadline,
+                                         Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TimerID id = next_id_++;
+    uint64_t tick = tick_of(deadline);
+    timers_[id] = Timer{deadline, tick, std::move(callback)};
+    insert(id, tick);
+    if (deadline - spin_threshold_ < wakeup_) {
+        Wake();
+    }
+    return id;
+}
+
+bool TimerWheel::Cancel(TimerID id) {
+    // stale entries in the wheel and due queue are skipped when reached
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timers_.erase(id) > 0;
+}
+
+std::size_t TimerWheel::npending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timers_.size();
+}
+
+std::chrono::nanoseconds TimerWheel::spin_threshold() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return spin_threshold_;
+}
+
+uint64_t TimerWheel::tick_of(TimePoint t) const {
+    auto ns = t.time_since_epoch();
+    return ns.count() < 0 ? 0 : ns / tick_;
+}
+
+TimePoint TimerWheel::time_of(uint64_t tick) const {
+    return TimePoint(std::chrono::duration_cast<Clock::duration>(tick * tick_));
+}
+
+void TimerWheel::insert(TimerID id, uint64_t tick) {
+    if (tick <= current_tick_) {
+        due_.emplace(timers_[id].deadline, id);
+        return;
+    }
+    // timers beyond the range of the wheel are parked in the top level and
+    // re-inserted when that slot is cascaded
+    const uint64_t range = uint64_t(1) << (LEVEL_BITS * NLEVELS);
+    uint64_t delta = std::min(tick - current_tick_, range - 1);
+    tick = current_tick_ + delta;
+
+    int level = 0;
+    while (delta >= (uint64_t(1) << (LEVEL_BITS * (level + 1)))) {
+        ++level;
+    }
+    wheel_[level][(tick >> (LEVEL_BITS * level)) & (NSLOTS - 1)].push_back(id);
+    ++nwheel_;
+}
+
+void TimerWheel::advance(uint64_t tick) {
+    if (nwheel_ == 0) {
+        current_tick_ = std::max(current_tick_, tick);
+        return;
+    }
+    std::vector<TimerID> slot;
+    while (current_tick_ < tick) {
+        ++current_tick_;
+        // cascade the slots of higher levels that start at this tick, from
+        // the top down so that timers can move down more than one level
+        int top = 0;
+        while (top + 1 < NLEVELS &&
+               (current_tick_ &
+                ((uint64_t(1) << (LEVEL_BITS * (top + 1))) - 1)) == 0) {
+            ++top;
+        }
+        for (int level = top; level >= 0; --level) {
+            slot.clear();
+            std::swap(slot,
+                      wheel_[level][(current_tick_ >> (LEVEL_BITS * level)) &
+                                    (NSLOTS - 1)]);
+            nwheel_ -= slot.size();
+            for (auto id : slot) {
+                auto it = timers_.find(id);
+                if (it != timers_.end()) {
+                    insert(id, it->second.tick);
+                }
+            }
+        }
+        if (nwheel_ == 0) {
+            current_tick_ = tick;
+        }
+    }
+}
+
+TimePoint TimerWheel::next_wakeup() const {
+    TimePoint wakeup = TimePoint::max();
+    if (!due_.empty()) {
+        wakeup = due_.top().first - spin_threshold_;
+    }
+    if (nwheel_ > 0) {
+        // first non-empty slot of the lowest level, or else the next cascade
+        uint64_t tick = current_tick_ + 1;
+        for (; tick & (NSLOTS - 1); ++tick) {
+            if (!wheel_[0][tick & (NSLOTS - 1)].empty()) {
+                break;
+            }
+        }
+        wakeup = std::min(wakeup, time_of(tick));
+    }
+    return wakeup;
+}
+
+void TimerWheel::Wake() {
+    uint64_t one = 1;
+    if (write(event_fd_, &one, sizeof(one)) < 0) {
+        // the counter is already non-zero, so the thread will wake up anyway
+    }
+}
+
+void TimerWheel::WaitUntil(TimePoint deadline) {
+    struct itimerspec spec = {};
+    if (deadline != TimePoint::max()) {
+        if (deadline <= Clock::now()) {
+            return;
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      deadline.time_since_epoch())
+                      .count();
+        spec.it_value.tv_sec = ns / 1000000000;
+        spec.it_value.tv_nsec = ns % 1000000000;
+    }
+    // steady_clock is CLOCK_MONOTONIC, so its time points can be used as
+    // absolute timerfd expirations; a zero expiration disarms the timer
+    timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+
+    struct pollfd fds[2] = {{timer_fd_, POLLIN, 0}, {event_fd_, POLLIN, 0}};
+    if (poll(fds, 2, -1) > 0) {
+        uint64_t n;
+        for (auto &fd : fds) {
+            if (fd.revents & POLLIN) {
+                if (read(fd.fd, &n, sizeof(n)) < 0) {
+                    // nothing to read after a spurious wake-up
+                }
+            }
+        }
+    }
+}
+
+void TimerWheel::Calibrate() {
+    // the spin covers the time the thread needs to wake up from the timerfd,
+    // so that callbacks are not delayed by it
+    auto latency = std::chrono::nanoseconds::zero();
+    for (int k = 0; k < 5; ++k) {
+        TimePoint target = Clock::now() + std::chrono::microseconds(200);
+        WaitUntil(target);
+        while (Clock::now() < target) {
+            WaitUntil(target);
+        }
+        latency = std::max<std::chrono::nanoseconds>(latency,
+                                                     Clock::now() - target);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    spin_threshold_ = std::min<std::chrono::nanoseconds>(
+        2 * latency + std::chrono::microseconds(5), max_spin_);
+}
+
+void TimerWheel::Run() {
+    // by default, the kernel may delay timer expirations by 50 us to
+    // coalesce wake-ups
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+    Calibrate();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        advance(tick_of(Clock::now()));
+
+        if (!due_.empty() &&
+            due_.top().first - Clock::now() <= spin_threshold_) {
+            TimePoint deadline = due_.top().first;
+            auto it = timers_.find(due_.top().second);
+            due_.pop();
+            if (it == timers_.end()) {
+                continue; // cancelled
+            }
+            Callback callback = std::move(it->second.callback);
+            timers_.erase(it);
+            lock.unlock();
+            while (Clock::now() < deadline) {
+                _mm_pause();
+            }
+            callback();
+            lock.lock();
+            continue;
+        }
+
+        wakeup_ = next_wakeup();
+        TimePoint wakeup = wakeup_;
+        lock.unlock();
+        WaitUntil(wakeup);
+        lock.lock();
+        wakeup_ = TimePoint::max();
+    }
+}
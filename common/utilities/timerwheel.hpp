@@ -0,0 +1,124 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "time.hpp"
+
+// Timer service with a hierarchical timing wheel (4 levels of 64 slots) and a
+// dedicated thread that runs the callbacks of expired timers. Timers are kept
+// in the wheel with a resolution of one tick. Once its tick is reached, a
+// timer moves to a small queue ordered by exact deadline, and the thread
+// sleeps on a timerfd (CLOCK_MONOTONIC, TFD_TIMER_ABSTIME) until shortly
+// before the deadline. The remaining stretch is spun, so that callbacks run
+// within a few microseconds of their deadline. The length of the spin is
+// calibrated against the measured wake-up latency of the timerfd and is at
+// most max_spin.
+//
+// Callbacks run on the timer thread and should be short; they can schedule
+// and cancel timers.
+class TimerWheel {
+  public:
+    typedef uint64_t TimerID;
+    typedef std::function<void()> Callback;
+
+    static const int LEVEL_BITS = 6;
+    static const int NLEVELS = 4;
+    static const uint64_t NSLOTS = uint64_t(1) << LEVEL_BITS;
+
+    explicit TimerWheel(
+        std::chrono::microseconds tick = std::chrono::microseconds(1000),
+        std::chrono::microseconds max_spin = std::chrono::microseconds(100));
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    // runs callback at deadline, or as soon as possible if the deadline has
+    // passed already
+    TimerID Schedule(TimePoint deadline, Callback callback);
+
+    template <typename Rep, typename Period>
+    TimerID ScheduleAfter(std::chrono::duration<Rep, Period> delay,
+                          Callback callback) {
+        return Schedule(Clock::now() + delay, std::move(callback));
+    }
+
+    // returns false if the timer has fired (or is about to) or was unknown
+    bool Cancel(TimerID id);
+
+    std::size_t npending() const;
+    std::chrono::nanoseconds spin_threshold() const;
+
+  protected:
+    struct Timer {
+        TimePoint deadline;
+        uint64_t tick;
+        Callback callback;
+    };
+
+    typedef std::pair<TimePoint, TimerID> DueTimer;
+
+    void Run();
+    void Calibrate();
+    void WaitUntil(TimePoint deadline);
+    void Wake();
+
+    // the methods below expect the mutex to be held
+    uint64_t tick_of(TimePoint t) const;
+    TimePoint time_of(uint64_t tick) const;
+    void insert(TimerID id, uint64_t tick);
+    void advance(uint64_t tick);
+    TimePoint next_wakeup() const;
+
+  protected:
+    const std::chrono::nanoseconds tick_;
+    const std::chrono::nanoseconds max_spin_;
+    std::chrono::nanoseconds spin_threshold_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<TimerID, Timer> timers_;
+    std::array<std::array<std::vector<TimerID>, NSLOTS>, NLEVELS> wheel_;
+    std::size_t nwheel_ = 0;
+    // timers of which the tick has been reached, ordered by deadline
+    std::priority_queue<DueTimer, std::vector<DueTimer>,
+                        std::greater<DueTimer>>
+        due_;
+    uint64_t current_tick_;
+    TimerID next_id_ = 1;
+    // time until which the timer thread sleeps
+    TimePoint wakeup_ = TimePoint::max();
+
+    int timer_fd_;
+    int event_fd_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
@@ -18,6 +18,7 @@
 // ---------------------------------------------------------------------
 
 #include "zmqutil.hpp"
+#include <algorithm>
 #include <string>
 
 // Convert string to 0MQ string and send to socket
@@ -97,3 +98,109 @@ bool s_nonblocking_recv_multi(zmq::socket_t &socket, zmq_frames &frames) {
     } while (sockopt_rcvmore(socket));
     return !frames.empty();
 }
+
+struct ZMQBufferPoolState {
+    std::mutex mutex;
+    std::vector<ZMQBufferPool::Buffer *> free;
+    std::size_t nallocated = 0;
+    bool closed = false;
+};
+
+ZMQBufferPool::Buffer::int_type ZMQBufferPool::Buffer::overflow(int_type c) {
+    Reserve(1);
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize ZMQBufferPool::Buffer::xsputn(const char *s,
+                                              std::streamsize n) {
+    if (epptr() - pptr() < n) {
+        Reserve(n);
+    }
+    memcpy(pptr(), s, n);
+    pbump(static_cast<int>(n));
+    return n;
+}
+
+void ZMQBufferPool::Buffer::Reserve(std::size_t n) {
+    std::size_t used = size();
+    if (storage_.size() - used >= n) {
+        return;
+    }
+    storage_.resize(std::max(2 * storage_.size(), used + n));
+    setp(storage_.data(), storage_.data() + storage_.size());
+    pbump(static_cast<int>(used));
+}
+
+ZMQBufferPool::ZMQBufferPool(std::size_t initial_capacity)
+    : initial_capacity_(initial_capacity),
+      state_(std::make_shared<ZMQBufferPoolState>()) {}
+
+ZMQBufferPool::~ZMQBufferPool() {
+    // buffers that are still owned by 0MQ are deleted when released
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->closed = true;
+    for (auto buffer : state_->free) {
+        delete buffer;
+    }
+    state_->free.clear();
+}
+
+ZMQBufferPool::Buffer *ZMQBufferPool::Acquire() {
+    Buffer *buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->free.empty()) {
+            buffer = state_->free.back();
+            state_->free.pop_back();
+        } else {
+            ++state_->nallocated;
+        }
+    }
+    if (buffer == nullptr) {
+        buffer = new Buffer();
+        buffer->storage_.resize(initial_capacity_);
+        buffer->state_ = state_;
+    }
+    buffer->Clear();
+    return buffer;
+}
+
+void ZMQBufferPool::Release(Buffer *buffer) { Free(nullptr, buffer); }
+
+bool ZMQBufferPool::Send(zmq::socket_t &socket, Buffer *buffer, int more) {
+    zmq_msg_t message;
+    std::size_t size = buffer->size();
+    if (zmq_msg_init_data(&message, buffer->storage_.data(), size, &Free,
+                          buffer) != 0) {
+        Release(buffer);
+        return false;
+    }
+    int rc = zmq_msg_send(&message, socket, more);
+    if (rc < 0) {
+        // message (and with it the buffer) is still ours
+        zmq_msg_close(&message);
+        return false;
+    }
+    return static_cast<std::size_t>(rc) == size;
+}
+
+std::size_t ZMQBufferPool::nallocated() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->nallocated;
+}
+
+void ZMQBufferPool::Free(void *data, void *hint) {
+    Buffer *buffer = static_cast<Buffer *>(hint);
+    // keep the state alive while the lock is held
+    std::shared_ptr<ZMQBufferPoolState> state = buffer->state_;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->closed) {
+        delete buffer;
+    } else {
+        state->free.push_back(buffer);
+    }
+}
@@ -21,7 +21,11 @@
 
 #include <cstring>
 #include <deque>
+#include <memory>
+#include <mutex>
+#include <streambuf>
 #include <string>
+#include <vector>
 #include <zmq.hpp>
 
 typedef std::deque<std::string> zmq_frames;
@@ -40,3 +44,54 @@ bool sockopt_rcvmore(zmq::socket_t &socket);
 zmq_frames s_blocking_recv_multi(zmq::socket_t &socket);
 // Non-blocking receive multi-part message
 bool s_nonblocking_recv_multi(zmq::socket_t &socket, zmq_frames &frames);
+
+struct ZMQBufferPoolState;
+
+// Pool of growable message buffers for zero-copy sending. Data is serialized
+// straight into a buffer (which is a stream buffer), after which the buffer
+// is handed to 0MQ without copying. The buffer returns to the pool when 0MQ
+// is done with it, which may happen in one of its I/O threads and after the
+// pool has been destroyed.
+class ZMQBufferPool {
+  public:
+    class Buffer : public std::streambuf {
+      public:
+        // discard content, but keep capacity
+        void Clear() { setp(storage_.data(), storage_.data() + storage_.size()); }
+        std::size_t size() const { return pptr() - pbase(); }
+        const char *data() const { return pbase(); }
+
+      protected:
+        friend class ZMQBufferPool;
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(const char *s, std::streamsize n) override;
+        void Reserve(std::size_t n);
+
+        std::vector<char> storage_;
+        std::shared_ptr<ZMQBufferPoolState> state_;
+    };
+
+    explicit ZMQBufferPool(std::size_t initial_capacity = 4096);
+    ~ZMQBufferPool();
+
+    ZMQBufferPool(const ZMQBufferPool &) = delete;
+    ZMQBufferPool &operator=(const ZMQBufferPool &) = delete;
+
+    // get an empty buffer from the pool (allocates if the pool is empty)
+    Buffer *Acquire();
+    // return a buffer that was not sent
+    void Release(Buffer *buffer);
+
+    // Send the content of a buffer as a message (part), after which the
+    // buffer is owned by 0MQ. Returns false if sending failed.
+    bool Send(zmq::socket_t &socket, Buffer *buffer, int more = 0);
+
+    // number of buffers that have been allocated
+    std::size_t nallocated() const;
+
+  protected:
+    static void Free(void *data, void *hint);
+
+    std::size_t initial_capacity_;
+    std::shared_ptr<ZMQBufferPoolState> state_;
+};
@@ -0,0 +1,109 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "arena.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "logging/log.hpp"
+
+namespace {
+std::atomic<bool> default_hugepages{false};
+std::atomic<bool> default_prefault{true};
+
+const std::size_t HUGEPAGE_SIZE = 2 * 1024 * 1024;
+
+std::size_t round_up(std::size_t n, std::size_t multiple) {
+    return ((n + multiple - 1) / multiple) * multiple;
+}
+} // namespace
+
+Arena::Arena(std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (default_prefault.load()) {
+        flags |= MAP_POPULATE;
+    }
+
+    void *p = MAP_FAILED;
+
+    if (default_hugepages.load()) {
+        // explicit huge pages need to be reserved by the administrator
+        // (vm.nr_hugepages), otherwise fall back to transparent huge pages
+        size_ = round_up(size, HUGEPAGE_SIZE);
+        p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB,
+                 -1, 0);
+        hugepages_ = (p != MAP_FAILED);
+    }
+
+    if (p == MAP_FAILED) {
+        size_ = round_up(size, sysconf(_SC_PAGESIZE));
+        p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p != MAP_FAILED && default_hugepages.load()) {
+            madvise(p, size_, MADV_HUGEPAGE);
+        }
+    }
+
+    if (p == MAP_FAILED) {
+        LOG(WARNING) << "Unable to map " << size
+                     << " bytes for data buckets, using heap memory instead.";
+        size_ = 0;
+        return;
+    }
+
+    base_ = static_cast<char *>(p);
+}
+
+Arena::~Arena() {
+    if (base_ != nullptr) {
+        munmap(base_, size_);
+    }
+}
+
+void *Arena::allocate(std::size_t nbytes) {
+    nbytes = round_up(nbytes, ALIGNMENT);
+    std::size_t offset = used_.load();
+    do {
+        if (base_ == nullptr || offset + nbytes > size_) {
+            return nullptr;
+        }
+    } while (!used_.compare_exchange_weak(offset, offset + nbytes));
+
+    return base_ + offset;
+}
+
+bool Arena::contains(const void *p) const {
+    auto c = static_cast<const char *>(p);
+    return base_ != nullptr && c >= base_ && c < base_ + size_;
+}
+
+std::size_t Arena::size() const { return size_; }
+
+std::size_t Arena::used() const { return used_.load(); }
+
+bool Arena::hugepages() const { return hugepages_; }
+
+void Arena::set_defaults(bool hugepages, bool prefault) {
+    default_hugepages.store(hugepages);
+    default_prefault.store(prefault);
+}
@@ -0,0 +1,113 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// Contiguous region of memory that holds the payload of all data buckets in a
+// ring buffer. The region is mapped in one go, optionally backed by huge pages
+// and pre-faulted, so that processing does not take page faults on first use.
+// Memory is handed out in cache line aligned chunks and released all at once
+// when the arena is destroyed.
+class Arena {
+  public:
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    Arena(std::size_t size);
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    // returns nullptr if the arena is exhausted
+    void *allocate(std::size_t nbytes);
+
+    bool contains(const void *p) const;
+
+    std::size_t size() const;
+    std::size_t used() const;
+    bool hugepages() const;
+
+    // settings for arenas that are created afterwards
+    static void set_defaults(bool hugepages, bool prefault);
+
+  protected:
+    char *base_ = nullptr;
+    std::size_t size_ = 0;
+    std::atomic<std::size_t> used_{0};
+    bool hugepages_ = false;
+};
+
+// Allocator for containers of which the storage lives in an Arena. Without an
+// arena, or when the arena is exhausted, cache line aligned heap memory is
+// used instead. Copies of a container do not inherit the arena.
+template <typename T> class ArenaAllocator {
+  public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator(Arena *arena = nullptr) noexcept : arena_(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+        : arena_(other.arena()) {}
+
+    T *allocate(std::size_t n) {
+        if (arena_ != nullptr) {
+            void *p = arena_->allocate(n * sizeof(T));
+            if (p != nullptr) {
+                return static_cast<T *>(p);
+            }
+        }
+        return static_cast<T *>(::operator new(
+            n * sizeof(T), std::align_val_t(Arena::ALIGNMENT)));
+    }
+
+    void deallocate(T *p, std::size_t) noexcept {
+        if (arena_ != nullptr && arena_->contains(p)) {
+            return; // released together with the arena
+        }
+        ::operator delete(p, std::align_val_t(Arena::ALIGNMENT));
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const {
+        return ArenaAllocator();
+    }
+
+    Arena *arena() const { return arena_; }
+
+  protected:
+    Arena *arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return !(a == b);
+}
@@ -20,8 +20,11 @@
 #pragma once
 
 #include "utilities/string.hpp"
+#include "utilities/timerwheel.hpp"
 #include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <zmq.hpp>
 
@@ -71,10 +74,19 @@ class GlobalContext : public StorageContext {
 
     zmq::context_t &zmq() { return zmq_context_; }
 
+    // timer service shared by all processors, started on first use
+    TimerWheel &timers() {
+        std::call_once(timers_started_,
+                       [this]() { timers_.reset(new TimerWheel()); });
+        return *timers_;
+    }
+
     bool test() const { return default_test_flag_.load(); }
     void set_test(bool value) { default_test_flag_ = value; }
 
   private:
     zmq::context_t zmq_context_;
     std::atomic<bool> default_test_flag_;
+    std::once_flag timers_started_;
+    std::unique_ptr<TimerWheel> timers_;
 };
@@ -60,6 +60,11 @@ void Data::SerializeBinary(std::ostream &stream,
     }
 }
 
+void Data::SerializePacked(std::ostream &stream, Serialization::Format format,
+                           Serialization::PackedStreamState &state) const {
+    SerializeBinary(stream, format);
+}
+
 void Data::SerializeYAML(YAML::Node &node, Serialization::Format format) const {
     // FULL, HEADERONLY : add timestamps
     // otherwise: do nothing
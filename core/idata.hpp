@@ -26,6 +26,7 @@
 #include <memory>
 #include <string>
 
+#include "arena.hpp"
 #include "ringbuffer.hpp"
 
 #include "datatype_generated.h"
@@ -37,7 +38,9 @@
 #include "yaml-cpp/yaml.h"
 
 // Factory for DATATYPE::Data items with support for post-construction
-// initialization
+// initialization. The payload of all items (as far as the data type supports
+// it) is allocated from a single arena that is owned by the factory, so the
+// factory needs to outlive the items.
 template <typename DATATYPE>
 class DataFactory : public IFactory<typename DATATYPE::Data> {
   public:
@@ -46,7 +49,14 @@ class DataFactory : public IFactory<typename DATATYPE::Data> {
 
     typename DATATYPE::Data *NewInstance(const int &size) const final {
         auto items = new typename DATATYPE::Data[size];
+
+        std::size_t nbytes = DATATYPE::Data::ArenaSize(parameters_);
+        if (nbytes > 0 && !arena_) {
+            arena_.reset(new Arena(size * nbytes));
+        }
+
         for (int k = 0; k < size; k++) {
+            items[k].UseArena(arena_.get());
             items[k].Initialize(parameters_);
         }
         return items;
@@ -54,6 +64,7 @@ class DataFactory : public IFactory<typename DATATYPE::Data> {
 
   protected:
     typename DATATYPE::Parameters parameters_;
+    mutable std::unique_ptr<Arena> arena_;
 };
 
 namespace nsAnyType {
@@ -77,6 +88,12 @@ class Data {
 
     void Initialize(const Parameters &parameters) {}
 
+    // Number of bytes of payload that can be allocated from an arena and
+    // the arena to use, called before Initialize. Data types that have a
+    // (large) payload override both.
+    static std::size_t ArenaSize(const Parameters &parameters) { return 0; }
+    void UseArena(Arena *arena) {}
+
     bool eos() const;
     void set_eos(bool value = true);
     void clear_eos();
@@ -108,6 +125,12 @@ class Data {
     virtual void SerializeBinary(std::ostream &stream,
                                  Serialization::Format format) const;
 
+    // packed binary serialization, falls back to SerializeBinary for data
+    // types without a packed representation
+    virtual void SerializePacked(std::ostream &stream,
+                                 Serialization::Format format,
+                                 Serialization::PackedStreamState &state) const;
+
     virtual void SerializeYAML(YAML::Node &node,
                                Serialization::Format format) const;
 
@@ -18,6 +18,7 @@
 // ---------------------------------------------------------------------
 #include <fstream>
 #include <iostream>
+#include <pthread.h>
 #include <regex>
 
 #include "iprocessor.hpp"
@@ -146,18 +147,34 @@ void IProcessor::internal_CreatePorts() {
     CreatePorts();
     // set requested buffer sizes
 
-    if (requested_buffer_sizes_.is_null()) {
-        return;
+    if (!requested_buffer_sizes_.is_null()) {
+        for (auto &it : requested_buffer_sizes_()) {
+            if (!has_output_port(it.first) || it.second < 2) {
+                LOG(WARNING) << "Could not set ringbuffer size to "
+                             << it.second << " for port " << name() << "."
+                             << it.first;
+            } else {
+                output_port(it.first)->set_buffer_size(it.second);
+                LOG(INFO) << "Set ringbuffer size to " << it.second
+                          << " for port " << name() << "." << it.first;
+            }
+        }
     }
 
-    for (auto &it : requested_buffer_sizes_()) {
-        if (!has_output_port(it.first) || it.second < 2) {
-            LOG(WARNING) << "Could not set ringbuffer size to " << it.second
-                         << " for port " << name() << "." << it.first;
-        } else {
-            output_port(it.first)->set_buffer_size(it.second);
-            LOG(INFO) << "Set ringbuffer size to " << it.second << " for port "
-                      << name() << "." << it.first;
+    // set requested wait strategies
+
+    if (!requested_wait_strategies_.is_null()) {
+        for (auto &it : requested_wait_strategies_()) {
+            if (!has_output_port(it.first)) {
+                LOG(WARNING) << "Could not set wait strategy to "
+                             << wait_strategy_to_string(it.second)
+                             << " for port " << name() << "." << it.first;
+            } else {
+                output_port(it.first)->set_wait_strategy(it.second);
+                LOG(INFO) << "Set wait strategy to "
+                          << wait_strategy_to_string(it.second)
+                          << " for port " << name() << "." << it.first;
+            }
         }
     }
 }
@@ -317,6 +334,11 @@ void IProcessor::internal_CreateRingBuffers() {
 void IProcessor::internal_PrepareProcessing() {
     for (auto &it : input_ports_) {
         it.second->PrepareProcessing();
+        if (latency_histograms_()) {
+            for (int k = 0; k < it.second->number_of_slots(); ++k) {
+                it.second->slot(k)->EnableLatencyHistograms();
+            }
+        }
     }
 
     // reset all output slot cursors to 0
@@ -328,6 +350,11 @@ void IProcessor::internal_PrepareProcessing() {
 void IProcessor::internal_ThreadEntry(RunContext &runcontext) {
     LOG(DEBUG) << "Entering thread for processor " << name_;
 
+    // name the thread after the processor (truncated to the 15 characters
+    // allowed by the kernel), so that it can be identified in the fast
+    // logging statistics and in system tools
+    pthread_setname_np(pthread_self(), name_.substr(0, 15).c_str());
+
     // ProcessingContext context( runcontext, name_, has_test_flag_.load() ?
     // test_flag_.load() : runcontext.test() );
     ProcessingContext context(runcontext, name_,
@@ -423,6 +450,54 @@ void IProcessor::internal_Alert() {
     }
 }
 
+void IProcessor::internal_LogWaitStatistics() const {
+    for (auto &it : output_ports_) {
+        for (int k = 0; k < it.second->number_of_slots(); ++k) {
+            auto stats = it.second->slot(k)->wait_statistics();
+            if (stats.waits == 0) {
+                continue;
+            }
+            LOG(INFO) << "Downstream of " << name() << "." << it.first << "."
+                      << k << ": waited " << stats.waits << " times, yielded "
+                      << stats.yields << " times and parked " << stats.parks
+                      << " times ("
+                      << (100. * stats.parks) / stats.waits << "%).";
+        }
+    }
+}
+
+YAML::Node IProcessor::internal_LatencyHistograms() const {
+    YAML::Node node(YAML::NodeType::Map);
+    for (auto &it : input_ports_) {
+        for (int k = 0; k < it.second->number_of_slots(); ++k) {
+            auto slot = it.second->slot(k);
+            if (!slot->latency_histograms_enabled()) {
+                continue;
+            }
+            std::string key = it.first + "." + std::to_string(k);
+            node[key]["latency"] = slot->retrieve_latency()->ExportYAML();
+            node[key]["processing"] = slot->processing_time()->ExportYAML();
+        }
+    }
+    return node;
+}
+
+void IProcessor::internal_LogLatencyHistograms() const {
+    for (auto &it : input_ports_) {
+        for (int k = 0; k < it.second->number_of_slots(); ++k) {
+            auto slot = it.second->slot(k);
+            if (!slot->latency_histograms_enabled()) {
+                continue;
+            }
+            LOG(INFO) << name() << "." << it.first << "." << k
+                      << " latency: " << slot->retrieve_latency()->summary();
+            LOG(INFO) << name() << "." << it.first << "." << k
+                      << " processing time: "
+                      << slot->processing_time()->summary();
+        }
+    }
+}
+
 YAML::Node IProcessor::internal_ApplyMethod(std::string name,
                                             const YAML::Node &node) {
     return exposed_method(name)(node);
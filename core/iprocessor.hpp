@@ -66,6 +66,8 @@ class IProcessor {
         add_advanced_option("threadcore", thread_core_);
         add_advanced_option("threadpriority", thread_priority_ = priority);
         add_advanced_option("buffer_sizes", requested_buffer_sizes_);
+        add_advanced_option("wait_strategies", requested_wait_strategies_);
+        add_advanced_option("latency_histograms", latency_histograms_);
     }
 
     virtual ~IProcessor() { internal_Stop(); }
@@ -628,6 +630,9 @@ class IProcessor {
     void internal_Stop();
 
     void internal_Alert();
+    void internal_LogWaitStatistics() const;
+    YAML::Node internal_LatencyHistograms() const;
+    void internal_LogLatencyHistograms() const;
 
     YAML::Node internal_ApplyMethod(std::string name, const YAML::Node &node);
 
@@ -672,6 +677,9 @@ class IProcessor {
 
     options::NullableBool new_test_flag_;
     options::Value<std::map<std::string, int>> requested_buffer_sizes_{};
+    options::Value<std::map<std::string, WaitStrategy>>
+        requested_wait_strategies_{};
+    options::Bool latency_histograms_{false};
 
   protected:
     options::OptionList options_;
@@ -42,6 +42,13 @@ std::vector<RingSequence *> ISlotOut::gating_sequences() {
 
 void ISlotIn::ReleaseData() {
     if (nretrieved_ > 0) {
+        if (processing_time_ != nullptr) {
+            processing_time_->Record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - retrieve_time_)
+                    .count());
+        }
+
         int64_t value = sequence_.IncrementAndGet(nretrieved_);
         nretrieved_ = 0;
 
@@ -51,6 +58,28 @@ void ISlotIn::ReleaseData() {
     }
 }
 
+void ISlotIn::EnableLatencyHistograms() {
+    if (retrieve_latency_ == nullptr) {
+        retrieve_latency_ = std::make_unique<LatencyHistogram>();
+        processing_time_ = std::make_unique<LatencyHistogram>();
+    } else {
+        retrieve_latency_->Reset();
+        processing_time_->Reset();
+    }
+}
+
+void ISlotIn::RecordRetrieveLatency(const typename AnyType::Data *data,
+                                    TimePoint now) {
+    // skip data without source time stamp
+    if (data->source_timestamp().time_since_epoch().count() == 0) {
+        return;
+    }
+    retrieve_latency_->Record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now - data->source_timestamp())
+            .count());
+}
+
 void ISlotIn::Connect(ISlotOut *upstream) {
     if (connected()) {
         throw std::runtime_error(
@@ -77,15 +106,7 @@ YAML::Node IPortOut::ExportYAML() const {
     node["nslots_min"] = policy().min_slot_number();
     node["nslots_max"] = policy().max_slot_number();
     node["buffer_size"] = policy().buffer_size();
-    if (policy().wait_strategy() == WaitStrategy::kBlockingStrategy) {
-        node["wait_strategy"] = "blocking";
-    } else if (policy().wait_strategy() == WaitStrategy::kSleepingStrategy) {
-        node["wait_strategy"] = "sleeping";
-    } else if (policy().wait_strategy() == WaitStrategy::kYieldingStrategy) {
-        node["wait_strategy"] = "yielding";
-    } else {
-        node["wait_strategy"] = "busy spin";
-    }
+    node["wait_strategy"] = wait_strategy_to_string(policy().wait_strategy());
     return node;
 }
 
@@ -26,6 +26,7 @@
 
 #include "connections.hpp"
 #include "idata.hpp"
+#include "latencyhistogram.hpp"
 #include "portpolicy.hpp"
 #include "streaminfo.hpp"
 
@@ -54,6 +55,9 @@ class ISlotOut {
     bool connected() const { return downstream_slots_.size() > 0; }
     int nconnected() const { return downstream_slots_.size(); }
     virtual IStreamInfo &streaminfo() = 0;
+    virtual uint64_t nitems_produced() const = 0;
+    // how often downstream slots had to wait for data on this slot
+    virtual WaitStatistics wait_statistics() const = 0;
     int buffer_size() const { return buffer_size_; }
 
   protected:
@@ -118,6 +122,9 @@ class IPortOut {
     virtual void NewSlot(int n = 1) = 0;
 
     void set_buffer_size(int sz) { policy_.set_buffer_size(sz); }
+    void set_wait_strategy(WaitStrategy wait) {
+        policy_.set_wait_strategy(wait);
+    }
 
     IProcessor *parent_; // observing pointer
     PortAddress address_;
@@ -165,6 +172,21 @@ class ISlotIn {
 
     virtual void Validate() = 0;
 
+    // Optional histograms of the time between the creation of data at the
+    // source and its retrieval on this slot, and of the time between
+    // retrieval and release of the data. Histograms are created once and
+    // reset at every call, so they can be read while processing.
+    void EnableLatencyHistograms();
+    bool latency_histograms_enabled() const {
+        return retrieve_latency_ != nullptr;
+    }
+    const LatencyHistogram *retrieve_latency() const {
+        return retrieve_latency_.get();
+    }
+    const LatencyHistogram *processing_time() const {
+        return processing_time_.get();
+    }
+
   protected:
     // called by upstream ISlotOut
     RingSequence *sequence() { return &sequence_; }
@@ -173,6 +195,10 @@ class ISlotIn {
     void Connect(ISlotOut *upstream);
     void PrepareProcessing();
 
+    // called by SlotIn after retrieval of new data
+    void RecordRetrieveLatency(const typename AnyType::Data *data,
+                               TimePoint now);
+
   protected:
     int64_t time_out_;
     bool cache_enabled_;
@@ -185,6 +211,10 @@ class ISlotIn {
     ISlotOut *upstream_ = nullptr;
 
     RingSequence sequence_; // the input slot's read cursor into the buffer
+
+    std::unique_ptr<LatencyHistogram> retrieve_latency_;
+    std::unique_ptr<LatencyHistogram> processing_time_;
+    TimePoint retrieve_time_;
     IPortIn *parent_;       // observing pointer
     SlotAddress address_;
 };
@@ -0,0 +1,127 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include "latencyhistogram.hpp"
+
+std::size_t LatencyHistogram::bucket_index(int64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return value;
+    }
+    // position of most significant bit determines the bucket, the next
+    // SUB_BUCKET_BITS - 1 bits the sub-bucket
+    int shift = (63 - __builtin_clzll(value)) - (SUB_BUCKET_BITS - 1);
+    return SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF +
+           ((value >> shift) - SUB_BUCKET_HALF);
+}
+
+int64_t LatencyHistogram::bucket_upper_value(std::size_t index) {
+    if (index < (std::size_t)SUB_BUCKET_COUNT) {
+        return index;
+    }
+    int shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF + 1;
+    int64_t sub = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(int64_t nanoseconds) {
+    if (nanoseconds < 0) {
+        nanoseconds = 0;
+    } else if (nanoseconds > MAX_VALUE) {
+        nanoseconds = MAX_VALUE;
+    }
+
+    increment(buckets_[bucket_index(nanoseconds)]);
+    increment(count_);
+    increment(sum_, nanoseconds);
+
+    if (nanoseconds < min_.load(std::memory_order_relaxed)) {
+        min_.store(nanoseconds, std::memory_order_relaxed);
+    }
+    if (nanoseconds > max_.load(std::memory_order_relaxed)) {
+        max_.store(nanoseconds, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::Reset() {
+    for (auto &it : buckets_) {
+        it.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(MAX_VALUE, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::min() const {
+    return count() == 0 ? 0 : min_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    return n == 0 ? 0. : double(sum_.load(std::memory_order_relaxed)) / n;
+}
+
+int64_t LatencyHistogram::percentile(double percentage) const {
+    uint64_t n = count();
+    if (n == 0) {
+        return 0;
+    }
+
+    uint64_t target = std::ceil(percentage / 100. * n);
+    if (target < 1) {
+        target = 1;
+    }
+
+    uint64_t cumulative = 0;
+    for (std::size_t k = 0; k < NBUCKETS; ++k) {
+        cumulative += buckets_[k].load(std::memory_order_relaxed);
+        if (cumulative >= target) {
+            return std::min(bucket_upper_value(k), max());
+        }
+    }
+    return max();
+}
+
+YAML::Node LatencyHistogram::ExportYAML() const {
+    YAML::Node node;
+    node["count"] = count();
+    node["mean"] = mean() / 1000.;
+    node["min"] = min() / 1000.;
+    node["p50"] = percentile(50.) / 1000.;
+    node["p90"] = percentile(90.) / 1000.;
+    node["p99"] = percentile(99.) / 1000.;
+    node["p99.9"] = percentile(99.9) / 1000.;
+    node["max"] = max() / 1000.;
+    return node;
+}
+
+std::string LatencyHistogram::summary() const {
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(1) << "n = " << count()
+      << ", mean = " << mean() / 1000. << " us, p50 = "
+      << percentile(50.) / 1000. << " us, p99 = " << percentile(99.) / 1000.
+      << " us, p99.9 = " << percentile(99.9) / 1000.
+      << " us, max = " << max() / 1000. << " us";
+    return s.str();
+}
@@ -0,0 +1,83 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "yaml-cpp/yaml.h"
+
+// Histogram of durations in nanoseconds with logarithmically spaced buckets
+// that are each subdivided linearly (as in HDR histograms). Values below 128
+// ns are recorded exactly and larger values with a relative error of at most
+// 1/64, up to about 73 minutes. Recording is wait-free and allocation-free, and
+// intended for a single recording thread. Other threads may read the
+// histogram at any time, at the cost of a slightly inconsistent snapshot.
+class LatencyHistogram {
+  public:
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr int MAX_VALUE_BITS = 42;
+    static constexpr int64_t SUB_BUCKET_COUNT = int64_t(1) << SUB_BUCKET_BITS;
+    static constexpr int64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+    static constexpr int64_t MAX_VALUE = (int64_t(1) << MAX_VALUE_BITS) - 1;
+    static constexpr std::size_t NBUCKETS =
+        SUB_BUCKET_COUNT +
+        (MAX_VALUE_BITS - SUB_BUCKET_BITS) * SUB_BUCKET_HALF;
+
+    LatencyHistogram() { Reset(); }
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    // negative values are recorded as zero, too large values as MAX_VALUE
+    void Record(int64_t nanoseconds);
+    void Reset();
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    int64_t min() const;
+    int64_t max() const { return max_.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    // smallest recorded value (up to bucket resolution) that is larger than
+    // or equal to the given percentage of all values
+    int64_t percentile(double percentage) const;
+
+    // summary statistics in microseconds
+    YAML::Node ExportYAML() const;
+    std::string summary() const;
+
+    static std::size_t bucket_index(int64_t value);
+    static int64_t bucket_upper_value(std::size_t index);
+
+  protected:
+    void increment(std::atomic<uint64_t> &counter, uint64_t n = 1) {
+        // single writer, so no need for a locked read-modify-write
+        counter.store(counter.load(std::memory_order_relaxed) + n,
+                      std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, NBUCKETS> buckets_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<int64_t> min_;
+    std::atomic<int64_t> max_;
+};
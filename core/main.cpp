@@ -24,6 +24,7 @@
 #include <regex>
 #include <string>
 
+#include "arena.hpp"
 #include "buildconstant.hpp"
 #include "cmdline/cmdline.h"
 #include "commandhandler.hpp"
@@ -124,6 +125,9 @@ int main(int argc, char **argv) {
     GlobalContext context(config.testing_enabled(),
                           config.server_side_storage_custom());
 
+    // memory for data buckets of ring buffers
+    Arena::set_defaults(config.memory_hugepages(), config.memory_prefault());
+
     // set up loggers
     // file logger
     char *home = getenv("HOME");
@@ -164,6 +168,9 @@ int main(int argc, char **argv) {
                   << config.logging_cloud_port();
     }
 
+    // asynchronous logging from the processing threads
+    fastlog::Start(config.logging_fast_capacity());
+
     LOG(INFO) << "Logging initialized. Log file saved to " << logpath;
 
     // Check clock used for internal timing
@@ -229,6 +236,7 @@ int main(int argc, char **argv) {
     commandhandler.start();
 
     LOG(INFO) << "Falcon shutting down normally.";
+    fastlog::Stop();
     g3::internal::shutDownLogging();
     return EXIT_SUCCESS;
 }
@@ -19,9 +19,64 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <string>
+
 #include "ringbuffer.hpp"
 #include "utilities/math_numeric.hpp"
 
+#include "yaml-cpp/yaml.h"
+
+inline std::string wait_strategy_to_string(WaitStrategy x) {
+    std::string s;
+#define MATCH(p, name)                                                         \
+    case (WaitStrategy::p):                                                    \
+        s = name;                                                              \
+        break;
+    switch (x) {
+        MATCH(kBlockingStrategy, "blocking");
+        MATCH(kSleepingStrategy, "sleeping");
+        MATCH(kYieldingStrategy, "yielding");
+        MATCH(kBusySpinStrategy, "busy spin");
+        MATCH(kHybridStrategy, "hybrid");
+    }
+#undef MATCH
+    return s;
+}
+
+inline WaitStrategy string_to_wait_strategy(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), (int (*)(int))std::tolower);
+#define MATCH(p, name)                                                         \
+    if (s == name) {                                                           \
+        return WaitStrategy::p;                                                \
+    }
+    MATCH(kBlockingStrategy, "blocking");
+    MATCH(kSleepingStrategy, "sleeping");
+    MATCH(kYieldingStrategy, "yielding");
+    MATCH(kBusySpinStrategy, "busy spin");
+    MATCH(kBusySpinStrategy, "busyspin");
+    MATCH(kHybridStrategy, "hybrid");
+    throw std::runtime_error("Invalid wait strategy value: " + s + ".");
+#undef MATCH
+}
+
+namespace YAML {
+template <> struct convert<WaitStrategy> {
+    static Node encode(const WaitStrategy &rhs) {
+        Node node;
+        node = wait_strategy_to_string(rhs);
+        return node;
+    }
+
+    static bool decode(const Node &node, WaitStrategy &rhs) {
+        rhs = string_to_wait_strategy(node.as<std::string>());
+        return true;
+    }
+};
+} // namespace YAML
+
 typedef uint16_t SlotType;
 typedef Range<SlotType> SlotRange;
 
@@ -67,6 +122,7 @@ class PortOutPolicy : public PortPolicy {
     WaitStrategy wait_strategy() const { return wait_strategy_; }
 
     void set_buffer_size(int sz) { buffer_size_ = sz; }
+    void set_wait_strategy(WaitStrategy wait) { wait_strategy_ = wait; }
 
   protected:
     int buffer_size_;            // output slot only
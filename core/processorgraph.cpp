@@ -590,6 +590,11 @@ void ProcessorGraph::StopProcessing() {
         }
 
         LOG(INFO) << "Stopped all processors.";
+
+        for (auto &it : this->processors_) {
+            it.second.second->internal_LogWaitStatistics();
+            it.second.second->internal_LogLatencyHistograms();
+        }
         LOG(INFO) << "Graph was processing for "
                   << std::to_string(run_context_->seconds()) << " seconds";
 
@@ -643,7 +648,7 @@ void ProcessorGraph::Update(YAML::Node &node) {
                     // check if externally settable??
                     if (pstate->external_permission() == Permission::WRITE) {
                         // set from string
-                        it2->second = pstate->set_string(state_value);
+                        it2->second = pstate->set_string(state_value, false);
                     } else {
                         throw std::runtime_error(
                             "Shared state " + state_name + " on processor " +
@@ -674,6 +679,7 @@ void ProcessorGraph::Retrieve(YAML::Node &node) {
     // YAML
     // processor:
     //    state: <null>
+    //    latency_histograms: <null>
 
     // make sure node is a map
     if (!node.IsMap()) {
@@ -698,11 +704,15 @@ void ProcessorGraph::Retrieve(YAML::Node &node) {
                  it2 != it->second.end(); ++it2) {
                 try {
                     auto state_name = it2->first.as<std::string>();
+                    if (state_name == LATENCY_HISTOGRAMS_KEY) {
+                        it2->second = processor->internal_LatencyHistograms();
+                        continue;
+                    }
                     // it2->second = processor->internal_RetrieveState(
                     // state_name );
                     auto pstate = processor->shared_state(state_name);
                     if (pstate->external_permission() != Permission::NONE) {
-                        it2->second = pstate->get_string();
+                        it2->second = pstate->get_string(false);
                     } else {
                         throw std::runtime_error(
                             "Shared state " + state_name + " on processor " +
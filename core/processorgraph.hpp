@@ -48,6 +48,10 @@ YAML::Node LoadProcessorDoc(std::string processor);
 
 namespace graph {
 
+// reserved name in a retrieve request for the latency histograms of the input
+// slots of a processor (instead of a shared state)
+const std::string LATENCY_HISTOGRAMS_KEY = "latency_histograms";
+
 enum class GraphState {
     NOGRAPH,
     CONSTRUCTING,
@@ -36,6 +36,7 @@ typedef disruptor::Sequence RingSequence;
 
 typedef disruptor::ClaimStrategyOption ClaimStrategy;
 typedef disruptor::WaitStrategyOption WaitStrategy;
+typedef disruptor::WaitStatistics WaitStatistics;
 typedef disruptor::AlertException RingAlertException;
 
 typedef disruptor::BatchDescriptor RingBatch;
@@ -66,6 +66,7 @@ std::string encoding_to_string(Encoding enc) {
         MATCH(BINARY)
         MATCH(YAML)
         MATCH(FLATBUFFER);
+        MATCH(PACKED);
     }
 #undef MATCH
     return s;
@@ -80,6 +81,7 @@ Encoding string_to_encoding(std::string s) {
     MATCH(BINARY)
     MATCH(YAML)
     MATCH(FLATBUFFER);
+    MATCH(PACKED);
     throw std::runtime_error("Invalid Serialization::Encoding value.");
 #undef MATCH
 }
@@ -18,9 +18,11 @@
 // ---------------------------------------------------------------------
 
 #pragma once
+#include "utilities/samplecodec.hpp"
 #include "yaml-cpp/yaml.h"
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace Serialization {
 
@@ -36,11 +38,20 @@ enum class Format { NONE = -1, FULL, COMPACT, HEADERONLY, STREAMHEADER };
 std::string format_to_string(Format fmt);
 Format string_to_format(std::string s);
 
-enum class Encoding { BINARY = 0, YAML, FLATBUFFER };
+enum class Encoding { BINARY = 0, YAML, FLATBUFFER, PACKED };
+// PACKED: as BINARY, but sample data is delta encoded and bit packed where
+// the data type supports it (see utilities/samplecodec.hpp)
 
 std::string encoding_to_string(Encoding fmt);
 Encoding string_to_encoding(std::string s);
 
+// State of the PACKED encoding for a single stream. Blocks are delta encoded
+// relative to the previous block of the same stream.
+struct PackedStreamState {
+    SampleBlockEncoder encoder;
+    std::vector<uint8_t> buffer;
+};
+
 } // namespace Serialization
 
 namespace YAML {
@@ -96,6 +96,60 @@ bool Serialization::FlatBufferSerializer::Serialize(
     return true;
 }
 
+bool Serialization::PackedSerializer::Serialize(
+    std::ostream &stream, typename AnyType::Data *data, uint16_t streamid,
+    uint64_t packetid, std::string processor, std::string port, uint8_t slot) {
+    if (format_ == Serialization::Format::NONE) {
+        return true;
+    }
+
+    auto it = states_.find(streamid);
+    if (it == states_.end()) {
+        it = states_.emplace(streamid, PackedStreamState()).first;
+        it->second.encoder.set_step(step_);
+    }
+
+    if (format_ != Serialization::Format::COMPACT) {
+        stream.write(reinterpret_cast<const char *>(&streamid),
+                     sizeof(streamid));
+        stream.write(reinterpret_cast<const char *>(&packetid),
+                     sizeof(packetid));
+    }
+    data->SerializePacked(stream, format_, it->second);
+
+    return true;
+}
+
+void Serialization::PackedSerializer::Restart(uint16_t streamid) {
+    auto it = states_.find(streamid);
+    if (it != states_.end()) {
+        it->second.encoder.Reset();
+    }
+}
+
+void Serialization::PackedSerializer::set_step(double step) {
+    step_ = step;
+    for (auto &it : states_) {
+        it.second.encoder.set_step(step);
+    }
+}
+
+uint64_t Serialization::PackedSerializer::npacked() const {
+    uint64_t n = 0;
+    for (auto &it : states_) {
+        n += it.second.encoder.npacked();
+    }
+    return n;
+}
+
+uint64_t Serialization::PackedSerializer::nraw() const {
+    uint64_t n = 0;
+    for (auto &it : states_) {
+        n += it.second.encoder.nraw();
+    }
+    return n;
+}
+
 bool Serialization::YAMLSerializer::Serialize(
     std::ostream &stream, typename AnyType::Data *data, uint16_t streamid,
     uint64_t packetid, std::string processor, std::string port, uint8_t slot) {
@@ -141,6 +195,9 @@ Serializer *serializer(Serialization::Encoding enc, Serialization::Format fmt) {
     if (enc == Serialization::Encoding::FLATBUFFER) {
         return new Serialization::FlatBufferSerializer(fmt);
     }
+    if (enc == Serialization::Encoding::PACKED) {
+        return new Serialization::PackedSerializer(fmt);
+    }
     throw std::runtime_error("Unknown serializer.");
 }
 } // namespace Serialization
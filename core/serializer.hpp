@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <map>
 #include <ostream>
 #include <string>
 
@@ -42,6 +43,10 @@ class Serializer {
                            uint16_t streamid, uint64_t packetid,
                            std::string processor, std::string port,
                            uint8_t slot) = 0;
+
+    // start a part of the stream that can be decoded independently of what
+    // was serialized before (only relevant for stateful encodings)
+    virtual void Restart(uint16_t streamid) {}
     Format format() const;
     void set_format(Format fmt);
 
@@ -80,6 +85,30 @@ class FlatBufferSerializer : public Serializer {
     flexbuffers::Builder flex_builder_;
 };
 
+class PackedSerializer : public Serializer {
+  public:
+    PackedSerializer(Format fmt = Format::FULL, double step = 1.0)
+        : Serializer(fmt, "Packed binary format", "bin"), step_(step) {}
+
+    bool Serialize(std::ostream &stream, typename AnyType::Data *data,
+                   uint16_t streamid, uint64_t packetid, std::string processor,
+                   std::string port, uint8_t slot);
+
+    void Restart(uint16_t streamid) override;
+
+    // quantization step of floating point samples
+    double step() const { return step_; }
+    void set_step(double step);
+
+    // number of sample blocks that were packed or stored raw
+    uint64_t npacked() const;
+    uint64_t nraw() const;
+
+  private:
+    double step_;
+    std::map<uint16_t, PackedStreamState> states_;
+};
+
 class YAMLSerializer : public Serializer {
   public:
     YAMLSerializer(Format fmt = Format::FULL)
@@ -20,13 +20,17 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <set>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <typeinfo>
 #include <vector>
 
@@ -182,6 +186,97 @@ class IState {
     std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
 };
 
+// Storage for the value of a state. Reads never take a lock, since states are
+// read for every bucket (or sample) of data in the processing loop. Values
+// that fit in a lock-free atomic are read with a single acquire load. Wider
+// values are protected by a sequence lock: writers are serialized by a spin
+// lock and bump a sequence number before and after the update, and readers
+// retry if the sequence number was odd or changed while they copied the value.
+template <typename T, bool LOCKFREE = std::atomic<T>::is_always_lock_free>
+class StateValue;
+
+template <typename T> class StateValue<T, true> {
+  public:
+    explicit StateValue(T value) : value_(value) {}
+
+    T load() const { return value_.load(std::memory_order_acquire); }
+    void store(T value) { value_.store(value, std::memory_order_release); }
+    T exchange(T value) {
+        return value_.exchange(value, std::memory_order_acq_rel);
+    }
+
+  protected:
+    std::atomic<T> value_;
+};
+
+template <typename T> class StateValue<T, false> {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "State values need to be trivially copyable.");
+
+  public:
+    explicit StateValue(T value) { write(value); }
+
+    T load() const {
+        std::array<uint64_t, NWORDS> words;
+        uint64_t before, after;
+        do {
+            while ((before = sequence_.load(std::memory_order_acquire)) & 1) {
+            }
+            for (std::size_t k = 0; k < NWORDS; ++k) {
+                words[k] = words_[k].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence_.load(std::memory_order_relaxed);
+        } while (before != after);
+
+        T value;
+        std::memcpy(&value, words.data(), sizeof(T));
+        return value;
+    }
+
+    void store(T value) {
+        lock();
+        write(value);
+        unlock();
+    }
+
+    T exchange(T value) {
+        lock();
+        T old = load();
+        write(value);
+        unlock();
+        return old;
+    }
+
+  protected:
+    static constexpr std::size_t NWORDS = (sizeof(T) + 7) / 8;
+
+    void lock() {
+        while (writer_.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+
+    void unlock() { writer_.clear(std::memory_order_release); }
+
+    // callers hold the writer lock (or have exclusive access)
+    void write(const T &value) {
+        std::array<uint64_t, NWORDS> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t k = 0; k < NWORDS; ++k) {
+            words_[k].store(words[k], std::memory_order_relaxed);
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    std::atomic<uint64_t> sequence_{0};
+    std::array<std::atomic<uint64_t>, NWORDS> words_;
+    std::atomic_flag writer_ = ATOMIC_FLAG_INIT;
+};
+
 template <typename Base, typename Derived> class StateCloneable : public Base {
   public:
     using Base::Base;
@@ -200,39 +295,33 @@ class ReadableState : public StateCloneable<IState, ReadableState<T>> {
         : StateCloneable<IState, ReadableState<T>>(
               Permissions(Permission::READ, peers, external), description),
           default_(default_value), cache_(default_value),
-          state_(std::make_shared<std::atomic<T>>(default_value)) {}
+          state_(std::make_shared<StateValue<T>>(default_value)) {}
 
     ReadableState(const ReadableState &other)
         : StateCloneable<IState, ReadableState<T>>(other.permissions_,
                                                    other.description_),
           default_(other.default_), cache_(other.cache_),
-          state_(std::make_shared<std::atomic<T>>(other.state_->load())) {
+          state_(std::make_shared<StateValue<T>>(other.state_->load())) {
         // note that we are creating our own (unshared) state
         // and that we do not share other's state
     }
 
+    // The value is read without locking. The cache is private to the
+    // processor that owns the state, external access should not use it.
     T get(bool cache = true) {
-        T val;
-        this->lock();
-        val = state_->load();
+        T val = state_->load();
         if (cache) {
             cache_ = val;
         }
-        this->unlock();
-
         return val;
     }
 
     bool changed_get(T &val, bool cache = true) {
-        bool ret;
-        this->lock();
         val = state_->load();
-        ret = cache_ == val;
+        bool ret = cache_ == val;
         if (cache) {
             cache_ = val;
         }
-        this->unlock();
-
         return ret;
     }
 
@@ -246,22 +335,17 @@ class ReadableState : public StateCloneable<IState, ReadableState<T>> {
 
   protected: // for friends only
     void set(T value, bool cache = true) {
-        this->lock();
         state_->store(value);
         if (cache) {
             cache_ = value;
         }
-        this->unlock();
     }
 
     T exchange(T value, bool cache = true) {
-        this->lock();
         value = state_->exchange(value);
         if (cache) {
             cache_ = value;
         }
-        this->unlock();
-
         return value;
     }
 
@@ -300,7 +384,7 @@ class ReadableState : public StateCloneable<IState, ReadableState<T>> {
 
     void UnShare() override {
         this->lock();
-        this->state_ = std::make_shared<std::atomic<T>>(this->state_->load());
+        this->state_ = std::make_shared<StateValue<T>>(this->state_->load());
         this->external_permission_->subtract(this->permissions_.external());
         this->external_permission_ =
             std::make_shared<ExternalPermissionTracker>(
@@ -325,8 +409,10 @@ class ReadableState : public StateCloneable<IState, ReadableState<T>> {
   private:
     T default_;
     T cache_;
-    std::shared_ptr<std::atomic<T>>
-        state_; // our own state, that may be shared with others
+    // our own state, that may be shared with others. The pointer itself is
+    // only replaced by Share/UnShare, which happen while building and
+    // destroying the graph, when processors are not running.
+    std::shared_ptr<StateValue<T>> state_;
 };
 
 template <typename T> class WritableState : public ReadableState<T> {
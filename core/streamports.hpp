@@ -51,11 +51,19 @@ template <typename DATATYPE> class SlotOut : public ISlotOut {
 
     // public interface
     typename DATATYPE::Data *ClaimData(bool clear);
+    // as ClaimData, but returns nullptr instead of waiting if all items of
+    // the ring buffer are still in use downstream
+    typename DATATYPE::Data *TryClaimData(bool clear);
     std::vector<typename DATATYPE::Data *> ClaimDataN(uint64_t n, bool clear);
     void PublishData();
+    // publish only the first n items of the claimed batch and hand the
+    // remaining items back to the ring buffer, for producers that do not
+    // know up front how many items they will fill
+    void PublishData(uint64_t n);
 
     virtual StreamInfo<DATATYPE> &streaminfo() { return streaminfo_; }
-    uint64_t nitems_produced() const;
+    uint64_t nitems_produced() const override;
+    WaitStatistics wait_statistics() const override;
 
   protected:
     // called by SlotIn<DATATYPE>
@@ -77,6 +85,7 @@ template <typename DATATYPE> class SlotOut : public ISlotOut {
 
         ringbuffer_->ForcePublish(-1L);
         ringbuffer_->Claim(-1L);
+        ringbuffer_->ResetWaitStatistics();
     }
 
   public:
@@ -181,6 +190,8 @@ template <typename DATATYPE> class SlotIn : public ISlotIn {
   protected:
     void Unlock();
     void check_high_water_level();
+    void record_retrieve_latency(typename DATATYPE::Data *const *data,
+                                 std::size_t n);
 
     RingBufferStatus status_;
 
@@ -26,6 +26,15 @@ inline uint64_t SlotOut<DATATYPE>::nitems_produced() const {
   return ringbuffer_serial_number_;
 }
 
+template <typename DATATYPE>
+WaitStatistics SlotOut<DATATYPE>::wait_statistics() const {
+
+  if (ringbuffer_ == nullptr) {
+    return WaitStatistics();
+  }
+  return ringbuffer_->wait_statistics();
+}
+
 template <typename DATATYPE>
 inline typename DATATYPE::Data *SlotOut<DATATYPE>::ClaimData(bool clear) {
 
@@ -39,6 +48,16 @@ inline typename DATATYPE::Data *SlotOut<DATATYPE>::ClaimData(bool clear) {
   return data;
 }
 
+template <typename DATATYPE>
+inline typename DATATYPE::Data *SlotOut<DATATYPE>::TryClaimData(bool clear) {
+
+  // exact for the single producer, downstream slots can only free items
+  if (!ringbuffer_->HasAvalaibleCapacity()) {
+    return nullptr;
+  }
+  return ClaimData(clear);
+}
+
 template <typename DATATYPE>
 inline std::vector<typename DATATYPE::Data *>
 SlotOut<DATATYPE>::ClaimDataN(uint64_t n, bool clear) {
@@ -75,12 +94,38 @@ template <typename DATATYPE> inline void SlotOut<DATATYPE>::PublishData() {
   }
 }
 
+template <typename DATATYPE>
+inline void SlotOut<DATATYPE>::PublishData(uint64_t n) {
+
+  if (!has_publishable_data_ || ringbuffer_->GetCursor() == INT64_MAX) {
+    return;
+  }
+
+  uint64_t nclaimed = ring_batch_.size();
+  if (n < nclaimed) {
+    // move the claim back to the last item that will be published, the
+    // returned items were never visible to the downstream slots
+    uint64_t nreturned = nclaimed - n;
+    ring_batch_.set_end(ring_batch_.end() - nreturned);
+    ring_batch_.set_size(n);
+    ringbuffer_->Claim(ring_batch_.end());
+    ringbuffer_serial_number_ -= nreturned;
+  }
+
+  if (n > 0) {
+    ringbuffer_->Publish(ring_batch_);
+  }
+  has_publishable_data_ = false;
+}
+
 template <typename DATATYPE>
 void SlotOut<DATATYPE>::CreateRingBuffer(int buffer_size,
                                          WaitStrategy wait_strategy) {
 
   // make sure buffer size is power of 2 and at least 2
   buffer_size_ = buffer_size < 2 ? 2 : next_pow2(buffer_size);
+  // items of an existing ring buffer may use the arena of the old factory
+  auto previous_datafactory = std::move(datafactory_);
   datafactory_.reset(new DataFactory<DATATYPE>(streaminfo_.parameters()));
   try {
     ringbuffer_.reset(new RingBuffer<typename DATATYPE::Data>(
@@ -192,6 +237,19 @@ template <typename DATATYPE> void SlotIn<DATATYPE>::check_high_water_level() {
   }
 }
 
+template <typename DATATYPE>
+inline void
+SlotIn<DATATYPE>::record_retrieve_latency(typename DATATYPE::Data *const *data,
+                                          std::size_t n) {
+  if (!latency_histograms_enabled()) {
+    return;
+  }
+  retrieve_time_ = Clock::now();
+  for (std::size_t k = 0; k < n; ++k) {
+    RecordRetrieveLatency(data[k], retrieve_time_);
+  }
+}
+
 template <typename DATATYPE>
 bool SlotIn<DATATYPE>::RetrieveData(typename DATATYPE::Data *&data) {
 
@@ -220,6 +278,7 @@ bool SlotIn<DATATYPE>::RetrieveData(typename DATATYPE::Data *&data) {
         ++nretrieved_;
         status_.read = 1;
         status_.backlog = available_sequence - requested_sequence;
+        record_retrieve_latency(&data, 1);
       }
     } else {
       int64_t available_sequence =
@@ -239,6 +298,7 @@ bool SlotIn<DATATYPE>::RetrieveData(typename DATATYPE::Data *&data) {
         ++nretrieved_;
         status_.read = 1;
         status_.backlog = available_sequence - requested_sequence;
+        record_retrieve_latency(&data, 1);
 
         if (cache_enabled_) {
           if (ncached_ == 0) {
@@ -293,6 +353,7 @@ bool SlotIn<DATATYPE>::RetrieveDataN(
           ++nretrieved_;
           ++status_.read;
         }
+        record_retrieve_latency(data.data(), data.size());
         status_.backlog = available_sequence - requested_sequence;
       }
     } else {
@@ -314,6 +375,7 @@ bool SlotIn<DATATYPE>::RetrieveDataN(
           ++nretrieved_;
           ++status_.read;
         }
+        record_retrieve_latency(data.data(), data.size());
 
         status_.backlog = available_sequence - requested_sequence;
 
@@ -368,6 +430,7 @@ bool SlotIn<DATATYPE>::RetrieveDataAll(
           ++nretrieved_;
           ++status_.read;
         }
+        record_retrieve_latency(data.data(), data.size());
       }
     } else {
       int64_t available_sequence =
@@ -387,6 +450,7 @@ bool SlotIn<DATATYPE>::RetrieveDataAll(
           ++nretrieved_;
           ++status_.read;
         }
+        record_retrieve_latency(data.data(), data.size());
 
         if (cache_enabled_) {
           if (ncached_ == 0) {
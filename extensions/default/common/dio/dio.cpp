@@ -55,7 +55,8 @@ void DigitalState::set_state(uint32_t channel, bool value) {
     state_[channel] = value;
 }
 
-void DigitalState::set_state(std::vector<uint32_t> channels, bool value) {
+void DigitalState::set_state(const std::vector<uint32_t> &channels,
+                             bool value) {
     for (auto &it : channels) {
         if (it >= nchannels()) {
             continue;
@@ -91,7 +92,7 @@ void DigitalState::toggle_state(uint32_t channel) {
     set_state(channel, !state(channel));
 }
 
-void DigitalState::toggle_state(std::vector<uint32_t> channels) {
+void DigitalState::toggle_state(const std::vector<uint32_t> &channels) {
     for (auto &it : channels) {
         if (it >= nchannels()) {
             continue;
@@ -123,12 +124,14 @@ DigitalOutputProtocol::DigitalOutputProtocol(uint32_t nchannels,
                                              DigitalOutputMode default_mode)
     : nchannels_(nchannels), pulse_width_(pulse_width) {
     mode_.assign(nchannels_, default_mode);
+    resolve();
 }
 
 void DigitalOutputProtocol::set_mode(uint32_t channel, DigitalOutputMode mode) {
-    if (channel <= nchannels_) { // fail silently
+    if (channel < nchannels_) { // fail silently
         mode_[channel] = mode;
     }
+    resolve();
 }
 
 unsigned int DigitalOutputProtocol::pulse_width() const { return pulse_width_; }
@@ -140,40 +143,41 @@ void DigitalOutputProtocol::set_pulse_width(unsigned int value) {
 void DigitalOutputProtocol::set_mode(std::vector<uint32_t> channels,
                                      DigitalOutputMode mode) {
     for (const uint32_t &c : channels) {
-        if (c <= nchannels_) {
+        if (c < nchannels_) {
             mode_[c] = mode;
         }
     }
+    resolve();
 }
 
-std::vector<uint32_t>
-DigitalOutputProtocol::find_channels(DigitalOutputMode mode) {
-    std::vector<uint32_t> channels;
+void DigitalOutputProtocol::resolve() {
+    channels_.assign(static_cast<int>(DigitalOutputMode::PULSE) + 1, {});
     for (uint32_t k = 0; k < mode_.size(); ++k) {
-        if (mode_[k] == mode) {
-            channels.push_back(k);
-        }
+        channels_[static_cast<int>(mode_[k])].push_back(k);
     }
-    return channels;
+}
+
+std::vector<uint32_t>
+DigitalOutputProtocol::find_channels(DigitalOutputMode mode) {
+    return channels(mode);
+}
+
+bool DigitalOutputProtocol::apply(DigitalState &state) const {
+    state.set_state(channels(DigitalOutputMode::HIGH), true);
+    state.set_state(channels(DigitalOutputMode::LOW), false);
+    state.toggle_state(channels(DigitalOutputMode::TOGGLE));
+    state.set_state(channels(DigitalOutputMode::PULSE), true);
+    return !channels(DigitalOutputMode::PULSE).empty();
 }
 
 void DigitalOutputProtocol::execute(DigitalDevice &device) {
-    DigitalState state(nchannels_);
-    std::vector<uint32_t> channels;
-    state = device.read_state();
-    channels = find_channels(DigitalOutputMode::HIGH);
-    state.set_state(channels, true);
-    channels = find_channels(DigitalOutputMode::LOW);
-    state.set_state(channels, false);
-    channels = find_channels(DigitalOutputMode::TOGGLE);
-    state.toggle_state(channels);
-    channels = find_channels(DigitalOutputMode::PULSE);
-    state.set_state(channels, true);
+    DigitalState state = device.read_state();
+    bool pulsed = apply(state);
     device.write_state(state);
 
-    if (channels.size() > 0) { // some channels are pulsed
+    if (pulsed) { // some channels are pulsed
         custom_sleep_for(pulse_width_);
-        state.set_state(channels, false);
+        state.set_state(channels(DigitalOutputMode::PULSE), false);
         device.write_state(state);
     }
 }
@@ -52,13 +52,13 @@ class DigitalState {
     std::vector<bool> state(std::vector<uint32_t> channels) const;
 
     void set_state(uint32_t channel, bool value);
-    void set_state(std::vector<uint32_t> channels, bool value);
+    void set_state(const std::vector<uint32_t> &channels, bool value);
     void set_state(bool value);
     void set_state(std::vector<bool> values);
     void set_state(std::vector<uint32_t> channels, std::vector<bool> values);
 
     void toggle_state(uint32_t channel);
-    void toggle_state(std::vector<uint32_t> channels);
+    void toggle_state(const std::vector<uint32_t> &channels);
 
     std::string to_string(std::string high = "1", std::string low = "0",
                           std::string spacer = "") const;
@@ -98,10 +98,25 @@ class DigitalOutputProtocol {
     std::vector<uint32_t>
     find_channels(DigitalOutputMode mode = DigitalOutputMode::NONE);
 
+    // channels per mode, resolved when the modes are set
+    const std::vector<uint32_t> &channels(DigitalOutputMode mode) const {
+        return channels_[static_cast<int>(mode)];
+    }
+
+    // Apply the protocol to state, with pulsed channels set high. Returns
+    // true if there are pulsed channels, which have to be set low again
+    // after pulse_width() microseconds.
+    bool apply(DigitalState &state) const;
+
+    // apply the protocol to the device, waiting for the end of pulses
     void execute(DigitalDevice &device);
 
+  protected:
+    void resolve();
+
   protected:
     uint32_t nchannels_;
     unsigned int pulse_width_;
     std::vector<DigitalOutputMode> mode_;
+    std::vector<std::vector<uint32_t>> channels_;
 };
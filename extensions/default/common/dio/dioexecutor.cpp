@@ -0,0 +1,200 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "dioexecutor.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <ctime>
+
+#include <immintrin.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// remaining wait that is spun rather than slept, to hide the futex wake-up
+// latency at the end of pulses
+const auto SPIN_TIME = std::chrono::microseconds(50);
+
+} // namespace
+
+DigitalOutputExecutor::DigitalOutputExecutor(DigitalDevice &device,
+                                             std::size_t queue_size,
+                                             int priority)
+    : device_(device), state_(device.read_state()), queue_(queue_size) {
+    thread_ = std::thread(&DigitalOutputExecutor::Run, this);
+    if (priority > 0) {
+        struct sched_param param = {};
+        param.sched_priority = std::min(priority, sched_get_priority_max(
+                                                      SCHED_FIFO));
+        realtime_ = pthread_setschedparam(thread_.native_handle(), SCHED_FIFO,
+                                          &param) == 0;
+    }
+}
+
+void DigitalOutputExecutor::Stop() {
+    if (thread_.joinable()) {
+        stop_ = true;
+        wake();
+        thread_.join();
+    }
+}
+
+bool DigitalOutputExecutor::Submit(const DigitalOutputProtocol &protocol,
+                                   TimePoint trigger) {
+    if (!queue_.push(Command{&protocol, trigger})) {
+        return false;
+    }
+    // only enter the kernel if the executor is asleep (or about to be), the
+    // fence pairs with the one in wait()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.load()) {
+        wake();
+    }
+    return true;
+}
+
+std::string DigitalOutputExecutor::last_error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return last_error_;
+}
+
+void DigitalOutputExecutor::wake() {
+    wake_count_.fetch_add(1);
+    syscall(SYS_futex, reinterpret_cast<int32_t *>(&wake_count_),
+            FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void DigitalOutputExecutor::wait(TimePoint until) {
+    int32_t count = wake_count_.load();
+    waiting_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // a command may have been queued before waiting_ was set
+    if (!queue_.empty() || (stop_ && until == TimePoint::max())) {
+        waiting_.store(false);
+        return;
+    }
+
+    auto now = Clock::now();
+    if (until == TimePoint::max()) {
+        syscall(SYS_futex, reinterpret_cast<int32_t *>(&wake_count_),
+                FUTEX_WAIT_PRIVATE, count, nullptr, nullptr, 0);
+    } else if (until - now > SPIN_TIME) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      until - now - SPIN_TIME)
+                      .count();
+        struct timespec timeout;
+        timeout.tv_sec = ns / 1000000000;
+        timeout.tv_nsec = ns % 1000000000;
+        syscall(SYS_futex, reinterpret_cast<int32_t *>(&wake_count_),
+                FUTEX_WAIT_PRIVATE, count, &timeout, nullptr, 0);
+    } else {
+        while (Clock::now() < until && queue_.empty()) {
+            _mm_pause();
+        }
+    }
+    waiting_.store(false);
+}
+
+void DigitalOutputExecutor::write_state() { device_.write_state(state_); }
+
+void DigitalOutputExecutor::execute(const Command &command) {
+    const DigitalOutputProtocol &protocol = *command.protocol;
+    bool pulsed = protocol.apply(state_);
+    write_state();
+    latency_.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - command.trigger)
+                        .count());
+    ++nexecuted_;
+
+    if (pulsed) {
+        TimePoint end =
+            Clock::now() + std::chrono::microseconds(protocol.pulse_width());
+        // a repeated pulse extends the one that is still running
+        auto it = std::find_if(pulses_.begin(), pulses_.end(),
+                               [&](const Pulse &pulse) {
+                                   return pulse.protocol == &protocol;
+                               });
+        if (it != pulses_.end()) {
+            it->end = end;
+        } else {
+            pulses_.push_back(Pulse{end, &protocol});
+        }
+    }
+}
+
+void DigitalOutputExecutor::end_pulses(TimePoint now) {
+    auto ended = std::partition(
+        pulses_.begin(), pulses_.end(),
+        [now](const Pulse &pulse) { return pulse.end > now; });
+    if (ended == pulses_.end()) {
+        return;
+    }
+    // channels that are also pulsed by a running pulse stay high
+    low_channels_.clear();
+    for (auto it = ended; it != pulses_.end(); ++it) {
+        for (auto channel : it->protocol->channels(DigitalOutputMode::PULSE)) {
+            bool running = std::any_of(
+                pulses_.begin(), ended, [channel](const Pulse &pulse) {
+                    auto &c = pulse.protocol->channels(DigitalOutputMode::PULSE);
+                    return std::find(c.begin(), c.end(), channel) != c.end();
+                });
+            if (!running) {
+                low_channels_.push_back(channel);
+            }
+        }
+    }
+    pulses_.erase(ended, pulses_.end());
+    state_.set_state(low_channels_, false);
+    write_state();
+}
+
+void DigitalOutputExecutor::Run() {
+    // futex time-outs are otherwise rounded up by up to 50 us
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+    Command command;
+    while (true) {
+        try {
+            while (queue_.pop(command)) {
+                execute(command);
+            }
+            end_pulses(Clock::now());
+        } catch (std::exception &e) {
+            ++nerrors_;
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            last_error_ = e.what();
+        }
+
+        if (stop_ && pulses_.empty() && queue_.empty()) {
+            break;
+        }
+
+        TimePoint until = TimePoint::max();
+        for (auto &pulse : pulses_) {
+            until = std::min(until, pulse.end);
+        }
+        wait(until);
+    }
+}
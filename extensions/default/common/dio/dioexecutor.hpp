@@ -0,0 +1,111 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dio.hpp"
+#include "latencyhistogram.hpp"
+#include "utilities/spscqueue.hpp"
+#include "utilities/time.hpp"
+
+// Executes digital output protocols on a dedicated thread, so that the thread
+// that triggers them does not wait for the device or for the end of pulses.
+// Protocols are handed over through a lock-free single-producer,
+// single-consumer queue and the executor thread, which can run with real-time
+// (SCHED_FIFO) priority, sleeps on a futex when there is nothing to do. Pulses
+// end on the executor thread while other protocols keep being executed.
+//
+// The latency from the trigger time of a protocol to the completion of the
+// device write is recorded in a histogram.
+class DigitalOutputExecutor {
+  public:
+    // A priority of 0 keeps the default scheduling policy.
+    DigitalOutputExecutor(DigitalDevice &device, std::size_t queue_size = 64,
+                          int priority = 0);
+    ~DigitalOutputExecutor() { Stop(); }
+
+    DigitalOutputExecutor(const DigitalOutputExecutor &) = delete;
+    DigitalOutputExecutor &operator=(const DigitalOutputExecutor &) = delete;
+
+    // Queues protocol for execution, to be called from a single thread. The
+    // protocol must outlive the executor. Returns false if the queue is full.
+    bool Submit(const DigitalOutputProtocol &protocol,
+                TimePoint trigger = Clock::now());
+
+    // executes the queued protocols, waits for pending pulses to end and
+    // stops the executor thread
+    void Stop();
+
+    // true if the real-time priority could be set
+    bool realtime() const { return realtime_; }
+
+    // trigger to device write latency, recorded by the executor thread
+    const LatencyHistogram &latency() const { return latency_; }
+
+    uint64_t nexecuted() const { return nexecuted_.load(); }
+    uint64_t nerrors() const { return nerrors_.load(); }
+    std::string last_error() const;
+
+  protected:
+    struct Command {
+        const DigitalOutputProtocol *protocol;
+        TimePoint trigger;
+    };
+
+    struct Pulse {
+        TimePoint end;
+        const DigitalOutputProtocol *protocol;
+    };
+
+    void Run();
+    void execute(const Command &command);
+    void end_pulses(TimePoint now);
+    void write_state();
+    void wait(TimePoint until);
+    void wake();
+
+  protected:
+    DigitalDevice &device_;
+    // the executor owns the device, so it keeps its state instead of
+    // reading it back for every protocol
+    DigitalState state_;
+    std::vector<Pulse> pulses_;
+    std::vector<uint32_t> low_channels_;
+
+    SpscQueue<Command> queue_;
+    std::atomic<int32_t> wake_count_{0};
+    std::atomic<bool> waiting_{false};
+    std::atomic<bool> stop_{false};
+
+    bool realtime_ = false;
+    LatencyHistogram latency_;
+    std::atomic<uint64_t> nexecuted_{0};
+    std::atomic<uint64_t> nerrors_{0};
+    mutable std::mutex error_mutex_;
+    std::string last_error_;
+
+    std::thread thread_;
+};
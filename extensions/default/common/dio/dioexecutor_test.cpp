@@ -0,0 +1,183 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dio/dioexecutor.hpp"
+#include "dio/dummydio.hpp"
+#include "gtest/gtest.h"
+
+// DummyDIO that records every state written by the executor, and can hold
+// the executor in a write until it is released
+class TestDIO : public DummyDIO {
+  public:
+    struct Write {
+        TimePoint time;
+        DigitalState state;
+    };
+
+    TestDIO(uint32_t nchannels, bool hold = false)
+        : DummyDIO(nchannels), hold_(hold) {}
+
+    void write_state(DigitalState &state) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++nwriting_;
+        condition_.notify_all();
+        condition_.wait(lock, [this] { return !hold_; });
+        DummyDIO::write_state(state);
+        writes_.push_back({Clock::now(), state});
+    }
+
+    void wait_for_write() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return nwriting_ > 0; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hold_ = false;
+        condition_.notify_all();
+    }
+
+    std::vector<Write> writes() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return writes_;
+    }
+
+  protected:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool hold_;
+    int nwriting_ = 0;
+    std::vector<Write> writes_;
+};
+
+namespace {
+
+// index of the first write at or after <from> that sets channel to value
+std::size_t find_write(const std::vector<TestDIO::Write> &writes,
+                       uint32_t channel, bool value, std::size_t from = 0) {
+    for (std::size_t k = from; k < writes.size(); ++k) {
+        if (writes[k].state.state(channel) == value) {
+            return k;
+        }
+    }
+    return writes.size();
+}
+
+TEST(DigitalOutputExecutorTest, PulseEndsAfterPulseWidth) {
+    TestDIO device(4);
+    DigitalOutputProtocol protocol(4, 2000);
+    protocol.set_mode(1, DigitalOutputMode::PULSE);
+
+    DigitalOutputExecutor executor(device);
+    ASSERT_TRUE(executor.Submit(protocol));
+    executor.Stop();
+
+    auto writes = device.writes();
+    auto high = find_write(writes, 1, true);
+    ASSERT_LT(high, writes.size());
+    auto low = find_write(writes, 1, false, high);
+    ASSERT_LT(low, writes.size());
+
+    EXPECT_GE(writes[low].time - writes[high].time,
+              std::chrono::microseconds(2000));
+    EXPECT_FALSE(device.read_state().state(1));
+    EXPECT_EQ(executor.nexecuted(), 1);
+}
+
+TEST(DigitalOutputExecutorTest, OverlappingPulsesKeepSharedChannelHigh) {
+    TestDIO device(4);
+    DigitalOutputProtocol shorter(4, 2000);
+    shorter.set_mode({0, 1}, DigitalOutputMode::PULSE);
+    DigitalOutputProtocol longer(4, 20000);
+    longer.set_mode({1, 2}, DigitalOutputMode::PULSE);
+
+    DigitalOutputExecutor executor(device);
+    ASSERT_TRUE(executor.Submit(shorter));
+    ASSERT_TRUE(executor.Submit(longer));
+    executor.Stop();
+
+    auto writes = device.writes();
+    auto high = find_write(writes, 0, true);
+    ASSERT_LT(high, writes.size());
+
+    // the end of the shorter pulse leaves the shared channel high
+    auto end_shorter = find_write(writes, 0, false, high);
+    ASSERT_LT(end_shorter, writes.size());
+    EXPECT_TRUE(writes[end_shorter].state.state(1));
+    EXPECT_TRUE(writes[end_shorter].state.state(2));
+
+    // both channels of the longer pulse go low together
+    auto end_longer = find_write(writes, 1, false, end_shorter);
+    ASSERT_LT(end_longer, writes.size());
+    EXPECT_FALSE(writes[end_longer].state.state(2));
+    EXPECT_GE(writes[end_longer].time - writes[high].time,
+              std::chrono::microseconds(20000));
+}
+
+TEST(DigitalOutputExecutorTest, RepeatedPulseExtendsRunningOne) {
+    TestDIO device(4);
+    DigitalOutputProtocol protocol(4, 50000);
+    protocol.set_mode(0, DigitalOutputMode::PULSE);
+
+    DigitalOutputExecutor executor(device);
+    ASSERT_TRUE(executor.Submit(protocol));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_TRUE(executor.Submit(protocol));
+    executor.Stop();
+
+    auto writes = device.writes();
+    ASSERT_EQ(writes.size(), 3);
+    EXPECT_TRUE(writes[0].state.state(0));
+    EXPECT_TRUE(writes[1].state.state(0));
+    EXPECT_FALSE(writes[2].state.state(0));
+
+    // the pulse ends one pulse width after the repeated one started
+    EXPECT_GE(writes[2].time - writes[1].time,
+              std::chrono::microseconds(50000));
+    EXPECT_EQ(executor.nexecuted(), 2);
+}
+
+TEST(DigitalOutputExecutorTest, SubmitFailsWhenQueueIsFull) {
+    TestDIO device(4, true);
+    DigitalOutputProtocol protocol(4, 0);
+    protocol.set_mode(0, DigitalOutputMode::TOGGLE);
+
+    DigitalOutputExecutor executor(device, 2);
+
+    // the executor takes the first protocol from the queue and is held in
+    // the device write, the next two fill the queue
+    ASSERT_TRUE(executor.Submit(protocol));
+    device.wait_for_write();
+    EXPECT_TRUE(executor.Submit(protocol));
+    EXPECT_TRUE(executor.Submit(protocol));
+    EXPECT_FALSE(executor.Submit(protocol));
+
+    device.release();
+    executor.Stop();
+    EXPECT_EQ(executor.nexecuted(), 3);
+    EXPECT_EQ(device.writes().size(), 3);
+}
+
+} // namespace
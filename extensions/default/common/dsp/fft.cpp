@@ -0,0 +1,91 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "fft.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+using namespace dsp::fft;
+
+std::size_t dsp::fft::next_power_of_two(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+FFT::FFT(std::size_t size) : size_(size) {
+    if (size < 2 || (size & (size - 1)) != 0) {
+        throw std::runtime_error("FFT size needs to be a power of 2.");
+    }
+
+    twiddles_.resize(size_ / 2);
+    for (std::size_t k = 0; k < size_ / 2; ++k) {
+        twiddles_[k] = std::polar(1.0, -2.0 * M_PI * k / size_);
+    }
+
+    unsigned int nbits = 0;
+    while ((std::size_t(1) << nbits) < size_) {
+        ++nbits;
+    }
+
+    bitreversed_.resize(size_);
+    for (std::size_t k = 0; k < size_; ++k) {
+        std::size_t r = 0;
+        for (unsigned int b = 0; b < nbits; ++b) {
+            r |= ((k >> b) & 1) << (nbits - 1 - b);
+        }
+        bitreversed_[k] = r;
+    }
+}
+
+std::size_t FFT::size() const { return size_; }
+
+void FFT::forward(std::complex<double> *data) const {
+    transform(data, false);
+}
+
+void FFT::inverse(std::complex<double> *data) const { transform(data, true); }
+
+void FFT::transform(std::complex<double> *data, bool inverse) const {
+    for (std::size_t k = 0; k < size_; ++k) {
+        if (k < bitreversed_[k]) {
+            std::swap(data[k], data[bitreversed_[k]]);
+        }
+    }
+
+    for (std::size_t len = 2; len <= size_; len <<= 1) {
+        std::size_t half = len / 2;
+        std::size_t step = size_ / len;
+        for (std::size_t start = 0; start < size_; start += len) {
+            for (std::size_t k = 0; k < half; ++k) {
+                std::complex<double> w = twiddles_[k * step];
+                if (inverse) {
+                    w = std::conj(w);
+                }
+                std::complex<double> t = w * data[start + k + half];
+                data[start + k + half] = data[start + k] - t;
+                data[start + k] += t;
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace dsp {
+namespace fft {
+
+// smallest power of 2 that is larger than or equal to n
+std::size_t next_power_of_two(std::size_t n);
+
+// In-place iterative radix-2 complex FFT with precomputed twiddle factors and
+// bit-reversal permutation.
+class FFT {
+  public:
+    FFT(std::size_t size);
+
+    std::size_t size() const;
+
+    void forward(std::complex<double> *data) const;
+    // inverse transform is not normalized (i.e. result is scaled by size)
+    void inverse(std::complex<double> *data) const;
+
+  protected:
+    void transform(std::complex<double> *data, bool inverse) const;
+
+  protected:
+    std::size_t size_;
+    std::vector<std::complex<double>> twiddles_;
+    std::vector<std::size_t> bitreversed_;
+};
+
+} // namespace fft
+} // namespace dsp
@@ -19,6 +19,8 @@
 
 #include "filter.hpp"
 
+#include <cmath>
+
 using namespace dsp::filter;
 
 IFilter::~IFilter() { unrealize(); }
@@ -144,7 +146,7 @@ IFilter *dsp::filter::construct_from_yaml(const YAML::Node &node) {
     // coefficients: list of doubles (fir) or list of lists of 6 doubles
     // (biquad) window size : 1 uint (slope filter only) order : 1 uint (slope
     // filter only) derivative order: 1 uint (slope filter only) description:
-    // text
+    // text fft threshold: 1 uint (fir only)
 
     if (node["file"]) {
         return construct_from_file(node["file"].as<std::string>());
@@ -156,7 +158,10 @@ IFilter *dsp::filter::construct_from_yaml(const YAML::Node &node) {
     if (filter_type == "fir") {
         std::vector<double> coef =
             node["coefficients"].as<std::vector<double>>();
-        return new FirFilter(coef, desc);
+        auto filter = new FirFilter(coef, desc);
+        filter->set_fft_threshold(node["fft threshold"].as<unsigned int>(
+            FirFilter::DEFAULT_FFT_THRESHOLD));
+        return filter;
 
     } else if (filter_type == "slope") {
         uint32_t window_size = node["windows size"].as<unsigned int>(
@@ -189,10 +194,13 @@ FirFilter::FirFilter(const std::vector<double> &coefficients,
         throw std::runtime_error("Invalid number of filter taps.");
     }
     pcoefficients_ = coefficients_.data();
+    fcoefficients_.assign(coefficients_.begin(), coefficients_.end());
 }
 
 IFilter *FirFilter::clone() {
-    return new FirFilter(coefficients_, description_);
+    auto filter = new FirFilter(coefficients_, description_);
+    filter->set_fft_threshold(fft_threshold_);
+    return filter;
 }
 
 FirFilter *FirFilter::FromStream(std::istream &stream, std::string description,
@@ -215,136 +223,189 @@ unsigned int FirFilter::order() const { return ntaps_ - 1; }
 
 std::size_t FirFilter::group_delay() const { return order() / 2; }
 
-double FirFilter::process_channel(double input, unsigned int channel) {
-    std::rotate(registers_[channel].rbegin(), registers_[channel].rbegin() + 1,
-                registers_[channel].rend());
-    registers_[channel][0] = input;
+unsigned int FirFilter::fft_threshold() const { return fft_threshold_; }
 
-    double result = 0;
+void FirFilter::set_fft_threshold(unsigned int ntaps) {
+    fft_threshold_ = ntaps;
+}
 
-    for (unsigned int k = 0; k < ntaps_; ++k) {
-        result += coefficients_[k] * registers_[channel][k];
+std::size_t FirFilter::fft_size(uint64_t nsamples) const {
+    // the transform holds the history and all new samples if possible, but
+    // long buckets are split into blocks of at least 3 * ntaps samples
+    return fft::next_power_of_two(
+        std::min<uint64_t>(ntaps_ - 1 + nsamples, 4 * ntaps_));
+}
+
+bool FirFilter::use_fft(uint64_t nsamples) const {
+    if (fft_threshold_ == 0 || ntaps_ < 2 || ntaps_ < fft_threshold_ ||
+        nsamples < MIN_FFT_BLOCK_SIZE) {
+        return false;
     }
 
-    return result;
+    // rough cost estimate relative to the vectorized direct form: a forward
+    // and inverse transform for every block, shared by a pair of channels
+    std::size_t nfft = fft_size(nsamples);
+    uint64_t nblocks = (nsamples + nfft - ntaps_) / (nfft - ntaps_ + 1);
+    double log2n = std::log2(static_cast<double>(nfft));
+    return FFT_COST * nblocks * nfft * log2n < double(ntaps_) * nsamples;
 }
 
-void FirFilter::process_sample(std::vector<double> &input,
-                               std::vector<double> &output) {
-    double result;
+void FirFilter::prepare_block(uint64_t nsamples) {
+    std::size_t nfft = fft_size(nsamples);
 
-    for (unsigned int channel = 0; channel < nchannels_; ++channel) {
-        std::rotate(registers_[channel].rbegin(),
-                    registers_[channel].rbegin() + 1,
-                    registers_[channel].rend());
-        registers_[channel][0] = input[0];
-
-        result = 0;
+    if (fft_ && fft_->size() == nfft) {
+        return;
+    }
 
-        for (unsigned int k = 0; k < ntaps_; ++k) {
-            result += coefficients_[k] * registers_[channel][k];
-        }
+    fft_.reset(new fft::FFT(nfft));
+    block_size_ = nfft - (ntaps_ - 1);
 
-        output[channel] = result;
+    // filter spectrum, including normalization of the inverse transform
+    spectrum_.assign(nfft, 0.0);
+    for (unsigned int k = 0; k < ntaps_; ++k) {
+        spectrum_[k] = coefficients_[k] / nfft;
     }
+    fft_->forward(spectrum_.data());
+
+    workspace_.resize(nfft);
+    history_.resize(2 * (ntaps_ - 1));
 }
 
-void FirFilter::process_sample(std::vector<double>::iterator input,
-                               std::vector<double>::iterator output) {
-    double result;
+void FirFilter::process_block(uint64_t nsamples, const double *input,
+                              double *output, std::size_t stride,
+                              unsigned int channel, bool pair) {
+    prepare_block(nsamples);
 
-    for (unsigned int channel = 0; channel < nchannels_; ++channel) {
-        std::rotate(registers_[channel].rbegin(),
-                    registers_[channel].rbegin() + 1,
-                    registers_[channel].rend());
-        registers_[channel][0] = *input++;
+    const std::size_t nfft = fft_->size();
+    const unsigned int nhistory = ntaps_ - 1;
+    double *history[2] = {history_.data(), history_.data() + nhistory};
+
+    // most recent ntaps - 1 samples from the delay line, oldest first
+    for (unsigned int lane = 0; lane < (pair ? 2u : 1u); ++lane) {
+        const double *reg =
+            pregisters_[channel + lane] + positions_[channel + lane];
+        for (unsigned int k = 0; k < nhistory; ++k) {
+            history[lane][k] = reg[nhistory - 1 - k];
+        }
+    }
 
-        result = 0;
+    for (uint64_t start = 0; start < nsamples; start += block_size_) {
+        std::size_t n = std::min<uint64_t>(block_size_, nsamples - start);
+        const double *in = input + start * stride;
+        double *out = output + start * stride;
 
-        for (unsigned int k = 0; k < ntaps_; ++k) {
-            result += coefficients_[k] * registers_[channel][k];
+        for (unsigned int k = 0; k < nhistory; ++k) {
+            workspace_[k] = {history[0][k], pair ? history[1][k] : 0.0};
+        }
+        for (std::size_t k = 0; k < n; ++k) {
+            workspace_[nhistory + k] = {in[k * stride],
+                                        pair ? in[k * stride + 1] : 0.0};
         }
+        std::fill(workspace_.begin() + nhistory + n, workspace_.end(), 0.0);
 
-        *output = result;
-        output++;
+        // keep history for the next block before the output is written, so
+        // that in-place processing is possible
+        for (unsigned int k = 0; k < nhistory; ++k) {
+            history[0][k] = workspace_[n + k].real();
+            history[1][k] = workspace_[n + k].imag();
+        }
+
+        fft_->forward(workspace_.data());
+        for (std::size_t k = 0; k < nfft; ++k) {
+            workspace_[k] *= spectrum_[k];
+        }
+        fft_->inverse(workspace_.data());
+
+        // the first ntaps - 1 outputs are corrupted by circular wrap-around
+        for (std::size_t k = 0; k < n; ++k) {
+            out[k * stride] = workspace_[nhistory + k].real();
+            if (pair) {
+                out[k * stride + 1] = workspace_[nhistory + k].imag();
+            }
+        }
+    }
+
+    // store history back into the delay line, such that sample-by-sample
+    // processing can continue where the block left off. The oldest slot is
+    // overwritten by the next sample and does not need to be set.
+    for (unsigned int lane = 0; lane < (pair ? 2u : 1u); ++lane) {
+        double *reg = pregisters_[channel + lane];
+        positions_[channel + lane] = 0;
+        for (unsigned int k = 0; k < nhistory; ++k) {
+            reg[k] = reg[k + ntaps_] = history[lane][nhistory - 1 - k];
+        }
     }
 }
 
-void FirFilter::process_sample(double *input, double *output) {
-    // skip check if filter has been realized??
-    double result;
-    double *coef, *reg;
+double FirFilter::process_channel(double input, unsigned int channel) {
+    return filter_sample(input, channel);
+}
 
+void FirFilter::process_sample(std::vector<double> &input,
+                               std::vector<double> &output) {
     for (unsigned int channel = 0; channel < nchannels_; ++channel) {
-        reg = pregisters_[channel];
+        output[channel] = filter_sample(input[channel], channel);
+    }
+}
 
-        memmove((void *)(reg + 1), (void *)reg, (ntaps_ - 1) * sizeof(double));
-        *reg = *input;
+void FirFilter::process_sample(std::vector<double>::iterator input,
+                               std::vector<double>::iterator output) {
+    for (unsigned int channel = 0; channel < nchannels_; ++channel) {
+        *output = filter_sample(*input++, channel);
+        output++;
+    }
+}
 
-        coef = pcoefficients_;
-        result = 0;
+void FirFilter::process_sample(double *input, double *output) {
+    for (unsigned int channel = 0; channel < nchannels_; ++channel) {
+        output[channel] = filter_sample(input[channel], channel);
+    }
+}
 
-        for (unsigned int k = 0; k < ntaps_; ++k) {
-            result += *coef++ * *reg++;
-        }
+void FirFilter::process_sample(float *input, float *output) {
+    for (unsigned int channel = 0; channel < nchannels_; ++channel) {
+        output[channel] = filter_sample(input[channel], channel);
+    }
+}
 
-        *output = result;
+void FirFilter::skip_sample(const double *input) {
+    for (unsigned int channel = 0; channel < nchannels_; ++channel) {
+        push_sample(input[channel], channel);
+    }
+}
 
-        input++;  // move to next channel
-        output++; // move to next channel
+void FirFilter::skip_sample(const float *input) {
+    for (unsigned int channel = 0; channel < nchannels_; ++channel) {
+        push_sample(input[channel], channel);
     }
 }
 
 void FirFilter::process_channel(std::vector<double> &input,
                                 std::vector<double> &output,
                                 unsigned int channel) {
-    double result;
-
     uint64_t nsamples = input.size();
     // check output.size() == input.size()
 
-    for (uint64_t s = 0; s < nsamples; ++s) {
-        std::rotate(registers_[channel].rbegin(),
-                    registers_[channel].rbegin() + 1,
-                    registers_[channel].rend());
-        registers_[channel][0] = input[s];
-
-        result = 0;
-
-        for (unsigned int k = 0; k < ntaps_; ++k) {
-            result += coefficients_[k] * registers_[channel][k];
-        }
-
-        output[s] = result;
-    }
+    process_channel(nsamples, input.data(), output.data(), channel);
 }
 
 void FirFilter::process_channel(uint64_t nsamples,
                                 std::vector<double>::iterator input,
                                 std::vector<double>::iterator output,
                                 unsigned int channel) {
-    double result;
-
-    for (uint64_t s = 0; s < nsamples; ++s) {
-        std::rotate(registers_[channel].rbegin(),
-                    registers_[channel].rbegin() + 1,
-                    registers_[channel].rend());
-        registers_[channel][0] = *input++;
-
-        result = 0;
-
-        for (unsigned int k = 0; k < ntaps_; ++k) {
-            result += coefficients_[k] * registers_[channel][k];
-        }
-
-        *output = result;
-        output++;
-    }
+    process_channel(nsamples, &(*input), &(*output), channel);
 }
 
 void FirFilter::process_channel(uint64_t nsamples, double *input,
                                 double *output, unsigned int channel) {
-    throw std::runtime_error("Not yet implemented.");
+    if (use_fft(nsamples)) {
+        process_block(nsamples, input, output, 1, channel, false);
+        return;
+    }
+
+    for (uint64_t s = 0; s < nsamples; ++s) {
+        output[s] = filter_sample(input[s], channel);
+    }
 }
 
 void FirFilter::process_by_channel(std::vector<std::vector<double>> &input,
@@ -381,12 +442,34 @@ void FirFilter::process_by_channel(uint64_t nsamples,
                                    std::vector<double> &output) {
     assert(nsamples * nchannels_ == input.size() &&
            input.size() == output.size());
-    auto in_it = input.begin();
-    auto out_it = output.begin();
-    for (unsigned int s = 0; s < nsamples; ++s) {
-        process_sample(in_it, out_it);
-        in_it += nchannels_;
-        out_it += nchannels_;
+    process_by_channel(nsamples, input.data(), output.data());
+}
+
+void FirFilter::process_by_channel(uint64_t nsamples, double *input,
+                                   double *output) {
+    if (use_fft(nsamples)) {
+        // channels are processed in pairs, one in the real and one in the
+        // imaginary part of the transform
+        for (unsigned int c = 0; c < nchannels_; c += 2) {
+            process_block(nsamples, input + c, output + c, nchannels_, c,
+                          c + 1 < nchannels_);
+        }
+        return;
+    }
+
+    for (uint64_t s = 0; s < nsamples; ++s) {
+        process_sample(input, output);
+        input += nchannels_;
+        output += nchannels_;
+    }
+}
+
+void FirFilter::process_by_channel(uint64_t nsamples, float *input,
+                                   float *output) {
+    for (uint64_t s = 0; s < nsamples; ++s) {
+        process_sample(input, output);
+        input += nchannels_;
+        output += nchannels_;
     }
 }
 
@@ -404,11 +487,21 @@ void FirFilter::process_by_sample(uint64_t nsamples, std::vector<double> &input,
 }
 
 bool FirFilter::realize_filter(unsigned int nchannels, double init) {
-    // create and initialize register for each channel
-    for (unsigned int k = 0; k < nchannels; ++k) {
-        registers_.push_back(std::vector<double>(ntaps_, init));
-        pregisters_.push_back(registers_.back().data());
+    // create and initialize (double length) delay line for each channel
+    registers_.assign(nchannels, std::vector<double>(2 * ntaps_, init));
+    pregisters_.clear();
+    for (auto &it : registers_) {
+        pregisters_.push_back(it.data());
+    }
+    positions_.assign(nchannels, 0);
+
+    fregisters_.assign(
+        nchannels, std::vector<float>(2 * ntaps_, static_cast<float>(init)));
+    pfregisters_.clear();
+    for (auto &it : fregisters_) {
+        pfregisters_.push_back(it.data());
     }
+    fpositions_.assign(nchannels, 0);
 
     return true;
 }
@@ -416,6 +509,10 @@ bool FirFilter::realize_filter(unsigned int nchannels, double init) {
 void FirFilter::unrealize_filter() {
     pregisters_.clear();
     registers_.clear();
+    positions_.clear();
+    pfregisters_.clear();
+    fregisters_.clear();
+    fpositions_.clear();
 }
 
 SlopeFilter *SlopeFilter::FromStream(std::istream &stream,
@@ -491,43 +588,36 @@ BiquadFilter *BiquadFilter::FromStream(std::istream &stream,
 unsigned int BiquadFilter::order() const { return nstages_ * 2; }
 
 double BiquadFilter::process_channel(double x, unsigned int c) {
-    double u_n, y_n = 0.0;
-
-    for (unsigned int s = 0; s < nstages_; ++s) {
-        u_n = x - coefficients_[s][4] * registers_[c][s][0] -
-              coefficients_[s][5] * registers_[c][s][1];
-        y_n = coefficients_[s][0] * u_n +
-              coefficients_[s][1] * registers_[c][s][0] +
-              coefficients_[s][2] * registers_[c][s][1];
-        registers_[c][s][1] = registers_[c][s][0];
-        registers_[c][s][0] = u_n;
-        x = y_n;
-    }
+    return simd::biquad_channel(coefficients_.data()->data(), nstages_, gain_,
+                                registers_.data() + c, nchannels_, x);
+}
 
-    return y_n * gain_;
+void BiquadFilter::process_sample(std::vector<double> &input,
+                                  std::vector<double> &output) {
+    process_sample(input.data(), output.data());
 }
 
 void BiquadFilter::process_sample(std::vector<double>::iterator input,
                                   std::vector<double>::iterator output) {
+    process_sample(&(*input), &(*output));
+}
+
+void BiquadFilter::process_sample(double *input, double *output) {
     if (!realized_) {
         throw std::runtime_error("Filter has not been realized yet.");
     }
 
-    for (unsigned int c = 0; c < nchannels_; ++c) {
-        *output = process_channel((*input++), c);
-        output++;
-    }
+    simd::biquad(coefficients_.data()->data(), nstages_, gain_,
+                 registers_.data(), nchannels_, input, output, 1);
 }
 
-void BiquadFilter::process_sample(double *input, double *output) {
+void BiquadFilter::process_sample(float *input, float *output) {
     if (!realized_) {
         throw std::runtime_error("Filter has not been realized yet.");
     }
 
-    for (unsigned int c = 0; c < nchannels_; ++c) {
-        *output = process_channel((*input++), c);
-        output++;
-    }
+    simd::biquad(coefficients_.data()->data(), nstages_, gain_,
+                 registers_.data(), nchannels_, input, output, 1);
 }
 
 void BiquadFilter::process_channel(std::vector<double> &input,
@@ -593,13 +683,28 @@ void BiquadFilter::process_by_channel(uint64_t nsamples,
                                       std::vector<double> &output) {
     assert(nsamples * nchannels_ == input.size() &&
            input.size() == output.size());
-    auto in_it = input.begin();
-    auto out_it = output.begin();
-    for (unsigned int s = 0; s < nsamples; ++s) {
-        process_sample(in_it, out_it);
-        in_it += nchannels_;
-        out_it += nchannels_;
+    process_by_channel(nsamples, input.data(), output.data());
+}
+
+void BiquadFilter::process_by_channel(uint64_t nsamples, double *input,
+                                      double *output) {
+    if (!realized_) {
+        throw std::runtime_error("Filter has not been realized yet.");
+    }
+
+    // interleaved data: process groups of channels in SIMD lanes
+    simd::biquad(coefficients_.data()->data(), nstages_, gain_,
+                 registers_.data(), nchannels_, input, output, nsamples);
+}
+
+void BiquadFilter::process_by_channel(uint64_t nsamples, float *input,
+                                      float *output) {
+    if (!realized_) {
+        throw std::runtime_error("Filter has not been realized yet.");
     }
+
+    simd::biquad(coefficients_.data()->data(), nstages_, gain_,
+                 registers_.data(), nchannels_, input, output, nsamples);
 }
 
 void BiquadFilter::process_by_sample(uint64_t nsamples,
@@ -617,12 +722,8 @@ void BiquadFilter::process_by_sample(uint64_t nsamples,
 }
 
 bool BiquadFilter::realize_filter(unsigned int nchannels, double init) {
-    for (unsigned int k = 0; k < nchannels; ++k) {
-        registers_.push_back(std::vector<std::array<double, 2>>(nstages_));
-        for (auto &it : registers_.back()) {
-            it.fill(init);
-        }
-    }
+    // two delay registers per stage and channel
+    registers_.assign(2 * nstages_ * nchannels, init);
 
     return true;
 }
@@ -19,7 +19,9 @@
 
 #pragma once
 
+#include "fft.hpp"
 #include "gram_savitzky_golay.hpp"
+#include "simd.hpp"
 
 #include <yaml-cpp/yaml.h>
 
@@ -27,11 +29,13 @@
 #include <array>
 #include <cassert>
 #include <cctype>
+#include <complex>
 #include <cstdint>
 #include <cstring>
 #include <exception>
 #include <fstream>
 #include <map>
+#include <memory>
 #include <regex>
 #include <string>
 #include <vector>
@@ -64,6 +68,7 @@ class IFilter {
     virtual void process_sample(std::vector<double>::iterator,
                                 std::vector<double>::iterator) = 0;
     virtual void process_sample(double *, double *) = 0;
+    virtual void process_sample(float *, float *) = 0;
 
     // single channel, multiple samples
     virtual void process_channel(std::vector<double> &, std::vector<double> &,
@@ -92,6 +97,10 @@ class IFilter {
     virtual void
     process_by_sample(uint64_t nsamples, std::vector<double> &,
                       std::vector<double> &) = 0; // channels<samples>
+    virtual void process_by_channel(uint64_t nsamples, double *,
+                                    double *) = 0; // samples<channels>
+    virtual void process_by_channel(uint64_t nsamples, float *,
+                                    float *) = 0; // samples<channels>
 
   protected:
     virtual bool realize_filter(unsigned int nchannels, double init) = 0;
@@ -116,6 +125,15 @@ class FirFilter : public IFilter {
 
     std::size_t group_delay() const;
 
+    // Multi-sample processing switches to FFT based overlap-save convolution
+    // for filters with at least fft_threshold taps, if at least
+    // MIN_FFT_BLOCK_SIZE samples are processed per call and the transforms
+    // are estimated to be cheaper than the direct form (i.e. the bucket is
+    // long enough compared to the filter). A threshold of 0 disables block
+    // processing. Both modes share the same delay line and can be mixed.
+    unsigned int fft_threshold() const;
+    void set_fft_threshold(unsigned int ntaps);
+
     // single channel, single sample
     double process_channel(double input, unsigned int channel = 0) final;
 
@@ -125,6 +143,12 @@ class FirFilter : public IFilter {
     void process_sample(std::vector<double>::iterator input,
                         std::vector<double>::iterator output) final;
     void process_sample(double *input, double *output) final;
+    void process_sample(float *input, float *output) final;
+
+    // all channels, single sample, without computing the output. Used for
+    // decimation, where the output is only needed for the retained samples.
+    void skip_sample(const double *input);
+    void skip_sample(const float *input);
 
     // single channel, multiple samples
     void process_channel(std::vector<double> &input,
@@ -152,20 +176,95 @@ class FirFilter : public IFilter {
     virtual void process_by_sample(uint64_t nsamples,
                                    std::vector<double> &input,
                                    std::vector<double> &output);
+    void process_by_channel(uint64_t nsamples, double *input,
+                            double *output) final;
+    // single precision data is filtered with single precision coefficients
+    // and delay lines (direct form only)
+    void process_by_channel(uint64_t nsamples, float *input,
+                            float *output) final;
 
   protected:
     bool realize_filter(unsigned int nchannels, double init = 0.0) final;
     void unrealize_filter() final;
 
+    // add sample to delay line of channel
+    inline double *push_sample(double input, unsigned int channel) {
+        unsigned int &pos = positions_[channel];
+        pos = (pos == 0 ? ntaps_ : pos) - 1;
+
+        double *reg = pregisters_[channel] + pos;
+        reg[0] = input;
+        reg[ntaps_] = input;
+
+        return reg;
+    }
+
+    inline float *push_sample(float input, unsigned int channel) {
+        unsigned int &pos = fpositions_[channel];
+        pos = (pos == 0 ? ntaps_ : pos) - 1;
+
+        float *reg = pfregisters_[channel] + pos;
+        reg[0] = input;
+        reg[ntaps_] = input;
+
+        return reg;
+    }
+
+    // add sample to delay line of channel and compute filter output
+    inline double filter_sample(double input, unsigned int channel) {
+        return simd::dot(pcoefficients_, push_sample(input, channel), ntaps_);
+    }
+
+    inline float filter_sample(float input, unsigned int channel) {
+        return simd::dot(fcoefficients_.data(), push_sample(input, channel),
+                         ntaps_);
+    }
+
+    std::size_t fft_size(uint64_t nsamples) const;
+    bool use_fft(uint64_t nsamples) const;
+
+    // overlap-save convolution of nsamples of channel (and channel + 1 if
+    // pair is true, using the imaginary part of the transform). Samples are
+    // read and written with a stride, such that interleaved data can be
+    // processed in place.
+    void process_block(uint64_t nsamples, const double *input, double *output,
+                       std::size_t stride, unsigned int channel, bool pair);
+    void prepare_block(uint64_t nsamples);
+
   protected:
     std::vector<double> coefficients_;
     double *pcoefficients_;
     unsigned int ntaps_;
 
+    unsigned int fft_threshold_ = DEFAULT_FFT_THRESHOLD;
+
+    // overlap-save state, sized for the bucket length seen most recently
+    std::unique_ptr<fft::FFT> fft_;
+    std::size_t block_size_ = 0; // new samples per transform
+    std::vector<std::complex<double>> spectrum_; // scaled filter spectrum
+    std::vector<std::complex<double>> workspace_;
+    std::vector<double> history_;
+
+    // Each channel has a circular delay line of twice the number of taps.
+    // Every sample is stored at positions pos and pos + ntaps_, such that the
+    // most recent ntaps_ samples are always available as a contiguous block
+    // starting at pos (newest sample first) and no shifting is needed.
     std::vector<std::vector<double>> registers_;
     std::vector<double *> pregisters_;
+    std::vector<unsigned int> positions_;
+
+    // separate single precision coefficients and delay lines
+    std::vector<float> fcoefficients_;
+    std::vector<std::vector<float>> fregisters_;
+    std::vector<float *> pfregisters_;
+    std::vector<unsigned int> fpositions_;
 
-    double *preg_;
+  public:
+    static constexpr unsigned int DEFAULT_FFT_THRESHOLD = 0;
+    static constexpr uint64_t MIN_FFT_BLOCK_SIZE = 32;
+    // relative cost of the transforms per n*log2(n), measured against the
+    // AVX-512 direct form
+    static constexpr double FFT_COST = 16.0;
 };
 
 class SlopeFilter : public FirFilter {
@@ -182,7 +281,10 @@ class SlopeFilter : public FirFilter {
                                    std::string description, bool binary);
 
     virtual IFilter *clone() {
-        return new SlopeFilter(window_size_, order_, derivative_order_);
+        auto filter =
+            new SlopeFilter(window_size_, order_, derivative_order_);
+        filter->set_fft_threshold(fft_threshold_);
+        return filter;
     };
 
   protected:
@@ -212,10 +314,11 @@ class BiquadFilter : public IFilter {
 
     // all channels, single sample
     void process_sample(std::vector<double> &input,
-                        std::vector<double> &output) final {};
+                        std::vector<double> &output) final;
     void process_sample(std::vector<double>::iterator input,
                         std::vector<double>::iterator output) final;
     void process_sample(double *input, double *output) final;
+    void process_sample(float *input, float *output) final;
 
     // single channel, multiple samples
     void process_channel(std::vector<double> &input,
@@ -243,6 +346,11 @@ class BiquadFilter : public IFilter {
     virtual void process_by_sample(uint64_t nsamples,
                                    std::vector<double> &input,
                                    std::vector<double> &output);
+    void process_by_channel(uint64_t nsamples, double *input,
+                            double *output) final;
+    // single precision data, the filter state remains in double precision
+    void process_by_channel(uint64_t nsamples, float *input,
+                            float *output) final;
 
   protected:
     bool realize_filter(unsigned int nchannels, double init = 0.0) final;
@@ -254,7 +362,9 @@ class BiquadFilter : public IFilter {
 
     unsigned int nstages_;
 
-    std::vector<std::vector<std::array<double, 2>>> registers_;
+    // delay registers stored as structure of arrays (see simd::biquad), so
+    // that groups of channels can be processed in SIMD lanes
+    std::vector<double> registers_;
 };
 
 std::map<std::string, std::string> parse_file_header(std::istream &stream);
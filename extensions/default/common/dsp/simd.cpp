@@ -0,0 +1,550 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "simd.hpp"
+
+#include <immintrin.h>
+
+using namespace dsp::simd;
+
+namespace {
+
+double dot_scalar(const double *a, const double *b, std::size_t n) {
+    double result = 0.0;
+    for (std::size_t k = 0; k < n; ++k) {
+        result += a[k] * b[k];
+    }
+    return result;
+}
+
+__attribute__((target("avx2,fma"))) double
+dot_avx2(const double *a, const double *b, std::size_t n) {
+    // two independent accumulators to hide the latency of the fma
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+
+    std::size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k),
+                               acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k + 4),
+                               _mm256_loadu_pd(b + k + 4), acc1);
+    }
+    if (k + 4 <= n) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k),
+                               acc0);
+        k += 4;
+    }
+
+    acc0 = _mm256_add_pd(acc0, acc1);
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(acc0),
+                             _mm256_extractf128_pd(acc0, 1));
+    sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+
+    double result = _mm_cvtsd_f64(sum);
+    for (; k < n; ++k) {
+        result += a[k] * b[k];
+    }
+    return result;
+}
+
+__attribute__((target("avx512f"))) double
+dot_avx512(const double *a, const double *b, std::size_t n) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+
+    std::size_t k = 0;
+    for (; k + 16 <= n; k += 16) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + k), _mm512_loadu_pd(b + k),
+                               acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + k + 8),
+                               _mm512_loadu_pd(b + k + 8), acc1);
+    }
+    if (k + 8 <= n) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + k), _mm512_loadu_pd(b + k),
+                               acc0);
+        k += 8;
+    }
+    if (k < n) {
+        // masked load of the remaining (less than 8) elements
+        __mmask8 mask = static_cast<__mmask8>((1u << (n - k)) - 1);
+        acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + k),
+                               _mm512_maskz_loadu_pd(mask, b + k), acc1);
+    }
+
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, _mm512_add_pd(acc0, acc1));
+
+    return ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) +
+           ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+}
+
+float dot_float_scalar(const float *a, const float *b, std::size_t n) {
+    float result = 0.0f;
+    for (std::size_t k = 0; k < n; ++k) {
+        result += a[k] * b[k];
+    }
+    return result;
+}
+
+__attribute__((target("avx2,fma"))) float
+dot_float_avx2(const float *a, const float *b, std::size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    std::size_t k = 0;
+    for (; k + 16 <= n; k += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + k), _mm256_loadu_ps(b + k),
+                               acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + k + 8),
+                               _mm256_loadu_ps(b + k + 8), acc1);
+    }
+    if (k + 8 <= n) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + k), _mm256_loadu_ps(b + k),
+                               acc0);
+        k += 8;
+    }
+
+    acc0 = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc0),
+                            _mm256_extractf128_ps(acc0, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+
+    float result = _mm_cvtss_f32(sum);
+    for (; k < n; ++k) {
+        result += a[k] * b[k];
+    }
+    return result;
+}
+
+__attribute__((target("avx512f"))) float
+dot_float_avx512(const float *a, const float *b, std::size_t n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+
+    std::size_t k = 0;
+    for (; k + 32 <= n; k += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + k), _mm512_loadu_ps(b + k),
+                               acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + k + 16),
+                               _mm512_loadu_ps(b + k + 16), acc1);
+    }
+    if (k + 16 <= n) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + k), _mm512_loadu_ps(b + k),
+                               acc0);
+        k += 16;
+    }
+    if (k < n) {
+        // masked load of the remaining (less than 16) elements
+        __mmask16 mask = static_cast<__mmask16>((1u << (n - k)) - 1);
+        acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + k),
+                               _mm512_maskz_loadu_ps(mask, b + k), acc1);
+    }
+
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, _mm512_add_ps(acc0, acc1));
+
+    float result = 0.0f;
+    for (unsigned int k = 0; k < 8; ++k) {
+        result += lanes[k] + lanes[k + 8];
+    }
+    return result;
+}
+
+void biquad_scalar(const double *coefficients, unsigned int nstages,
+                   double gain, double *state, unsigned int nchannels,
+                   const double *input, double *output, std::size_t nsamples,
+                   unsigned int first_channel = 0) {
+    for (std::size_t n = 0; n < nsamples; ++n) {
+        for (unsigned int c = first_channel; c < nchannels; ++c) {
+            output[c] = biquad_channel(coefficients, nstages, gain, state + c,
+                                       nchannels, input[c]);
+        }
+        input += nchannels;
+        output += nchannels;
+    }
+}
+
+void biquad_scalar_all(const double *coefficients, unsigned int nstages,
+                       double gain, double *state, unsigned int nchannels,
+                       const double *input, double *output,
+                       std::size_t nsamples) {
+    biquad_scalar(coefficients, nstages, gain, state, nchannels, input, output,
+                  nsamples);
+}
+
+// The vectorized biquad kernels process one stage at a time for all samples
+// of a group of channels, such that the delay registers and coefficients of
+// the stage stay in vector registers. Explicit multiply and add/subtract
+// intrinsics are used (no fused multiply-add) in the same order as the scalar
+// code to guarantee identical results. The kernels process all complete groups
+// of channels, starting at first_channel, and return the index of the first
+// channel that was not processed.
+
+__attribute__((target("avx2"))) unsigned int
+biquad_groups_avx2(const double *coefficients, unsigned int nstages,
+                   double gain, double *state, unsigned int nchannels,
+                   const double *input, double *output, std::size_t nsamples,
+                   unsigned int first_channel) {
+    constexpr unsigned int LANES = 4;
+    const __m256d g = _mm256_set1_pd(gain);
+
+    unsigned int c0 = first_channel;
+    for (; c0 + LANES <= nchannels; c0 += LANES) {
+        for (unsigned int s = 0; s < nstages; ++s) {
+            const double *c = coefficients + 6 * s;
+            const __m256d b0 = _mm256_set1_pd(c[0]);
+            const __m256d b1 = _mm256_set1_pd(c[1]);
+            const __m256d b2 = _mm256_set1_pd(c[2]);
+            const __m256d a1 = _mm256_set1_pd(c[4]);
+            const __m256d a2 = _mm256_set1_pd(c[5]);
+
+            double *pr0 = state + 2 * s * nchannels + c0;
+            double *pr1 = state + (2 * s + 1) * nchannels + c0;
+            __m256d r0 = _mm256_loadu_pd(pr0);
+            __m256d r1 = _mm256_loadu_pd(pr1);
+
+            const double *src = (s == 0 ? input : output) + c0;
+            double *dst = output + c0;
+
+            for (std::size_t n = 0; n < nsamples; ++n) {
+                __m256d x = _mm256_loadu_pd(src);
+                __m256d u = _mm256_sub_pd(
+                    _mm256_sub_pd(x, _mm256_mul_pd(a1, r0)),
+                    _mm256_mul_pd(a2, r1));
+                __m256d y = _mm256_add_pd(
+                    _mm256_add_pd(_mm256_mul_pd(b0, u), _mm256_mul_pd(b1, r0)),
+                    _mm256_mul_pd(b2, r1));
+                r1 = r0;
+                r0 = u;
+                _mm256_storeu_pd(dst, y);
+                src += nchannels;
+                dst += nchannels;
+            }
+
+            _mm256_storeu_pd(pr0, r0);
+            _mm256_storeu_pd(pr1, r1);
+        }
+
+        double *dst = output + c0;
+        for (std::size_t n = 0; n < nsamples; ++n) {
+            _mm256_storeu_pd(dst, _mm256_mul_pd(_mm256_loadu_pd(dst), g));
+            dst += nchannels;
+        }
+    }
+
+    return c0;
+}
+
+// AVX-512 implies FMA support, so contraction of the separate multiply and
+// add intrinsics into fused operations is explicitly disabled
+__attribute__((target("avx512f"), optimize("fp-contract=off"))) unsigned int
+biquad_groups_avx512(const double *coefficients, unsigned int nstages,
+                     double gain, double *state, unsigned int nchannels,
+                     const double *input, double *output, std::size_t nsamples,
+                     unsigned int first_channel) {
+    constexpr unsigned int LANES = 8;
+    const __m512d g = _mm512_set1_pd(gain);
+
+    unsigned int c0 = first_channel;
+    for (; c0 + LANES <= nchannels; c0 += LANES) {
+        for (unsigned int s = 0; s < nstages; ++s) {
+            const double *c = coefficients + 6 * s;
+            const __m512d b0 = _mm512_set1_pd(c[0]);
+            const __m512d b1 = _mm512_set1_pd(c[1]);
+            const __m512d b2 = _mm512_set1_pd(c[2]);
+            const __m512d a1 = _mm512_set1_pd(c[4]);
+            const __m512d a2 = _mm512_set1_pd(c[5]);
+
+            double *pr0 = state + 2 * s * nchannels + c0;
+            double *pr1 = state + (2 * s + 1) * nchannels + c0;
+            __m512d r0 = _mm512_loadu_pd(pr0);
+            __m512d r1 = _mm512_loadu_pd(pr1);
+
+            const double *src = (s == 0 ? input : output) + c0;
+            double *dst = output + c0;
+
+            for (std::size_t n = 0; n < nsamples; ++n) {
+                __m512d x = _mm512_loadu_pd(src);
+                __m512d u = _mm512_sub_pd(
+                    _mm512_sub_pd(x, _mm512_mul_pd(a1, r0)),
+                    _mm512_mul_pd(a2, r1));
+                __m512d y = _mm512_add_pd(
+                    _mm512_add_pd(_mm512_mul_pd(b0, u), _mm512_mul_pd(b1, r0)),
+                    _mm512_mul_pd(b2, r1));
+                r1 = r0;
+                r0 = u;
+                _mm512_storeu_pd(dst, y);
+                src += nchannels;
+                dst += nchannels;
+            }
+
+            _mm512_storeu_pd(pr0, r0);
+            _mm512_storeu_pd(pr1, r1);
+        }
+
+        double *dst = output + c0;
+        for (std::size_t n = 0; n < nsamples; ++n) {
+            _mm512_storeu_pd(dst, _mm512_mul_pd(_mm512_loadu_pd(dst), g));
+            dst += nchannels;
+        }
+    }
+
+    return c0;
+}
+
+void biquad_avx2(const double *coefficients, unsigned int nstages, double gain,
+                 double *state, unsigned int nchannels, const double *input,
+                 double *output, std::size_t nsamples) {
+    unsigned int c = biquad_groups_avx2(coefficients, nstages, gain, state,
+                                        nchannels, input, output, nsamples, 0);
+    biquad_scalar(coefficients, nstages, gain, state, nchannels, input, output,
+                  nsamples, c);
+}
+
+void biquad_avx512(const double *coefficients, unsigned int nstages,
+                   double gain, double *state, unsigned int nchannels,
+                   const double *input, double *output, std::size_t nsamples) {
+    unsigned int c = biquad_groups_avx512(
+        coefficients, nstages, gain, state, nchannels, input, output, nsamples,
+        0);
+    c = biquad_groups_avx2(coefficients, nstages, gain, state, nchannels,
+                           input, output, nsamples, c);
+    biquad_scalar(coefficients, nstages, gain, state, nchannels, input, output,
+                  nsamples, c);
+}
+
+// Single precision biquad kernels. Samples are converted to double precision
+// on load and all stages are applied before the next sample is loaded, with
+// the state read from and written to memory for every stage. The order of
+// operations is the same as in biquad_channel, so that results are identical
+// to the scalar implementation.
+
+void biquad_float_scalar(const double *coefficients, unsigned int nstages,
+                         double gain, double *state, unsigned int nchannels,
+                         const float *input, float *output,
+                         std::size_t nsamples, unsigned int first_channel = 0) {
+    for (std::size_t n = 0; n < nsamples; ++n) {
+        for (unsigned int c = first_channel; c < nchannels; ++c) {
+            output[c] = static_cast<float>(
+                biquad_channel(coefficients, nstages, gain, state + c,
+                               nchannels, static_cast<double>(input[c])));
+        }
+        input += nchannels;
+        output += nchannels;
+    }
+}
+
+void biquad_float_scalar_all(const double *coefficients, unsigned int nstages,
+                             double gain, double *state,
+                             unsigned int nchannels, const float *input,
+                             float *output, std::size_t nsamples) {
+    biquad_float_scalar(coefficients, nstages, gain, state, nchannels, input,
+                        output, nsamples);
+}
+
+__attribute__((target("avx2"))) unsigned int
+biquad_float_groups_avx2(const double *coefficients, unsigned int nstages,
+                         double gain, double *state, unsigned int nchannels,
+                         const float *input, float *output,
+                         std::size_t nsamples, unsigned int first_channel) {
+    constexpr unsigned int LANES = 4;
+    const __m256d g = _mm256_set1_pd(gain);
+
+    unsigned int c0 = first_channel;
+    for (; c0 + LANES <= nchannels; c0 += LANES) {
+        const float *src = input + c0;
+        float *dst = output + c0;
+
+        for (std::size_t n = 0; n < nsamples; ++n) {
+            __m256d x = _mm256_cvtps_pd(_mm_loadu_ps(src));
+
+            for (unsigned int s = 0; s < nstages; ++s) {
+                const double *c = coefficients + 6 * s;
+                double *pr0 = state + 2 * s * nchannels + c0;
+                double *pr1 = state + (2 * s + 1) * nchannels + c0;
+                __m256d r0 = _mm256_loadu_pd(pr0);
+                __m256d r1 = _mm256_loadu_pd(pr1);
+
+                __m256d u = _mm256_sub_pd(
+                    _mm256_sub_pd(x, _mm256_mul_pd(_mm256_set1_pd(c[4]), r0)),
+                    _mm256_mul_pd(_mm256_set1_pd(c[5]), r1));
+                x = _mm256_add_pd(
+                    _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(c[0]), u),
+                                  _mm256_mul_pd(_mm256_set1_pd(c[1]), r0)),
+                    _mm256_mul_pd(_mm256_set1_pd(c[2]), r1));
+
+                _mm256_storeu_pd(pr1, r0);
+                _mm256_storeu_pd(pr0, u);
+            }
+
+            _mm_storeu_ps(dst, _mm256_cvtpd_ps(_mm256_mul_pd(x, g)));
+            src += nchannels;
+            dst += nchannels;
+        }
+    }
+
+    return c0;
+}
+
+__attribute__((target("avx512f"), optimize("fp-contract=off"))) unsigned int
+biquad_float_groups_avx512(const double *coefficients, unsigned int nstages,
+                           double gain, double *state, unsigned int nchannels,
+                           const float *input, float *output,
+                           std::size_t nsamples, unsigned int first_channel) {
+    constexpr unsigned int LANES = 8;
+    const __m512d g = _mm512_set1_pd(gain);
+
+    unsigned int c0 = first_channel;
+    for (; c0 + LANES <= nchannels; c0 += LANES) {
+        const float *src = input + c0;
+        float *dst = output + c0;
+
+        for (std::size_t n = 0; n < nsamples; ++n) {
+            // zero-masked conversions avoid the undefined source operand of
+            // the plain intrinsics, which trips -Wmaybe-uninitialized
+            __m512d x = _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(src));
+
+            for (unsigned int s = 0; s < nstages; ++s) {
+                const double *c = coefficients + 6 * s;
+                double *pr0 = state + 2 * s * nchannels + c0;
+                double *pr1 = state + (2 * s + 1) * nchannels + c0;
+                __m512d r0 = _mm512_loadu_pd(pr0);
+                __m512d r1 = _mm512_loadu_pd(pr1);
+
+                __m512d u = _mm512_sub_pd(
+                    _mm512_sub_pd(x, _mm512_mul_pd(_mm512_set1_pd(c[4]), r0)),
+                    _mm512_mul_pd(_mm512_set1_pd(c[5]), r1));
+                x = _mm512_add_pd(
+                    _mm512_add_pd(_mm512_mul_pd(_mm512_set1_pd(c[0]), u),
+                                  _mm512_mul_pd(_mm512_set1_pd(c[1]), r0)),
+                    _mm512_mul_pd(_mm512_set1_pd(c[2]), r1));
+
+                _mm512_storeu_pd(pr1, r0);
+                _mm512_storeu_pd(pr0, u);
+            }
+
+            _mm256_storeu_ps(dst,
+                             _mm512_maskz_cvtpd_ps(0xff, _mm512_mul_pd(x, g)));
+            src += nchannels;
+            dst += nchannels;
+        }
+    }
+
+    return c0;
+}
+
+void biquad_float_avx2(const double *coefficients, unsigned int nstages,
+                       double gain, double *state, unsigned int nchannels,
+                       const float *input, float *output,
+                       std::size_t nsamples) {
+    unsigned int c = biquad_float_groups_avx2(
+        coefficients, nstages, gain, state, nchannels, input, output, nsamples,
+        0);
+    biquad_float_scalar(coefficients, nstages, gain, state, nchannels, input,
+                        output, nsamples, c);
+}
+
+void biquad_float_avx512(const double *coefficients, unsigned int nstages,
+                         double gain, double *state, unsigned int nchannels,
+                         const float *input, float *output,
+                         std::size_t nsamples) {
+    unsigned int c = biquad_float_groups_avx512(
+        coefficients, nstages, gain, state, nchannels, input, output, nsamples,
+        0);
+    c = biquad_float_groups_avx2(coefficients, nstages, gain, state, nchannels,
+                                 input, output, nsamples, c);
+    biquad_float_scalar(coefficients, nstages, gain, state, nchannels, input,
+                        output, nsamples, c);
+}
+
+InstructionSet detect() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return InstructionSet::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return InstructionSet::AVX2;
+    }
+    return InstructionSet::SCALAR;
+}
+
+InstructionSet current_iset = InstructionSet::SCALAR;
+
+} // namespace
+
+// scalar kernels are used until the dispatcher below has run
+DotFunction dsp::simd::internal::dot = &dot_scalar;
+DotFloatFunction dsp::simd::internal::dot_float = &dot_float_scalar;
+BiquadFunction dsp::simd::internal::biquad = &biquad_scalar_all;
+BiquadFloatFunction dsp::simd::internal::biquad_float =
+    &biquad_float_scalar_all;
+
+namespace {
+const InstructionSet initial_iset = set_instruction_set(detect());
+} // namespace
+
+std::string dsp::simd::instruction_set_to_string(InstructionSet iset) {
+    switch (iset) {
+    case InstructionSet::AVX512:
+        return "avx512";
+    case InstructionSet::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+InstructionSet dsp::simd::detected_instruction_set() {
+    static const InstructionSet iset = detect();
+    return iset;
+}
+
+InstructionSet dsp::simd::instruction_set() { return current_iset; }
+
+InstructionSet dsp::simd::set_instruction_set(InstructionSet iset) {
+    if (iset > detected_instruction_set()) {
+        iset = detected_instruction_set();
+    }
+
+    switch (iset) {
+    case InstructionSet::AVX512:
+        internal::dot = &dot_avx512;
+        internal::dot_float = &dot_float_avx512;
+        internal::biquad = &biquad_avx512;
+        internal::biquad_float = &biquad_float_avx512;
+        break;
+    case InstructionSet::AVX2:
+        internal::dot = &dot_avx2;
+        internal::dot_float = &dot_float_avx2;
+        internal::biquad = &biquad_avx2;
+        internal::biquad_float = &biquad_float_avx2;
+        break;
+    default:
+        internal::dot = &dot_scalar;
+        internal::dot_float = &dot_float_scalar;
+        internal::biquad = &biquad_scalar_all;
+        internal::biquad_float = &biquad_float_scalar_all;
+        break;
+    }
+
+    current_iset = iset;
+    return iset;
+}
@@ -0,0 +1,123 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace dsp {
+namespace simd {
+
+// Instruction sets for which vectorized kernels are available. The best
+// instruction set supported by the CPU is selected at program start-up, so
+// that the library can be compiled without architecture specific flags.
+enum class InstructionSet { SCALAR = 0, AVX2, AVX512 };
+
+std::string instruction_set_to_string(InstructionSet iset);
+
+// instruction set that is supported by the CPU
+InstructionSet detected_instruction_set();
+
+// instruction set that is currently used by the kernels
+InstructionSet instruction_set();
+
+// select the kernels for a given instruction set. Requests for an instruction
+// set that is not supported by the CPU fall back to the best supported one.
+// Returns the instruction set that is actually used.
+InstructionSet set_instruction_set(InstructionSet iset);
+
+using DotFunction = double (*)(const double *, const double *, std::size_t);
+using DotFloatFunction = float (*)(const float *, const float *, std::size_t);
+using BiquadFunction = void (*)(const double *, unsigned int, double,
+                                double *, unsigned int, const double *,
+                                double *, std::size_t);
+using BiquadFloatFunction = void (*)(const double *, unsigned int, double,
+                                     double *, unsigned int, const float *,
+                                     float *, std::size_t);
+
+namespace internal {
+extern DotFunction dot;
+extern DotFloatFunction dot_float;
+extern BiquadFunction biquad;
+extern BiquadFloatFunction biquad_float;
+} // namespace internal
+
+// inner product of two vectors of length n (no alignment requirements)
+inline double dot(const double *a, const double *b, std::size_t n) {
+    return internal::dot(a, b, n);
+}
+
+// single precision inner product, with twice as many lanes per vector
+inline float dot(const float *a, const float *b, std::size_t n) {
+    return internal::dot_float(a, b, n);
+}
+
+// Cascade of second-order sections (direct form II) applied to nsamples of
+// interleaved (sample-major) data with nchannels values per sample.
+// Coefficients are given as nstages x [b0, b1, b2, a0, a1, a2] and the filter
+// state is stored as structure of arrays, i.e. the k-th delay register (k = 0
+// or 1) of a stage for all channels is found at
+// state[(2 * stage + k) * nchannels + channel]. Groups of 4 (AVX2) or 8
+// (AVX-512) channels are processed in parallel and the remaining channels
+// with scalar code. The order of operations is identical for each lane, so
+// that the result is bit-exact with the scalar implementation.
+inline void biquad(const double *coefficients, unsigned int nstages,
+                   double gain, double *state, unsigned int nchannels,
+                   const double *input, double *output, std::size_t nsamples) {
+    internal::biquad(coefficients, nstages, gain, state, nchannels, input,
+                     output, nsamples);
+}
+
+// Biquad cascade for single precision input and output. The filter state and
+// all arithmetic remain in double precision, as recursive filters with poles
+// close to the unit circle are not stable with single precision registers.
+// Samples are converted on load and store, and all stages are applied to a
+// sample before the next one, so that no intermediate results are rounded.
+inline void biquad(const double *coefficients, unsigned int nstages,
+                   double gain, double *state, unsigned int nchannels,
+                   const float *input, float *output, std::size_t nsamples) {
+    internal::biquad_float(coefficients, nstages, gain, state, nchannels,
+                           input, output, nsamples);
+}
+
+// process single sample of single channel through biquad cascade, using the
+// same state layout as above
+inline double biquad_channel(const double *coefficients, unsigned int nstages,
+                             double gain, double *state, unsigned int nchannels,
+                             double x) {
+    double u_n, y_n = 0.0;
+
+    for (unsigned int s = 0; s < nstages; ++s) {
+        const double *c = coefficients + 6 * s;
+        double &r0 = state[2 * s * nchannels];
+        double &r1 = state[(2 * s + 1) * nchannels];
+
+        u_n = x - c[4] * r0 - c[5] * r1;
+        y_n = c[0] * u_n + c[1] * r0 + c[2] * r1;
+        r1 = r0;
+        r0 = u_n;
+        x = y_n;
+    }
+
+    return y_n * gain;
+}
+
+} // namespace simd
+} // namespace dsp
@@ -20,10 +20,166 @@
 #include "nlx.hpp"
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include <immintrin.h>
 
 using namespace nlx;
 
+namespace {
+
+// Digilynx data is sent with the bytes of each 16-bit half swapped
+inline uint32_t swap_halves(uint32_t w) {
+    return ((w << 8) & 0xFF00FF00) | ((w >> 8) & 0x00FF00FF);
+}
+
+// Copy nfields 32-bit fields from a network buffer (optionally swapping the
+// bytes) and return the XOR of all but the last (CRC) field.
+template <bool SWAP>
+int32_t copy_fields_scalar(const char *src, int32_t *dst, unsigned int nfields,
+                           unsigned int k = 0, uint32_t crc = 0) {
+    for (; k < nfields; ++k) {
+        uint32_t w;
+        memcpy(&w, src + k * NLX_FIELDBYTESIZE, sizeof(w));
+        if (SWAP) {
+            w = swap_halves(w);
+        }
+        dst[k] = static_cast<int32_t>(w);
+        if (k + 1 < nfields) {
+            crc ^= w;
+        }
+    }
+    return static_cast<int32_t>(crc);
+}
+
+template <bool SWAP>
+__attribute__((target("avx2"))) int32_t
+copy_fields_avx2(const char *src, int32_t *dst, unsigned int nfields) {
+    const __m256i shuffle =
+        _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                         1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    __m256i acc = _mm256_setzero_si256();
+
+    // copy, swap and accumulate the CRC 8 fields at a time, the CRC field
+    // itself is never part of a full vector
+    unsigned int k = 0;
+    for (; k + 8 < nfields; k += 8) {
+        __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(src + k * NLX_FIELDBYTESIZE));
+        if (SWAP) {
+            v = _mm256_shuffle_epi8(v, shuffle);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + k), v);
+        acc = _mm256_xor_si256(acc, v);
+    }
+
+    __m128i x = _mm_xor_si128(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+    x = _mm_xor_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm_xor_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return copy_fields_scalar<SWAP>(src, dst, nfields, k,
+                                    static_cast<uint32_t>(_mm_cvtsi128_si32(x)));
+}
+
+int32_t xor_fields_scalar(const int32_t *p, unsigned int n) {
+    int32_t c = 0;
+    for (unsigned int k = 0; k < n; ++k) {
+        c ^= p[k];
+    }
+    return c;
+}
+
+__attribute__((target("avx2"))) int32_t xor_fields_avx2(const int32_t *p,
+                                                        unsigned int n) {
+    __m256i acc = _mm256_setzero_si256();
+    unsigned int k = 0;
+    for (; k + 8 <= n; k += 8) {
+        acc = _mm256_xor_si256(
+            acc, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + k)));
+    }
+    __m128i x = _mm_xor_si128(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+    x = _mm_xor_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm_xor_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(x) ^ xor_fields_scalar(p + k, n - k);
+}
+
+// conversion of an AD value to the output type: microvolts for floating
+// point types, the AD value saturated to the int16 range for int16
+template <typename T> inline T to_sample(int32_t value) {
+    return static_cast<T>(static_cast<double>(value * NLX_AD_BIT_MICROVOLTS));
+}
+
+template <> inline int16_t to_sample<int16_t>(int32_t value) {
+    return static_cast<int16_t>(
+        std::clamp<int32_t>(value, std::numeric_limits<int16_t>::lowest(),
+                            std::numeric_limits<int16_t>::max()));
+}
+
+template <typename T>
+void gather_scalar(const int32_t *data, const unsigned int *channels,
+                   std::size_t n, T *out, std::size_t k = 0) {
+    for (; k < n; ++k) {
+        out[k] = to_sample<T>(data[channels[k]]);
+    }
+}
+
+// Gathers 4 channels at a time and converts them in double precision (or
+// packs them with saturation for int16), so that the results are bit-exact
+// with the scalar conversion. Runs of
+// consecutive channels (the common case for channel groups) are loaded
+// directly, as gather instructions are slow on many CPUs.
+template <typename T>
+__attribute__((target("avx2"))) void
+gather_avx2(const int32_t *data, const unsigned int *channels, std::size_t n,
+            T *out) {
+    const __m128i consecutive = _mm_setr_epi32(0, 1, 2, 3);
+    const __m256d scale = _mm256_set1_pd(NLX_AD_BIT_MICROVOLTS);
+
+    std::size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m128i index = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(channels + k));
+        __m128i samples;
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(
+                index, _mm_add_epi32(_mm_set1_epi32(channels[k]),
+                                     consecutive))) == 0xffff) {
+            samples = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(data + channels[k]));
+        } else {
+            samples = _mm_i32gather_epi32(data, index, 4);
+        }
+
+        if constexpr (std::is_same<T, int16_t>::value) {
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out + k),
+                             _mm_packs_epi32(samples, samples));
+        } else {
+            __m256d v = _mm256_mul_pd(_mm256_cvtepi32_pd(samples), scale);
+            if constexpr (std::is_same<T, double>::value) {
+                _mm256_storeu_pd(out + k, v);
+            } else {
+                _mm_storeu_ps(out + k, _mm256_cvtpd_ps(v));
+            }
+        }
+    }
+
+    gather_scalar(data, channels, n, out, k);
+}
+
+bool use_avx2() {
+    static const bool avx2 = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return avx2;
+}
+
+} // namespace
+
 bool valid_nlx_vt(VideoRec *vt_record, std::uint16_t vt_id,
                   ErrorNLXVT::Code &error_code,
                   decltype(NLX_VIDEO_RESOLUTION) resolution) {
@@ -85,22 +241,29 @@ int NlxSignalRecord::FromNetworkBuffer(const char *buffer, size_t n) {
         return ERROR_TOO_SMALL_PACKET;
     }
 
-    std::copy(buffer, buffer + n, (char *)buffer_.data());
-
-    std::uint32_t tmp =
-        ((NLX_STX << 8) & 0xFF00FF00) | ((NLX_STX >> 8) & 0xFF00FF);
+    int32_t stx;
+    memcpy(&stx, buffer, sizeof(stx));
+    bool swap = static_cast<uint32_t>(stx) == swap_halves(NLX_STX);
+    if (swap) {
+        set_convert_byte_order(true);
+    }
 
-    if (buffer_[NLX_FIELD_STX] == tmp) {
-        char *p = (char *)buffer_.data();
-        for (unsigned int k = 0; k < n; k += 2) {
-            set_convert_byte_order(true);
-            *((uint16_t *)(p + k)) = ntohs(*((uint16_t *)(buffer + k)));
-        }
+    // copy (and swap) the packet and compute its CRC in a single pass
+    int32_t c;
+    if (use_avx2()) {
+        c = swap ? copy_fields_avx2<true>(buffer, buffer_.data(), nlx_nfields_)
+                 : copy_fields_avx2<false>(buffer, buffer_.data(),
+                                           nlx_nfields_);
+    } else {
+        c = swap ? copy_fields_scalar<true>(buffer, buffer_.data(),
+                                            nlx_nfields_)
+                 : copy_fields_scalar<false>(buffer, buffer_.data(),
+                                             nlx_nfields_);
     }
 
     // test if valid record (record size os OK, first 3 fields are OK, CRC
     // checks out)
-    return valid(buffer_);
+    return validate(c);
 }
 
 size_t NlxSignalRecord::ToNetworkBuffer(char *buffer, size_t n) {
@@ -142,11 +305,10 @@ void NlxSignalRecord::Finalize() {
 }
 
 int32_t NlxSignalRecord::crc() const {
-    int32_t c = 0;
-    for (unsigned int k = 0; k < nlx_nfields_ - 1; ++k) {
-        c ^= buffer_[k];
+    if (use_avx2()) {
+        return xor_fields_avx2(buffer_.data(), nlx_nfields_ - 1);
     }
-    return c;
+    return xor_fields_scalar(buffer_.data(), nlx_nfields_ - 1);
 }
 
 bool NlxSignalRecord::initialized() const { return initialized_; }
@@ -177,6 +339,29 @@ int NlxSignalRecord::valid(std::vector<int32_t> buffer) {
     return SUCCESS_READING_BUFFER;
 }
 
+int NlxSignalRecord::validate(int32_t crc) {
+    if (buffer_[NLX_FIELD_STX] != NLX_STX) {
+        initialized_ = false;
+        return ERROR_NLX_FIELD_STX;
+    } else if (buffer_[NLX_FIELD_RAWPACKETID] != NLX_RAWPACKETID) {
+        initialized_ = false;
+        return ERROR_NLX_FIELD_RAWPACKETID;
+    } else if (buffer_[NLX_FIELD_PACKETSIZE] != nlx_packetsize_) {
+        initialized_ = false;
+        return ERROR_NLX_FIELD_PACKETSIZE;
+    }
+
+    if (buffer_[nlx_field_crc_] != crc) {
+        finalized_ = false;
+        return ERROR_BAD_CRC;
+    }
+
+    initialized_ = true;
+    finalized_ = true;
+
+    return SUCCESS_READING_BUFFER;
+}
+
 uint64_t NlxSignalRecord::timestamp() const {
     uint64_t t;
     t = (uint32_t)buffer_[NLX_FIELD_TIMESTAMP_HIGH];
@@ -260,6 +445,34 @@ double NlxSignalRecord::sample_microvolt(unsigned int index) const {
                                NLX_AD_BIT_MICROVOLTS);
 }
 
+template <typename T>
+void NlxSignalRecord::samples_microvolt(const unsigned int *channels,
+                                        std::size_t n, T *out) const {
+    const int32_t *data = buffer_.data() + NLX_FIELD_DATA_FIRST;
+    if (use_avx2()) {
+        gather_avx2(data, channels, n, out);
+    } else {
+        gather_scalar(data, channels, n, out);
+    }
+}
+
+void NlxSignalRecord::samples_adbits(const unsigned int *channels,
+                                     std::size_t n, int16_t *out) const {
+    const int32_t *data = buffer_.data() + NLX_FIELD_DATA_FIRST;
+    if (use_avx2()) {
+        gather_avx2(data, channels, n, out);
+    } else {
+        gather_scalar(data, channels, n, out);
+    }
+}
+
+template void NlxSignalRecord::samples_microvolt<double>(const unsigned int *,
+                                                         std::size_t,
+                                                         double *) const;
+template void NlxSignalRecord::samples_microvolt<float>(const unsigned int *,
+                                                        std::size_t,
+                                                        float *) const;
+
 void NlxSignalRecord::set_data(double value) {
     int32_t v = static_cast<int32_t>(value / NLX_AD_BIT_MICROVOLTS);
     std::fill(data_begin(), data_end(), v);
@@ -23,8 +23,10 @@
 
 #include <array>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <type_traits>
 #include <vector>
 
 namespace nlx {
@@ -75,6 +77,13 @@ constexpr uint16_t NLX_FIELD_DATA_FIRST =
     NLX_FIELD_EXTRA_FIRST + NLX_NFIELDS_EXTRA;
 
 constexpr double NLX_AD_BIT_MICROVOLTS = 0.015624999960550667;
+
+// value of one unit of the samples in a stream of element type T (see
+// NlxSignalRecord::samples): int16 streams hold raw AD values, with a range
+// of about +/- 512 uV, floating point streams hold microvolts
+template <typename T> constexpr double sample_scale() {
+    return std::is_integral<T>::value ? NLX_AD_BIT_MICROVOLTS : 1.0;
+}
 constexpr int32_t NLX_STX = 2048;
 constexpr int32_t NLX_RAWPACKETID = 1;
 constexpr uint16_t NLX_DEFAULT_NCHANNELS = 128;
@@ -217,6 +226,30 @@ class NlxSignalRecord {
     std::vector<double>::iterator data(std::vector<double>::iterator it) const;
     double sample_microvolt(unsigned int index) const;
 
+    // convert the samples of n channels (given by their indices) to
+    // microvolts (double or float) and store them contiguously in out, e.g.
+    // the channels of a group in a multi-channel data sample. Results are
+    // identical to sample_microvolt.
+    template <typename T>
+    void samples_microvolt(const unsigned int *channels, std::size_t n,
+                           T *out) const;
+
+    // as samples_microvolt, but stores the raw AD values (in units of
+    // NLX_AD_BIT_MICROVOLTS) saturated to the int16 range
+    void samples_adbits(const unsigned int *channels, std::size_t n,
+                        int16_t *out) const;
+
+    // samples in the representation of a stream of element type T: raw AD
+    // values for int16, microvolts for floating point types
+    template <typename T>
+    void samples(const unsigned int *channels, std::size_t n, T *out) const {
+        if constexpr (std::is_same<T, int16_t>::value) {
+            samples_adbits(channels, n, out);
+        } else {
+            samples_microvolt(channels, n, out);
+        }
+    }
+
     // data (microVolt) setter methods
     void set_data(double value = 0);
     void set_data(std::vector<double> &v);
@@ -226,6 +259,9 @@ class NlxSignalRecord {
     int32_t nlx_packetsize_;
 
   protected:
+    // check the header fields and the CRC field against a computed CRC
+    int validate(int32_t crc);
+
     std::vector<int32_t>::iterator data_begin();
     std::vector<int32_t>::iterator data_end();
 
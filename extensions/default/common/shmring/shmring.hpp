@@ -0,0 +1,431 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+// Single-writer, multi-reader ring of fixed-size records in POSIX shared
+// memory, used by the SharedMemorySink processor to export data streams to
+// clients on the same host. The header has no dependencies beyond the C++
+// standard library and POSIX, so that clients can include it without
+// linking against falcon.
+//
+// As in the disruptor, the writer publishes records under monotonically
+// increasing sequence numbers and advances a shared cursor. Every slot
+// carries the sequence number of the record it holds, which readers check
+// before and after reading (a seqlock). The writer never waits for readers:
+// a reader that falls more than one ring behind loses records, which it is
+// told about, instead of stalling the graph.
+//
+// Records are stored in the binary FULL format of the data type
+// (see IData::SerializeBinary), i.e. a RecordHeader followed by the payload.
+// Use MultiChannelRecord or EventRecord to access them in place.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace shmring {
+
+constexpr char MAGIC[8] = {'F', 'A', 'L', 'C', 'R', 'I', 'N', 'G'};
+constexpr uint32_t VERSION = 2;
+
+// sequence number of a slot that holds no (valid) record
+constexpr int64_t INVALID_SEQUENCE = -1;
+
+static_assert(std::atomic<int64_t>::is_always_lock_free,
+              "shared memory ring requires lock-free 64-bit atomics");
+
+enum RingState : uint32_t { INITIALIZING = 0, OPEN = 1, CLOSED = 2 };
+
+struct RingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t capacity;    // number of slots, a power of two
+    uint64_t slot_size;   // bytes per slot, including the SlotHeader
+    uint64_t record_size; // maximum size of a record
+    // description of the exported stream
+    char datatype[32];   // "multichannel", "event" or another data type
+    char sample_type[16]; // multichannel only, e.g. "float64"
+    uint32_t nchannels;
+    uint32_t nsamples;
+    double sample_rate;
+    double sample_scale; // value of one sample unit, e.g. AD bit in uV
+    char description[1024]; // YAML description of the record layout
+
+    alignas(64) std::atomic<uint32_t> state;
+    // sequence number of the last published record
+    alignas(64) std::atomic<int64_t> cursor;
+};
+
+struct alignas(64) SlotHeader {
+    std::atomic<int64_t> sequence;
+    uint32_t size;
+};
+
+// layout of the record header written by IData::SerializeBinary
+struct RecordHeader {
+    uint64_t source_timestamp; // microseconds since epoch
+    uint64_t hardware_timestamp;
+    uint64_t serial_number;
+};
+
+inline uint64_t slot_size_for(uint64_t record_size) {
+    return (sizeof(SlotHeader) + record_size + 63) & ~uint64_t(63);
+}
+
+inline std::string segment_name(std::string name) {
+    if (name.empty() || name[0] != '/') {
+        name.insert(0, "/");
+    }
+    return name;
+}
+
+class RingWriter {
+  public:
+    // Creates the shared memory segment for a ring with room for capacity
+    // records (rounded up to a power of two) of at most record_size bytes.
+    // A stale segment with the same name is replaced; readers that still
+    // have it mapped keep their (closed) copy. The descriptive fields of
+    // header() can be filled in before calling Open().
+    RingWriter(const std::string &name, uint64_t capacity,
+               uint64_t record_size)
+        : name_(segment_name(name)) {
+        uint64_t n = 2;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        uint64_t slot_size = slot_size_for(record_size);
+        size_ = sizeof(RingHeader) + n * slot_size;
+
+        shm_unlink(name_.c_str());
+        int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Unable to create shared memory segment " +
+                                     name_ + ": " + std::strerror(errno));
+        }
+        if (ftruncate(fd, size_) != 0) {
+            int err = errno;
+            close(fd);
+            shm_unlink(name_.c_str());
+            throw std::runtime_error("Unable to size shared memory segment " +
+                                     name_ + ": " + std::strerror(err));
+        }
+        void *base =
+            mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            int err = errno;
+            shm_unlink(name_.c_str());
+            throw std::runtime_error("Unable to map shared memory segment " +
+                                     name_ + ": " + std::strerror(err));
+        }
+        base_ = static_cast<uint8_t *>(base);
+
+        header_ = new (base_) RingHeader();
+        std::memcpy(header_->magic, MAGIC, sizeof(MAGIC));
+        header_->version = VERSION;
+        header_->header_size = sizeof(RingHeader);
+        header_->capacity = n;
+        header_->slot_size = slot_size;
+        header_->record_size = record_size;
+        header_->state.store(INITIALIZING, std::memory_order_relaxed);
+        header_->cursor.store(INVALID_SEQUENCE, std::memory_order_relaxed);
+        for (uint64_t k = 0; k < n; ++k) {
+            new (slot(k)) SlotHeader();
+            slot(k)->sequence.store(INVALID_SEQUENCE,
+                                    std::memory_order_relaxed);
+        }
+    }
+
+    ~RingWriter() {
+        Close();
+        munmap(base_, size_);
+        shm_unlink(name_.c_str());
+    }
+
+    RingWriter(const RingWriter &) = delete;
+    RingWriter &operator=(const RingWriter &) = delete;
+
+    RingHeader &header() { return *header_; }
+    const std::string &name() const { return name_; }
+    uint64_t record_size() const { return header_->record_size; }
+    int64_t next() const { return next_; }
+
+    // makes the ring visible to readers
+    void Open() { header_->state.store(OPEN, std::memory_order_release); }
+
+    // signals readers that no more records will be published
+    void Close() { header_->state.store(CLOSED, std::memory_order_release); }
+
+    // Returns the storage for the next record (record_size() bytes). The
+    // slot is invalidated first, so that readers of the record it held
+    // before detect the overwrite.
+    uint8_t *Claim() {
+        SlotHeader *s = slot(next_);
+        s->sequence.store(INVALID_SEQUENCE, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return reinterpret_cast<uint8_t *>(s + 1);
+    }
+
+    // publishes the record of size bytes that was written to the storage
+    // returned by Claim()
+    void Publish(uint32_t size) {
+        SlotHeader *s = slot(next_);
+        s->size = size;
+        s->sequence.store(next_, std::memory_order_release);
+        header_->cursor.store(next_, std::memory_order_release);
+        ++next_;
+    }
+
+  protected:
+    SlotHeader *slot(int64_t sequence) {
+        return reinterpret_cast<SlotHeader *>(
+            base_ + sizeof(RingHeader) +
+            (sequence & (header_->capacity - 1)) * header_->slot_size);
+    }
+
+  protected:
+    std::string name_;
+    std::size_t size_;
+    uint8_t *base_;
+    RingHeader *header_;
+    int64_t next_ = 0;
+};
+
+class RingReader {
+  public:
+    enum class Status { OK, EMPTY, LOST };
+
+    // Maps the ring with the given name read-only and positions the reader
+    // at the most recent record. Throws std::runtime_error if the ring does
+    // not exist (yet) or is incompatible.
+    explicit RingReader(const std::string &name) : name_(segment_name(name)) {
+        int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Unable to open shared memory segment " +
+                                     name_ + ": " + std::strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 ||
+            static_cast<std::size_t>(st.st_size) < sizeof(RingHeader)) {
+            close(fd);
+            throw std::runtime_error("Shared memory segment " + name_ +
+                                     " is not initialized.");
+        }
+        size_ = st.st_size;
+        void *base = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            throw std::runtime_error("Unable to map shared memory segment " +
+                                     name_ + ": " + std::strerror(errno));
+        }
+        base_ = static_cast<const uint8_t *>(base);
+        header_ = reinterpret_cast<const RingHeader *>(base_);
+
+        std::string error;
+        if (header_->state.load(std::memory_order_acquire) == INITIALIZING) {
+            error = " is not initialized.";
+        } else if (std::memcmp(header_->magic, MAGIC, sizeof(MAGIC)) != 0) {
+            error = " is not a falcon ring.";
+        } else if (header_->version != VERSION ||
+                   header_->header_size != sizeof(RingHeader)) {
+            error = " has an incompatible version.";
+        } else if (size_ < sizeof(RingHeader) +
+                               header_->capacity * header_->slot_size) {
+            error = " is truncated.";
+        }
+        if (!error.empty()) {
+            munmap(const_cast<uint8_t *>(base_), size_);
+            throw std::runtime_error("Shared memory segment " + name_ + error);
+        }
+        SeekLatest();
+    }
+
+    ~RingReader() { munmap(const_cast<uint8_t *>(base_), size_); }
+
+    RingReader(const RingReader &) = delete;
+    RingReader &operator=(const RingReader &) = delete;
+
+    const RingHeader &header() const { return *header_; }
+    const std::string &name() const { return name_; }
+
+    // true if the writer has stopped; reopen the ring to follow a new run
+    bool closed() const {
+        return header_->state.load(std::memory_order_acquire) == CLOSED;
+    }
+
+    int64_t cursor() const {
+        return header_->cursor.load(std::memory_order_acquire);
+    }
+
+    // sequence number of the next record to read
+    int64_t next() const { return next_; }
+
+    // number of records that were overwritten before they could be read
+    uint64_t nlost() const { return nlost_; }
+
+    // positions the reader at the most recent record
+    void SeekLatest() { next_ = std::max<int64_t>(cursor(), 0); }
+
+    // positions the reader at the oldest record still in the ring
+    void SeekOldest() {
+        next_ = std::max<int64_t>(
+            cursor() - static_cast<int64_t>(header_->capacity) + 1, 0);
+    }
+
+    // Calls f(record, size, sequence) for the next record, in place in
+    // shared memory. Returns EMPTY if no new record has been published and
+    // LOST if the record was overwritten, either before or while f was
+    // reading it. In the latter case f may have seen a partially
+    // overwritten record and anything it derived from it must be discarded.
+    // The reader skips ahead past lost records, so calling Read again
+    // continues with the oldest record that is still available.
+    template <typename F> Status Read(F &&f) {
+        int64_t cursor = this->cursor();
+        if (next_ > cursor) {
+            return Status::EMPTY;
+        }
+        int64_t capacity = header_->capacity;
+        if (cursor - next_ >= capacity) {
+            int64_t oldest = cursor - capacity + 1;
+            nlost_ += oldest - next_;
+            next_ = oldest;
+            return Status::LOST;
+        }
+
+        const SlotHeader *s = slot(next_);
+        if (s->sequence.load(std::memory_order_acquire) != next_) {
+            ++nlost_;
+            ++next_;
+            return Status::LOST;
+        }
+        uint32_t size = std::min<uint64_t>(s->size, header_->record_size);
+        f(reinterpret_cast<const uint8_t *>(s + 1), size, next_);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s->sequence.load(std::memory_order_relaxed) != next_) {
+            ++nlost_;
+            ++next_;
+            return Status::LOST;
+        }
+        ++next_;
+        return Status::OK;
+    }
+
+    // copies the next record into record
+    Status Read(std::vector<uint8_t> &record) {
+        return Read([&record](const uint8_t *data, uint32_t size, int64_t) {
+            record.assign(data, data + size);
+        });
+    }
+
+  protected:
+    const SlotHeader *slot(int64_t sequence) const {
+        return reinterpret_cast<const SlotHeader *>(
+            base_ + sizeof(RingHeader) +
+            (sequence & (header_->capacity - 1)) * header_->slot_size);
+    }
+
+  protected:
+    std::string name_;
+    std::size_t size_;
+    const uint8_t *base_;
+    const RingHeader *header_;
+    int64_t next_ = 0;
+    uint64_t nlost_ = 0;
+};
+
+// In-place view of a MultiChannelData record with samples of type T, which
+// holds nsamples timestamps followed by nsamples x nchannels samples in
+// sample-major order.
+template <typename T> class MultiChannelRecord {
+  public:
+    MultiChannelRecord(const uint8_t *record, uint32_t nchannels,
+                       uint32_t nsamples)
+        : record_(record), nchannels_(nchannels), nsamples_(nsamples) {}
+
+    // uses the stream description in the ring header
+    MultiChannelRecord(const uint8_t *record, const RingHeader &header)
+        : MultiChannelRecord(record, header.nchannels, header.nsamples) {}
+
+    static std::size_t size(uint32_t nchannels, uint32_t nsamples) {
+        return sizeof(RecordHeader) + nsamples * sizeof(uint64_t) +
+               nsamples * nchannels * sizeof(T);
+    }
+
+    const RecordHeader &header() const {
+        return *reinterpret_cast<const RecordHeader *>(record_);
+    }
+    uint32_t nchannels() const { return nchannels_; }
+    uint32_t nsamples() const { return nsamples_; }
+
+    const uint64_t *timestamps() const {
+        return reinterpret_cast<const uint64_t *>(record_ +
+                                                  sizeof(RecordHeader));
+    }
+    const T *data() const {
+        return reinterpret_cast<const T *>(timestamps() + nsamples_);
+    }
+    T sample(uint32_t sample, uint32_t channel) const {
+        return data()[sample * nchannels_ + channel];
+    }
+
+  protected:
+    const uint8_t *record_;
+    uint32_t nchannels_;
+    uint32_t nsamples_;
+};
+
+// In-place view of an EventData record, which holds the event name padded
+// with zeros to EVENT_STRING_LENGTH characters.
+class EventRecord {
+  public:
+    static const unsigned int EVENT_STRING_LENGTH = 128;
+
+    explicit EventRecord(const uint8_t *record) : record_(record) {}
+
+    static std::size_t size() {
+        return sizeof(RecordHeader) + EVENT_STRING_LENGTH;
+    }
+
+    const RecordHeader &header() const {
+        return *reinterpret_cast<const RecordHeader *>(record_);
+    }
+    std::string event() const {
+        const char *s =
+            reinterpret_cast<const char *>(record_ + sizeof(RecordHeader));
+        return std::string(s, strnlen(s, EVENT_STRING_LENGTH));
+    }
+
+  protected:
+    const uint8_t *record_;
+};
+
+} // namespace shmring
@@ -17,49 +17,86 @@
 // along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
 // ---------------------------------------------------------------------
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "eventdata.hpp"
 
-using namespace nsEventType;
-
-Data::Data(std::string event) { set_event(event); }
+namespace {
 
-void Data::Initialize(std::string event) { set_event(event); }
+struct EventNameTable {
+    EventNameTable() { add(DEFAULT_EVENT); }
 
-void Data::ClearData() { set_event(DEFAULT_EVENT); }
+    EventIDType add(const std::string &name) {
+        EventIDType id = names.size();
+        names.push_back(name);
+        ids[name] = id;
+        index[id].store(&names.back(), std::memory_order_release);
+        return id;
+    }
 
-std::string Data::event() const { return event_; }
+    std::mutex lock;
+    std::unordered_map<std::string, EventIDType> ids;
+    // deque, so that interned names never move
+    std::deque<std::string> names;
+    // lock-free lookup of names by ID
+    std::unique_ptr<std::atomic<const std::string *>[]> index{
+        new std::atomic<const std::string *>[EventNames::MAX_EVENT_NAMES]()};
+};
+
+EventNameTable &table() {
+    static EventNameTable instance;
+    return instance;
+}
 
-size_t Data::hash() const { return hash_; }
+} // namespace
 
-size_t Data::size() const { return event_.size(); }
+EventIDType EventNames::intern(const std::string &name) {
+    auto &t = table();
+    std::lock_guard<std::mutex> guard(t.lock);
+    auto it = t.ids.find(name);
+    if (it != t.ids.end()) {
+        return it->second;
+    }
+    if (t.names.size() >= MAX_EVENT_NAMES) {
+        throw std::runtime_error("Too many distinct event names (maximum " +
+                                 std::to_string(MAX_EVENT_NAMES) + ").");
+    }
+    return t.add(name);
+}
 
-void Data::set_event(std::string event) {
-    event_ = event;
-    hash_ = std::hash<std::string>()(event_);
+const std::string &EventNames::name(EventIDType id) {
+    return *table().index[id].load(std::memory_order_acquire);
 }
 
-void Data::set_event(const Data &source) {
-    event_ = source.event();
-    hash_ = source.hash();
+std::size_t EventNames::size() {
+    auto &t = table();
+    std::lock_guard<std::mutex> guard(t.lock);
+    return t.names.size();
 }
 
-namespace nsEventType {
+using namespace nsEventType;
 
-bool operator==(const Data &e1, const Data &e2) { return e1.hash_ == e2.hash_; }
+Data::Data(std::string event) { set_event(event); }
 
-bool operator!=(const Data &e1, const Data &e2) { return e1.hash_ != e2.hash_; }
-} // namespace nsEventType
+void Data::Initialize(std::string event) { set_event(event); }
 
 void Data::SerializeBinary(std::ostream &stream,
                            Serialization::Format format) const {
     Base::Data::SerializeBinary(stream, format);
     if (format == Serialization::Format::FULL ||
         format == Serialization::Format::COMPACT) {
-        std::string buffer = event_;
-        buffer.resize(EVENT_STRING_LENGTH);
-        stream.write(buffer.data(), EVENT_STRING_LENGTH);
+        // name padded with zeros to a fixed length
+        static const char padding[EVENT_STRING_LENGTH] = {};
+        const std::string &name = event();
+        std::size_t n = std::min<std::size_t>(name.size(), EVENT_STRING_LENGTH);
+        stream.write(name.data(), n);
+        stream.write(padding, EVENT_STRING_LENGTH - n);
     }
 }
 
@@ -67,13 +104,13 @@ void Data::SerializeYAML(YAML::Node &node, Serialization::Format format) const {
     Base::Data::SerializeYAML(node, format);
     if (format == Serialization::Format::FULL ||
         format == Serialization::Format::COMPACT) {
-        node["event"] = event_;
+        node["event"] = event();
     }
 }
 
 void Data::SerializeFlatBuffer(flexbuffers::Builder &flex_builder) {
     Base::Data::SerializeFlatBuffer(flex_builder);
-    flex_builder.String("event", event_);
+    flex_builder.String("event", event());
     flex_builder.String("type", EventType::datatype());
 }
 
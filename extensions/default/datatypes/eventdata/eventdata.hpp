@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 #include "idata.hpp"
@@ -30,6 +31,27 @@ const std::string DEFAULT_EVENT = "none";
 // to be used for port names using event data
 const std::string EVENTDATA = "events";
 
+// Global table of event names. Names are interned once, normally while the
+// graph is built (e.g. when event options are parsed), after which events
+// carry the integer ID of their name and are compared and dispatched by ID.
+// Looking up the name of an ID does not lock; interning a name that is not
+// yet in the table does.
+class EventNames {
+  public:
+    // ID of DEFAULT_EVENT
+    static const EventIDType DEFAULT_ID = 0;
+    static const std::size_t MAX_EVENT_NAMES = 1 << 16;
+
+    // returns the ID of name, adding it to the table if needed
+    static EventIDType intern(const std::string &name);
+
+    // returns the interned name of a valid ID
+    static const std::string &name(EventIDType id);
+
+    // number of interned names
+    static std::size_t size();
+};
+
 namespace nsEventType {
 
 using Base = AnyType;
@@ -59,15 +81,22 @@ class Data : public Base::Data {
         set_event(parameters.default_event);
     }
 
-    void ClearData() override;
-    std::string event() const;
-    size_t hash() const;
-    size_t size() const;
-    void set_event(std::string event);
-    void set_event(const Data &source);
+    void ClearData() override { id_ = EventNames::DEFAULT_ID; }
+    const std::string &event() const { return EventNames::name(id_); }
+    EventIDType id() const { return id_; }
+    size_t size() const { return event().size(); }
+    void set_event(const std::string &event) {
+        id_ = EventNames::intern(event);
+    }
+    void set_event(EventIDType id) { id_ = id; }
+    void set_event(const Data &source) { id_ = source.id_; }
 
-    friend bool operator==(const Data &e1, const Data &e2);
-    friend bool operator!=(const Data &e1, const Data &e2);
+    friend bool operator==(const Data &e1, const Data &e2) {
+        return e1.id_ == e2.id_;
+    }
+    friend bool operator!=(const Data &e1, const Data &e2) {
+        return e1.id_ != e2.id_;
+    }
 
     void SerializeBinary(std::ostream &stream,
                          Serialization::Format format =
@@ -83,8 +112,7 @@ class Data : public Base::Data {
                              Serialization::Format::FULL) const override;
 
   protected:
-    std::string event_;
-    size_t hash_;
+    EventIDType id_;
 
     static const unsigned int EVENT_STRING_LENGTH = 128;
 };
@@ -24,26 +24,129 @@
 #include "utilities/iterators.hpp"
 #include "utilities/string.hpp"
 #include <algorithm>
+#include <cctype>
 #include <cmath>
+#include <cstdint>
 #include <limits>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 typedef Range<size_t> SampleRange;
 template <typename T> class MultiChannelType;
 
+// Element types of multi-channel signal streams that processors can select
+// at graph build time through a "data type" option. Narrower types reduce
+// the memory traffic through the ring buffers and double the SIMD width.
+enum class SampleType { FLOAT64 = 0, FLOAT32, INT16 };
+
+inline std::string sampletype_to_string(SampleType x) {
+    std::string s;
+#define MATCH(p, name)                                                         \
+    case (SampleType::p):                                                      \
+        s = name;                                                              \
+        break;
+    switch (x) {
+        MATCH(FLOAT64, "float64");
+        MATCH(FLOAT32, "float32");
+        MATCH(INT16, "int16");
+    }
+#undef MATCH
+    return s;
+}
+
+inline SampleType string_to_sampletype(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), (int (*)(int))std::tolower);
+#define MATCH(p, name)                                                         \
+    if (s == name) {                                                           \
+        return SampleType::p;                                                  \
+    }
+    MATCH(FLOAT64, "float64");
+    MATCH(FLOAT64, "double");
+    MATCH(FLOAT32, "float32");
+    MATCH(FLOAT32, "float");
+    MATCH(INT16, "int16");
+    throw std::runtime_error("Invalid SampleType value.");
+#undef MATCH
+}
+
+namespace YAML {
+template <> struct convert<SampleType> {
+    static Node encode(const SampleType &rhs) {
+        Node node;
+        node = sampletype_to_string(rhs);
+        return node;
+    }
+
+    static bool decode(const Node &node, SampleType &rhs) {
+        rhs = string_to_sampletype(node.as<std::string>());
+        return true;
+    }
+};
+} // namespace YAML
+
+template <typename T> struct sample_type_of;
+template <> struct sample_type_of<double> {
+    static constexpr SampleType value = SampleType::FLOAT64;
+};
+template <> struct sample_type_of<float> {
+    static constexpr SampleType value = SampleType::FLOAT32;
+};
+template <> struct sample_type_of<int16_t> {
+    static constexpr SampleType value = SampleType::INT16;
+};
+
+// Calls f with a value-initialized sample of the element type that matches
+// type, e.g. dispatch_sample_type<double, float>(type, [&](auto x) {
+// Process<decltype(x)>(); }). Only the listed element types are supported.
+template <typename... Ts, typename F>
+void dispatch_sample_type(SampleType type, F &&f) {
+    bool found = false;
+    auto match = [&](auto x) {
+        if (!found && sample_type_of<decltype(x)>::value == type) {
+            found = true;
+            f(x);
+        }
+    };
+    (match(Ts{}), ...);
+    if (!found) {
+        throw std::runtime_error("Unsupported sample type: " +
+                                 sampletype_to_string(type) + ".");
+    }
+}
+
+// conversion of a (filtered) sample value to the element type of a stream,
+// with rounding and saturation for integer types
+template <typename T> inline T convert_sample(double value) {
+    if constexpr (std::is_integral<T>::value) {
+        value = std::round(value);
+        if (value >= std::numeric_limits<T>::max()) {
+            return std::numeric_limits<T>::max();
+        }
+        if (value <= std::numeric_limits<T>::lowest()) {
+            return std::numeric_limits<T>::lowest();
+        }
+    }
+    return static_cast<T>(value);
+}
+
 namespace nsMultiChannel {
 
 using Base = AnyType;
 
 struct Parameters : Base::Parameters {
-    Parameters(size_t nchan = 0, size_t nsamp = 0, double rate = 1.0)
+    Parameters(size_t nchan = 0, size_t nsamp = 0, double rate = 1.0,
+               double scale = 1.0)
         : Base::Parameters(), nchannels(nchan), nsamples(nsamp),
-          sample_rate(rate) {}
+          sample_rate(rate), sample_scale(scale) {}
 
     size_t nchannels;
     size_t nsamples;
     double sample_rate;
+    // value of one unit of the samples, e.g. the AD bit in microvolts for
+    // integer streams of raw AD counts; 1 if samples are in physical units
+    double sample_scale;
 };
 
 class Capabilities : public Base::Capabilities {
@@ -92,11 +195,22 @@ class Capabilities : public Base::Capabilities {
     SampleRange sample_range_;
 };
 
+// Capabilities are specialized for the element type, so that streams with
+// different element types are reported as incompatible data types when the
+// graph is built.
+template <typename T> class TypedCapabilities : public Capabilities {
+  public:
+    using Capabilities::Capabilities;
+};
+
 template <typename T> class Data : public Base::Data {
   public:
     typedef stride_iter<T *> channel_iterator;
     typedef T *sample_iterator;
 
+    // cache line aligned storage, shared by all buckets of a ring buffer
+    template <typename U> using storage = std::vector<U, ArenaAllocator<U>>;
+
     Data() {}
 
     Data(size_t nchannels, size_t nsamples, double sample_rate) {
@@ -110,10 +224,26 @@ template <typename T> class Data : public Base::Data {
 
     void Initialize(const Parameters &parameters) {
         Initialize(parameters.nchannels, parameters.nsamples,
-                   parameters.sample_rate);
+                   parameters.sample_rate, parameters.sample_scale);
+    }
+
+    static std::size_t ArenaSize(const Parameters &parameters) {
+        auto aligned = [](std::size_t n) {
+            return (n + Arena::ALIGNMENT - 1) / Arena::ALIGNMENT *
+                   Arena::ALIGNMENT;
+        };
+        return aligned(parameters.nchannels * parameters.nsamples *
+                       sizeof(T)) +
+               aligned(parameters.nsamples * sizeof(uint64_t));
+    }
+
+    void UseArena(Arena *arena) {
+        data_ = storage<T>(ArenaAllocator<T>(arena));
+        timestamps_ = storage<uint64_t>(ArenaAllocator<uint64_t>(arena));
     }
 
-    void Initialize(size_t nchannels, size_t nsamples, double sample_rate) {
+    void Initialize(size_t nchannels, size_t nsamples, double sample_rate,
+                    double sample_scale = 1.0) {
         if (nchannels == 0 || nsamples == 0) {
             throw std::runtime_error(
                 ". MultiChannelData::Initialize - number of "
@@ -129,6 +259,7 @@ template <typename T> class Data : public Base::Data {
         nchannels_ = nchannels;
         nsamples_ = nsamples;
         sample_rate_ = sample_rate;
+        sample_scale_ = sample_scale;
 
         data_.resize(nchannels_ * nsamples_);
 
@@ -138,11 +269,12 @@ template <typename T> class Data : public Base::Data {
     size_t nchannels() const { return nchannels_; }
     size_t nsamples() const { return nsamples_; }
     double sample_rate() const { return sample_rate_; }
+    double sample_scale() const { return sample_scale_; }
 
     uint64_t sample_timestamp(size_t sample = 0) const {
         return timestamps_[sample];
     }
-    std::vector<uint64_t> &sample_timestamps() { return timestamps_; }
+    storage<uint64_t> &sample_timestamps() { return timestamps_; }
 
     void set_sample_timestamp(size_t sample, uint64_t t) {
         if (sample >= nsamples_) {
@@ -154,7 +286,7 @@ template <typename T> class Data : public Base::Data {
         }
     }
 
-    void set_sample_timestamps(std::vector<uint64_t> &t) {
+    void set_sample_timestamps(storage<uint64_t> &t) {
         assert(t.size() == nsamples_);
         timestamps_ = t;
     }
@@ -188,7 +320,7 @@ template <typename T> class Data : public Base::Data {
         data_[flat_index(sample, channel)] = data;
     }
 
-    std::vector<T> &data() { return data_; }
+    storage<T> &data() { return data_; }
 
     const T &data_sample(size_t sample, size_t channel = 0) const {
         return data_[flat_index(sample, channel)];
@@ -243,6 +375,26 @@ template <typename T> class Data : public Base::Data {
         }
     }
 
+    // FULL and COMPACT: uint32 size of the encoded block, followed by the
+    // block of timestamps and samples (see utilities/samplecodec.hpp)
+    void SerializePacked(
+        std::ostream &stream, Serialization::Format format,
+        Serialization::PackedStreamState &state) const override {
+        if (format != Serialization::Format::FULL &&
+            format != Serialization::Format::COMPACT) {
+            SerializeBinary(stream, format);
+            return;
+        }
+        Base::Data::SerializeBinary(stream, format);
+        state.buffer.clear();
+        state.encoder.Encode(data_.data(), timestamps_.data(), nchannels_,
+                             nsamples_, state.buffer);
+        uint32_t size = static_cast<uint32_t>(state.buffer.size());
+        stream.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        stream.write(reinterpret_cast<const char *>(state.buffer.data()),
+                     size);
+    }
+
     void SerializeYAML(YAML::Node &node,
                        Serialization::Format format =
                            Serialization::Format::FULL) const override {
@@ -270,6 +422,7 @@ template <typename T> class Data : public Base::Data {
 
         flex_builder.UInt("nchannels", nchannels());
         flex_builder.UInt("nsamples", nsamples());
+        flex_builder.Double("scale", sample_scale());
         flex_builder.String("type", MultiChannelType<T>::datatype());
     }
 
@@ -321,8 +474,9 @@ template <typename T> class Data : public Base::Data {
     size_t nchannels_;
     size_t nsamples_;
     double sample_rate_;
-    std::vector<T> data_;
-    std::vector<uint64_t> timestamps_;
+    double sample_scale_ = 1.0;
+    storage<T> data_;
+    storage<uint64_t> timestamps_;
 };
 
 } // namespace nsMultiChannel
@@ -334,6 +488,6 @@ template <typename T> class MultiChannelType {
 
     using Base = nsMultiChannel::Base;
     using Parameters = nsMultiChannel::Parameters;
-    using Capabilities = nsMultiChannel::Capabilities;
+    using Capabilities = nsMultiChannel::TypedCapabilities<T>;
     using Data = nsMultiChannel::Data<T>;
 };
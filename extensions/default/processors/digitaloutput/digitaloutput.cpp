@@ -30,7 +30,13 @@ DigitalOutput::DigitalOutput() {
                "Number of digital channel on the device.");
     add_option("protocols", protocols_yaml_, "");
     add_option("event logging", event_log_,
-               "Log message (UPDATE level) if true");
+               "Log a message (UPDATE level) for every protocol that is "
+               "queued for execution.");
+    add_option("executor/queue size", queue_size_,
+               "Maximum number of protocols waiting to be executed.");
+    add_option("executor/priority", priority_,
+               "Real-time (SCHED_FIFO) priority of the executor thread, 0 "
+               "keeps the default scheduling.");
 }
 void DigitalOutput::Configure(const GlobalContext &context) {
 
@@ -44,22 +50,20 @@ void DigitalOutput::Configure(const GlobalContext &context) {
     LOG(INFO) << "Opened digital output device " << device_->description()
               << ".";
 
+    protocols_.clear();
     for (auto const &it : protocols_yaml_()) {
-        protocols_[it.first] = std::unique_ptr<DigitalOutputProtocol>(
+        auto &protocol = protocols_[EventNames::intern(it.first)];
+        protocol = std::unique_ptr<DigitalOutputProtocol>(
             new DigitalOutputProtocol(device_->nchannels(), pulse_width_()));
         for (auto const &it2 : it.second) {
             if (it2.first == "toggle") {
-                protocols_[it.first]->set_mode(it2.second,
-                                               DigitalOutputMode::TOGGLE);
+                protocol->set_mode(it2.second, DigitalOutputMode::TOGGLE);
             } else if (it2.first == "high") {
-                protocols_[it.first]->set_mode(it2.second,
-                                               DigitalOutputMode::HIGH);
+                protocol->set_mode(it2.second, DigitalOutputMode::HIGH);
             } else if (it2.first == "low") {
-                protocols_[it.first]->set_mode(it2.second,
-                                               DigitalOutputMode::LOW);
+                protocol->set_mode(it2.second, DigitalOutputMode::LOW);
             } else if (it2.first == "pulse") {
-                protocols_[it.first]->set_mode(it2.second,
-                                               DigitalOutputMode::PULSE);
+                protocol->set_mode(it2.second, DigitalOutputMode::PULSE);
             }
         }
     }
@@ -73,6 +77,15 @@ void DigitalOutput::CreatePorts() {
                                                  PortInPolicy(SlotRange(1)));
 }
 
+void DigitalOutput::Preprocess(ProcessingContext &context) {
+    executor_.reset(
+        new DigitalOutputExecutor(*device_, queue_size_(), priority_()));
+    LOG_IF(WARNING, priority_() > 0 && !executor_->realtime())
+        << name() << ". Unable to set real-time priority " << priority_()
+        << " for the output executor.";
+    ndropped_ = 0;
+}
+
 void DigitalOutput::Process(ProcessingContext &context) {
 
     EventType::Data *data_in = nullptr;
@@ -82,18 +95,20 @@ void DigitalOutput::Process(ProcessingContext &context) {
         if (!data_in_port_->slot(0)->RetrieveData(data_in)) {
             break;
         }
-
-        // select and execute protocol based on event name
-        if (protocols_.count(data_in->event()) > 0) {
-
-            try {
-                protocols_[data_in->event()]->execute(*device_);
-
-                LOG(UPDATE) << name() << ". Protocol executed for "
-                            << data_in->event() << " event.";
-            } catch (DigitalDeviceError &e) {
-                LOG(WARNING) << ". Could not execute protocol for event ("
-                             << data_in->event() << ") : " << e.what();
+        TimePoint trigger = Clock::now();
+
+        // select protocol based on event ID and hand it to the executor
+        auto protocol = protocols_.find(data_in->id());
+        if (protocol != protocols_.end()) {
+            if (!executor_->Submit(*protocol->second, trigger)) {
+                FASTLOG_IF(WARNING, ndropped_ == 0,
+                           "{}. Output executor queue is full, dropped "
+                           "protocol for {} event.",
+                           name(), data_in->event());
+                ++ndropped_;
+            } else if (event_log_()) {
+                FASTLOG(UPDATE, "{}. Protocol queued for {} event.", name(),
+                        data_in->event());
             }
         }
 
@@ -101,4 +116,21 @@ void DigitalOutput::Process(ProcessingContext &context) {
     }
 }
 
+void DigitalOutput::Postprocess(ProcessingContext &context) {
+    // waits for the queued protocols and running pulses
+    executor_->Stop();
+
+    LOG(INFO) << name() << ". Executed " << executor_->nexecuted()
+              << " protocols, " << ndropped_ << " dropped.";
+    if (executor_->nexecuted() > 0) {
+        LOG(INFO) << name() << ". Trigger to output latency: "
+                  << executor_->latency().summary();
+    }
+    LOG_IF(WARNING, executor_->nerrors() > 0)
+        << name() << ". Could not execute " << executor_->nerrors()
+        << " protocols, last error: " << executor_->last_error();
+
+    executor_.reset();
+}
+
 REGISTERPROCESSOR(DigitalOutput)
@@ -19,13 +19,15 @@
 
 #pragma once
 #include "dio/dio.hpp"
+#include "dio/dioexecutor.hpp"
 #include "eventdata/eventdata.hpp"
 #include "iprocessor.hpp"
 #include "utilities/time.hpp"
 
 typedef std::map<std::string, std::map<std::string, std::vector<uint32_t>>>
     ProtocolYAMLMap;
-typedef std::map<std::string, std::unique_ptr<DigitalOutputProtocol>>
+// protocols by interned event ID
+typedef std::map<EventIDType, std::unique_ptr<DigitalOutputProtocol>>
     ProtocolMap;
 
 class DigitalOutput : public IProcessor {
@@ -34,7 +36,9 @@ class DigitalOutput : public IProcessor {
     DigitalOutput();
     void CreatePorts() override;
     void Configure(const GlobalContext &context) override;
+    void Preprocess(ProcessingContext &context) override;
     void Process(ProcessingContext &context) override;
+    void Postprocess(ProcessingContext &context) override;
 
     // DATA PORTS
   protected:
@@ -51,8 +55,15 @@ class DigitalOutput : public IProcessor {
     options::Value<std::uint32_t, false> nchannels_{16};
     options::Value<ProtocolYAMLMap, false> protocols_yaml_{};
 
-    options::Bool event_log_{true};
+    options::Bool event_log_{false};
+
+    options::Value<unsigned int, false> queue_size_{
+        64, options::inrange<unsigned int>(2, 4096)};
+    options::Value<int, false> priority_{
+        50, options::inrange<int>(0, 99)};
 
     std::unique_ptr<DigitalDevice> device_;
     ProtocolMap protocols_;
+    std::unique_ptr<DigitalOutputExecutor> executor_;
+    uint64_t ndropped_;
 };
@@ -23,38 +23,57 @@
 Distributor::Distributor() : IProcessor(PRIORITY_MEDIUM) {
     add_option("channelmap", channelmap_,
                "Mapping of channels to processor output ports.", true);
+    add_option("data type", sample_type_,
+               "Element type of the input and output samples (float64, "
+               "float32 or int16).");
 }
 
 void Distributor::CreatePorts() {
-    input_port_ = create_input_port<MultiChannelType<double>>(
-        MultiChannelType<double>::Capabilities(ChannelRange(1, MAX_N_CHANNELS)),
+    dispatch_sample_type<double, float, int16_t>(
+        sample_type_(), [this](auto x) { CreateTypedPorts<decltype(x)>(); });
+}
+
+template <typename T> void Distributor::CreateTypedPorts() {
+    input_port_ = create_input_port<MultiChannelType<T>>(
+        typename MultiChannelType<T>::Capabilities(
+            ChannelRange(1, MAX_N_CHANNELS)),
         PortInPolicy(SlotRange(1)));
 
     for (auto &it : channelmap_()) {
-        data_ports_[it.first] = create_output_port<MultiChannelType<double>>(
+        data_ports_[it.first] = create_output_port<MultiChannelType<T>>(
             it.first,
-            MultiChannelType<double>::Capabilities(
+            typename MultiChannelType<T>::Capabilities(
                 ChannelRange(it.second.size())),
-            MultiChannelType<double>::Parameters(),
+            typename MultiChannelType<T>::Parameters(),
             PortOutPolicy(SlotRange(1), BUFFER_SIZE, WAIT_STRATEGY));
     }
 }
 
 void Distributor::CompleteStreamInfo() {
-    incoming_batch_size_ = input_port_->streaminfo(0).parameters().nsamples;
-    max_n_channels_ = input_port_->streaminfo(0).parameters().nchannels;
+    dispatch_sample_type<double, float, int16_t>(
+        sample_type_(),
+        [this](auto x) { CompleteTypedStreamInfo<decltype(x)>(); });
+}
+
+template <typename T> void Distributor::CompleteTypedStreamInfo() {
+    auto input_port = static_cast<PortIn<MultiChannelType<T>> *>(input_port_);
+
+    incoming_batch_size_ = input_port->streaminfo(0).parameters().nsamples;
+    max_n_channels_ = input_port->streaminfo(0).parameters().nchannels;
 
     LOG(INFO) << name() << ". Incoming batch size: " << incoming_batch_size_
               << ".";
 
     for (auto &it : data_ports_) {
-        it.second->streaminfo(0).set_parameters(
-            MultiChannelType<double>::Parameters(
+        auto port = static_cast<PortOut<MultiChannelType<T>> *>(it.second);
+        port->streaminfo(0).set_parameters(
+            typename MultiChannelType<T>::Parameters(
                 channelmap_().at(it.first).size(), incoming_batch_size_,
-                input_port_->streaminfo(0).parameters().sample_rate));
+                input_port->streaminfo(0).parameters().sample_rate,
+                input_port->streaminfo(0).parameters().sample_scale));
 
-        it.second->streaminfo(0).set_stream_rate(
-            input_port_->streaminfo(0).stream_rate());
+        port->streaminfo(0).set_stream_rate(
+            input_port->streaminfo(0).stream_rate());
     }
 }
 
@@ -79,23 +98,37 @@ void Distributor::Prepare(GlobalContext &context) {
 }
 
 void Distributor::Process(ProcessingContext &context) {
-    MultiChannelType<double>::Data *data_in = nullptr;
+    dispatch_sample_type<double, float, int16_t>(sample_type_(), [&](auto x) {
+        ProcessSamples<decltype(x)>(context);
+    });
+}
+
+template <typename T>
+void Distributor::ProcessSamples(ProcessingContext &context) {
+    auto input_port = static_cast<PortIn<MultiChannelType<T>> *>(input_port_);
+    std::vector<PortOut<MultiChannelType<T>> *> output_ports;
+    for (auto const &it : data_ports_) {
+        output_ports.push_back(
+            static_cast<PortOut<MultiChannelType<T>> *>(it.second));
+    }
+
+    typename MultiChannelType<T>::Data *data_in = nullptr;
     int port_index;
     unsigned int ch, s;
-    std::vector<MultiChannelType<double>::Data *> data_out_vector(
+    std::vector<typename MultiChannelType<T>::Data *> data_out_vector(
         data_ports_.size());
 
     while (!context.terminated()) {
         // retrieve new data packet
-        if (!input_port_->slot(0)->RetrieveData(data_in)) {
+        if (!input_port->slot(0)->RetrieveData(data_in)) {
             break;
         }
 
         // claim output data buckets
         // and copy timestamps from upstream
         port_index = 0;
-        for (auto const &it : data_ports_) {
-            data_out_vector[port_index] = it.second->slot(0)->ClaimData(false);
+        for (auto const &port : output_ports) {
+            data_out_vector[port_index] = port->slot(0)->ClaimData(false);
             data_out_vector[port_index]->set_hardware_timestamp(
                 data_in->hardware_timestamp());
             data_out_vector[port_index]->set_source_timestamp(
@@ -119,11 +152,11 @@ void Distributor::Process(ProcessingContext &context) {
         }
 
         // publish data buckets
-        for (auto &it : data_ports_) {
-            it.second->slot(0)->PublishData();
+        for (auto &port : output_ports) {
+            port->slot(0)->PublishData();
         }
         // release input data bucket
-        input_port_->slot(0)->ReleaseData();
+        input_port->slot(0)->ReleaseData();
     }
 }
 
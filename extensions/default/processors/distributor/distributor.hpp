@@ -39,10 +39,16 @@ class Distributor : public IProcessor {
     void Process(ProcessingContext &context) override;
     void Postprocess(ProcessingContext &context) override;
 
-    // PORTS
+    // METHODS
   protected:
-    PortIn<MultiChannelType<double>> *input_port_;
-    std::map<std::string, PortOut<MultiChannelType<double>> *> data_ports_;
+    template <typename T> void CreateTypedPorts();
+    template <typename T> void CompleteTypedStreamInfo();
+    template <typename T> void ProcessSamples(ProcessingContext &context);
+
+    // PORTS (element type selected by the data type option)
+  protected:
+    IPortIn *input_port_;
+    std::map<std::string, IPortOut *> data_ports_;
 
     // variables
   protected:
@@ -59,4 +65,5 @@ class Distributor : public IProcessor {
     // OPTIONS
   protected:
     options::Value<ChannelMap, false> channelmap_;
+    options::Value<SampleType, false> sample_type_{SampleType::FLOAT64};
 };
@@ -36,6 +36,11 @@ void EventConverter::CreatePorts() {
         PortOutPolicy(SlotRange(1)));
 }
 
+void EventConverter::Preprocess(ProcessingContext &context) {
+    event_id_ = EventNames::intern(event_name_());
+    appended_ids_.clear();
+}
+
 void EventConverter::Process(ProcessingContext &context) {
     EventType::Data *data_in = nullptr;
     EventType::Data *data_out = nullptr;
@@ -49,9 +54,19 @@ void EventConverter::Process(ProcessingContext &context) {
         data_out->set_hardware_timestamp(data_in->hardware_timestamp());
 
         if (replace_()) {
-            data_out->set_event(event_name_());
+            data_out->set_event(event_id_);
         } else {
-            data_out->set_event(data_in->event() + event_name_());
+            // the appended name is interned only the first time an incoming
+            // event is seen
+            auto it = appended_ids_.find(data_in->id());
+            if (it == appended_ids_.end()) {
+                it = appended_ids_
+                         .emplace(data_in->id(),
+                                  EventNames::intern(data_in->event() +
+                                                     event_name_()))
+                         .first;
+            }
+            data_out->set_event(it->second);
         }
         data_in_port_->slot(0)->ReleaseData();
         data_out->set_source_timestamp();
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 
 #include "eventdata/eventdata.hpp"
 #include "iprocessor.hpp"
@@ -29,6 +30,7 @@ class EventConverter : public IProcessor {
   public:
     EventConverter();
     void CreatePorts() override;
+    void Preprocess(ProcessingContext &context) override;
     void Process(ProcessingContext &context) override;
     void Postprocess(ProcessingContext &context) override;
 
@@ -42,4 +44,10 @@ class EventConverter : public IProcessor {
     options::String event_name_{"stimulation",
                                 options::notempty<std::string>()};
     options::Bool replace_{true};
+
+    // VARIABLES
+  protected:
+    EventIDType event_id_;
+    // incoming event ID to ID of the name with event_name_ appended
+    std::unordered_map<EventIDType, EventIDType> appended_ids_;
 };
\ No newline at end of file
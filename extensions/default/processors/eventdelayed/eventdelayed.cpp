@@ -19,6 +19,8 @@
 
 #include "eventdelayed.hpp"
 
+#include <algorithm>
+
 EventDelayed::EventDelayed() : delayed_range_(150, 200) {
     add_option(DISABLED_S, default_disabled_,
                "Enable the processing of incoming events.");
@@ -117,8 +119,8 @@ void EventDelayed::Configure(const GlobalContext &context) {
 }
 
 void EventDelayed::CreatePorts() {
-    data_in_port_ = create_input_port<EventType>(
-        EventType::Capabilities(), PortInPolicy(SlotRange(1), false, 1));
+    data_in_port_ = create_input_port<EventType>(EventType::Capabilities(),
+                                                 PortInPolicy(SlotRange(1)));
 
     output_port_ = create_output_port<EventType>(
         EventType::Capabilities(), EventType::Parameters(DEFAULT_EVENT),
@@ -150,12 +152,14 @@ void EventDelayed::Preprocess(ProcessingContext &context) {
     ontime_received_event_ = 0;
     delayed_received_event_ = 0;
     event_lockout_ = 0;
+    ndropped_ = 0;
 
     // initialize enough if the past to be sure the first stimulation won't be
     // lockout
     previous_TS_nostim_ =
         Clock::now() -
         std::chrono::milliseconds((long int)stop_detection_period_->get() + 10);
+    analysis_lockout_end_ = Clock::now();
 
     std::string path = context.resolve_path("run://", "run");
     std::string filepath = path + name();
@@ -163,6 +167,19 @@ void EventDelayed::Preprocess(ProcessingContext &context) {
     create_file(filepath, prefix_() + msg_delayed_());
     create_file(filepath, prefix_() + msg_detection_());
     create_file(filepath, prefix_() + msg_ontime_());
+
+    delayed_id_ = EventNames::intern(msg_delayed_());
+    detection_id_ = EventNames::intern(msg_detection_());
+    ontime_id_ = EventNames::intern(msg_ontime_());
+
+    event_streams_.clear();
+    for (auto id : {delayed_id_, detection_id_, ontime_id_}) {
+        event_streams_[id] = streams_[prefix_() + EventNames::name(id)].get();
+    }
+
+    timers_ = &context.run().global().timers();
+    delayed_event_queue_ = decltype(delayed_event_queue_)();
+    delivery_jitter_.Reset();
 }
 
 void EventDelayed::Process(ProcessingContext &context) {
@@ -173,55 +190,10 @@ void EventDelayed::Process(ProcessingContext &context) {
     std::uniform_int_distribution<> distrib(delayed_range_.lower(),
                                             delayed_range_.upper());
 
+    // delayed events and analysis lockouts are scheduled on the timer
+    // service, so this thread only needs to wait for incoming events
     while (!context.terminated()) {
 
-        // This part is about sending out delayed events
-        while (!delayed_event_queue_.empty() and
-               delayed_event_queue_.top().ts < Clock::now()) {
-            auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
-                              Clock::now() - delayed_event_queue_.top().ts)
-                              .count();
-
-            LOG(DEBUG) << name() << ". Time to sent a delayed event ("
-                       << delayed_event_queue_.top().data_in->event()
-                       << ") with " << millis << "ms late.";
-
-            send_event(delayed_event_queue_.top().data_in, msg_delayed_());
-            delayed_event_queue_.pop();
-        }
-
-        // This part is about triggering delayed lock-out
-        while (!lockout_queue_.empty() and
-               lockout_queue_.top().ts < Clock::now()) {
-
-            LOG(DEBUG) << name()
-                       << ". Start a lockout after stimulation for " +
-                              std::to_string(
-                                  (long int)stop_analysis_period_->get()) +
-                              " ms.";
-            // stop detecting in the ripple detector
-            analysis_unlocked_->set(false);
-
-            // buzy sleep has no detections should be received and not
-            // stimulation should be sent during this time.
-            std::this_thread::sleep_for(std::chrono::milliseconds(
-                (long int)stop_analysis_period_->get()));
-            analysis_unlocked_->set(true);
-            lockout_queue_.pop();
-
-            while (!delayed_event_queue_.empty() and
-                   delayed_event_queue_.top().ts <
-                       Clock::now()) { // Remove any stimulations which would
-                                       // have happened during the
-                                       // detection/stimulation lockout
-                LOG(DEBUG) << name() << "The stimulation of this "
-                           << delayed_event_queue_.top().data_in->event()
-                           << " has been locked-out due to the detection "
-                              "lockout after stimulation.";
-                delayed_event_queue_.pop();
-            }
-        }
-
         if (!data_in_port_->slot(0)->RetrieveData(data_in)) {
             break;
         }
@@ -232,6 +204,24 @@ void EventDelayed::Process(ProcessingContext &context) {
             data_in_port_->slot(0)->ReleaseData();
             continue;
         }
+
+        // decide on the event to send while holding the state shared with
+        // the timer callbacks, but send it after releasing the lock, so that
+        // waiting for the output does not stall the shared timer thread
+        bool send = false;
+        EventIDType send_id = detection_id_;
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        // no detections and stimulations during the analysis lockout
+        if (Clock::now() < analysis_lockout_end_) {
+            LOG(DEBUG) << name() << data_in->event()
+                       << " has been locked-out due to the detection "
+                          "lockout after stimulation.";
+            ++event_lockout_;
+            data_in_port_->slot(0)->ReleaseData();
+            continue;
+        }
+
         // If not stimulation disabled
         if (!disabled_->get()) {
             int wait_time = distrib(generator_);
@@ -247,14 +237,16 @@ void EventDelayed::Process(ProcessingContext &context) {
                 if ((not start_after_stimulation_() or
                      not to_lock_out_in_future(delay)) and
                     (not start_after_detection_() or not to_lock_out())) {
-                    Delayed event(delay, data_in);
+                    Delayed event(delay, data_in->hardware_timestamp(),
+                                  data_in->serial_number());
                     delayed_event_queue_.push(event);
-                    send_event(data_in, msg_detection_());
+                    schedule(delay, [this, event]() { send_delayed(event); });
+                    send = true;
+                    send_id = detection_id_;
                     for (auto time_to_start : when_stop_analysis_period_()) {
-                        Delayed event_lockout(
-                            delay + std::chrono::milliseconds(time_to_start),
-                            data_in);
-                        lockout_queue_.push(event_lockout);
+                        schedule(delay +
+                                     std::chrono::milliseconds(time_to_start),
+                                 [this]() { start_analysis_lockout(); });
                     }
 
                 } else {
@@ -269,13 +261,12 @@ void EventDelayed::Process(ProcessingContext &context) {
                 if (not(start_after_detection_() or
                         start_after_stimulation_()) or
                     not to_lock_out()) {
-                    send_event(data_in, msg_ontime_());
+                    send = true;
+                    send_id = ontime_id_;
                     for (auto time_to_start : when_stop_analysis_period_()) {
-                        Delayed event_lockout(
-                            data_in->source_timestamp() +
-                                std::chrono::milliseconds(time_to_start),
-                            data_in);
-                        lockout_queue_.push(event_lockout);
+                        schedule(data_in->source_timestamp() +
+                                     std::chrono::milliseconds(time_to_start),
+                                 [this]() { start_analysis_lockout(); });
                     }
                 } else {
                     LOG(DEBUG) << name() << data_in->event()
@@ -287,42 +278,151 @@ void EventDelayed::Process(ProcessingContext &context) {
         } else {
             ++ontime_received_event_;
             if (not start_after_detection_() or not to_lock_out()) {
-                send_event(data_in, msg_detection_());
+                send = true;
+                send_id = detection_id_;
             } else {
                 LOG(DEBUG) << name() << data_in->event()
                            << " has been locked-out in disable mode";
                 ++event_lockout_;
             }
         }
+        lock.unlock();
+
+        if (send) {
+            send_event(data_in->hardware_timestamp(), data_in->serial_number(),
+                       send_id);
+        }
         data_in_port_->slot(0)->ReleaseData();
     }
 }
 
-void EventDelayed::send_event(EventType::Data *data_in, std::string type) {
+void EventDelayed::schedule(TimePoint deadline, std::function<void()> f) {
+    // the key lets Postprocess cancel the timers that are still pending and
+    // lets callbacks that were already running at that point bail out
+    uint64_t key = next_timer_key_++;
+    pending_timers_[key] = timers_->Schedule(deadline, [this, key, f]() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_timers_.erase(key) > 0) {
+            f();
+        }
+    });
+}
 
-    LOG(INFO) << name() << ". Sent one event: " << type;
-    EventType::Data *data_out = output_port_->slot(0)->ClaimData(true);
-    data_out->set_hardware_timestamp(data_in->hardware_timestamp());
+void EventDelayed::send_delayed(const Delayed &event) {
+    auto late = Clock::now() - event.ts;
+    delayed_event_queue_.pop();
+
+    // Remove any stimulations which would have happened during the
+    // detection/stimulation lockout
+    if (Clock::now() < analysis_lockout_end_) {
+        LOG(DEBUG) << name() << ". The stimulation of event "
+                   << event.serial_number
+                   << " has been locked-out due to the detection lockout "
+                      "after stimulation.";
+        return;
+    }
+
+    delivery_jitter_.Record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(late).count());
+    LOG(DEBUG) << name() << ". Sent a delayed event "
+               << std::chrono::duration_cast<std::chrono::microseconds>(late)
+                      .count()
+               << " us late.";
+
+    // the processing thread holds output_mutex_ only to claim and publish an
+    // event, if it is taken, the processing thread is most likely waiting for
+    // a free item in the full output buffer
+    {
+        std::unique_lock<std::mutex> output_lock(output_mutex_,
+                                                 std::try_to_lock);
+        EventType::Data *data_out =
+            output_lock.owns_lock() ? output_port_->slot(0)->TryClaimData(true)
+                                    : nullptr;
+        if (data_out == nullptr) {
+            LOG_IF(WARNING, ndropped_ == 0)
+                << name() << ". Output buffer is full, dropped delayed event "
+                << event.serial_number << ".";
+            ++ndropped_;
+            return;
+        }
+        publish_event(data_out, event.hardware_timestamp, delayed_id_);
+    }
+    save_event(event.serial_number, delayed_id_);
+}
 
+void EventDelayed::start_analysis_lockout() {
+    LOG(DEBUG) << name()
+               << ". Start a lockout after stimulation for " +
+                      std::to_string((long int)stop_analysis_period_->get()) +
+                      " ms.";
+    // stop detecting in the ripple detector; no detections should be received
+    // and no stimulation should be sent during this time.
+    analysis_unlocked_->set(false);
+    analysis_lockout_end_ = std::max(
+        analysis_lockout_end_,
+        Clock::now() + std::chrono::milliseconds(
+                           (long int)stop_analysis_period_->get()));
+    schedule(analysis_lockout_end_, [this]() {
+        // overlapping lockouts end with the last one
+        if (Clock::now() >= analysis_lockout_end_) {
+            analysis_unlocked_->set(true);
+        }
+    });
+}
+
+void EventDelayed::send_event(uint64_t hardware_timestamp,
+                              uint64_t serial_number, EventIDType type) {
+    {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        publish_event(output_port_->slot(0)->ClaimData(true),
+                      hardware_timestamp, type);
+    }
+    save_event(serial_number, type);
+}
+
+void EventDelayed::publish_event(EventType::Data *data_out,
+                                 uint64_t hardware_timestamp,
+                                 EventIDType type) {
+    data_out->set_hardware_timestamp(hardware_timestamp);
     data_out->set_event(type);
     data_out->set_source_timestamp();
     output_port_->slot(0)->PublishData();
+}
+
+void EventDelayed::save_event(uint64_t serial_number, EventIDType type) {
+    LOG(INFO) << name() << ". Sent one event: " << EventNames::name(type);
 
     if (save_events_()) { // save stim events to disk
-        uint64_t serial_number = data_in->serial_number();
-        LOG(DEBUG) << prefix_() << type;
-        streams_[prefix_() + type]->write(
+        LOG(DEBUG) << prefix_() << EventNames::name(type);
+        event_streams_[type]->write(
             reinterpret_cast<const char *>(&serial_number),
             sizeof(decltype(serial_number)));
     }
 }
 
 void EventDelayed::Postprocess(ProcessingContext &context) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &it : pending_timers_) {
+            timers_->Cancel(it.second);
+        }
+        pending_timers_.clear();
+        analysis_unlocked_->set(true);
+    }
 
     auto msg = "Successfully executed conversion protocol: " +
-               std::to_string(ontime_received_event_) + "ontime and " +
+               std::to_string(ontime_received_event_) + " ontime and " +
                std::to_string(delayed_received_event_) + " delayed with " +
                std::to_string(event_lockout_) + " events locked out.";
+    LOG(INFO) << name() << ". " << msg;
+    LOG_IF(WARNING, ndropped_ > 0)
+        << name() << ". " << ndropped_
+        << " events were dropped because the output buffer was full.";
+
+    if (delivery_jitter_.count() > 0) {
+        LOG(INFO) << name() << ". Delivery jitter of delayed events: "
+                  << delivery_jitter_.summary();
+    }
 
     ontime_received_event_ = 0;
     delayed_received_event_ = 0;
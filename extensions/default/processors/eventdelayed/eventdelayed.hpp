@@ -22,18 +22,25 @@
 #include "eventconverter/eventconverter.hpp"
 #include "eventdata/eventdata.hpp"
 #include "iprocessor.hpp"
+#include "latencyhistogram.hpp"
 #include "utilities/general.hpp"
 #include "utilities/math_numeric.hpp"
 #include "utilities/time.hpp"
+#include "utilities/timerwheel.hpp"
+#include <functional>
+#include <mutex>
 #include <queue>
 #include <string>
+#include <unordered_map>
 
 struct Delayed {
     TimePoint ts;
-    EventType::Data *data_in;
+    uint64_t hardware_timestamp;
+    uint64_t serial_number;
 
-    Delayed(TimePoint ts, EventType::Data *data_in)
-        : ts(ts), data_in(data_in) {}
+    Delayed(TimePoint ts, uint64_t hardware_timestamp, uint64_t serial_number)
+        : ts(ts), hardware_timestamp(hardware_timestamp),
+          serial_number(serial_number) {}
     bool operator>(const Delayed &test) const { return (ts > test.ts); }
 };
 
@@ -94,21 +101,56 @@ class EventDelayed : public IProcessor {
         {150, 200}};
 
   private:
-    void send_event(EventType::Data *data_in, std::string type);
+    // sends an event from the processing thread, waiting for a free item in
+    // the output ring buffer; must be called without holding mutex_
+    void send_event(uint64_t hardware_timestamp, uint64_t serial_number,
+                    EventIDType type);
+    // fills and publishes a claimed event, expects output_mutex_ to be held
+    void publish_event(EventType::Data *data_out, uint64_t hardware_timestamp,
+                       EventIDType type);
+    // each event type is only sent by one thread, so its stream is written
+    // without lock
+    void save_event(uint64_t serial_number, EventIDType type);
+
+    // the methods below expect mutex_ to be held; timer callbacks acquire it.
+    // They run on the timer thread shared by all processors and therefore
+    // never wait for downstream processors: if the output ring buffer is
+    // full, or the processing thread is waiting for it, a delayed event is
+    // dropped and counted instead
+    void schedule(TimePoint deadline, std::function<void()> f);
+    void send_delayed(const Delayed &event);
+    void start_analysis_lockout();
+
     // variables
   protected:
     uint64_t ontime_received_event_;
     uint64_t delayed_received_event_;
     uint64_t event_lockout_;
+    uint64_t ndropped_;
+
+    // interned output events and the streams their serial numbers are saved to
+    EventIDType delayed_id_;
+    EventIDType detection_id_;
+    EventIDType ontime_id_;
+    std::unordered_map<EventIDType, std::ostream *> event_streams_;
 
     Range<long int> delayed_range_;
     TimePoint previous_TS_nostim_;
 
+    // delayed events that have not been sent yet
     std::priority_queue<Delayed, std::vector<Delayed>, std::greater<Delayed>>
         delayed_event_queue_;
+    TimePoint analysis_lockout_end_;
 
-    std::priority_queue<Delayed, std::vector<Delayed>, std::greater<Delayed>>
-        lockout_queue_;
+    TimerWheel *timers_;
+    std::mutex mutex_;
+    // serializes the claims of the processing and timer threads on the
+    // single producer output slot
+    std::mutex output_mutex_;
+    uint64_t next_timer_key_ = 0;
+    std::unordered_map<uint64_t, TimerWheel::TimerID> pending_timers_;
+    // lateness of delayed events with respect to their scheduled time
+    LatencyHistogram delivery_jitter_;
 
     // CONSTANT
   protected:
@@ -23,7 +23,6 @@
 #include <chrono>
 #include <limits>
 #include <string>
-#include <thread>
 #include <vector>
 
 void DetectionCriterionValue::from_yaml(const YAML::Node &node) {
@@ -103,16 +102,18 @@ void EventFilter::Prepare(GlobalContext &context) {
 void EventFilter::Preprocess(ProcessingContext &context) {
     // init gate_close_time, but make sure the first event won't be excluded
     // if no blocking event will be received
-    gate_close_time_ = Clock::now();
-    if (blockout_time_() > 0) {
-        std::this_thread::sleep_for(
-            std::chrono::milliseconds(static_cast<int>(blockout_time_())));
-    }
+    gate_close_time_ =
+        Clock::now() - std::chrono::duration_cast<Clock::duration>(
+                           std::chrono::duration<double, std::milli>(
+                               blockout_time_() + 1.0));
     n_blocked_events_ = 0;
+    n_dropped_events_ = 0;
+    timers_ = &context.run().global().timers();
+    emission_pending_ = false;
+    emission_lateness_.Reset();
 }
 
 void EventFilter::Process(ProcessingContext &context) {
-    EventType::Data *data_out = nullptr;
     bool alive = false;
     bool detection_criterion = false;
     bool event_received = false;
@@ -120,7 +121,6 @@ void EventFilter::Process(ProcessingContext &context) {
     bool detection_block = false;
     std::size_t slot_last = 0;
     bool gate_just_closed = false;
-    TimePoint t_detection;
 
     std::vector<TimePoint> arrival_times_per_slot_events(
         data_in_port_->number_of_slots(),
@@ -139,100 +139,135 @@ void EventFilter::Process(ProcessingContext &context) {
     // criterion? t_last - t <= time_in_ms
 
     while (!context.terminated()) {
-        if (!detection_criterion) {
-            // read input port for triggering events
-            std::tie(alive, event_received, slot_last) = is_there_target(
-                data_in_port_, event_counter_, arrival_times_per_slot_events,
-                arrival_hwTS_per_slot_events);
+        if (emission_pending_) {
+            // a target event is scheduled to be sent after block_wait_time_,
+            // in the mean time only blocking events are read, which cancel it
+            std::tie(alive, gate_just_closed, std::ignore) = is_there_target(
+                block_in_port_, blocking_events_counter_,
+                arrival_times_per_slot_blocking_events,
+                arrival_hwTS_per_slot_blocking_events);
 
             if (!alive) {
                 break;
             }
 
-            if (event_received) {
-                counter_to_detection = 0;
-                for (auto t : arrival_times_per_slot_events) {
-                    if (time_between(arrival_times_per_slot_events[slot_last],
-                                     t) < sync_time_()) {
-                        ++counter_to_detection;
-                    }
+            if (gate_just_closed) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (emission_pending_) {
+                    timers_->Cancel(emission_timer_);
+                    emission_pending_ = false;
+                    ++n_blocked_events_;
+                    LOG(UPDATE) << name() << ". Target event "
+                                << target_event_().event()
+                                << " was filtered out (blocking event "
+                                   "arrived after target).";
                 }
-                detection_criterion =
-                    (counter_to_detection >= detections_to_criterion_());
-                LOG(DEBUG) << name() << ". Detection criterion met.";
+                gate_close_time_ = Clock::now();
             }
+            continue;
+        }
 
-            // read input port for blocking events
-            std::tie(alive, detection_block, std::ignore) =
-                is_there_target(block_in_port_, blocking_events_counter_,
-                                arrival_times_per_slot_blocking_events,
-                                arrival_hwTS_per_slot_blocking_events);
+        // read input port for triggering events
+        std::tie(alive, event_received, slot_last) = is_there_target(
+            data_in_port_, event_counter_, arrival_times_per_slot_events,
+            arrival_hwTS_per_slot_events);
 
-            if (!alive) {
-                break;
-            }
+        if (!alive) {
+            break;
+        }
 
-            if (detection_block) {
-                gate_close_time_ = Clock::now();
-                detection_block = false;
+        if (event_received) {
+            counter_to_detection = 0;
+            for (auto t : arrival_times_per_slot_events) {
+                if (time_between(arrival_times_per_slot_events[slot_last], t) <
+                    sync_time_()) {
+                    ++counter_to_detection;
+                }
             }
+            detection_criterion =
+                (counter_to_detection >= detections_to_criterion_());
+            LOG(DEBUG) << name() << ". Detection criterion met.";
         }
 
-        if (detection_criterion) { // check again as flag might have just
-                                   // changed
-            t_detection = Clock::now();
+        // read input port for blocking events
+        std::tie(alive, detection_block, std::ignore) =
+            is_there_target(block_in_port_, blocking_events_counter_,
+                            arrival_times_per_slot_blocking_events,
+                            arrival_hwTS_per_slot_blocking_events);
+
+        if (!alive) {
+            break;
+        }
+
+        if (detection_block) {
+            gate_close_time_ = Clock::now();
+            detection_block = false;
+        }
+
+        if (detection_criterion) {
+            detection_criterion = false;
             // check if gate is closed
             if (time_since(gate_close_time_) <= blockout_time_()) {
                 ++n_blocked_events_;
-                detection_criterion = false;
                 LOG(UPDATE) << name() << ". Target event "
                             << target_event_().event() << " was filtered out.";
             } else {
-                // if open, before streaming the event on the output,
-                // check if blocking event is coming soon after the target event
-                // is received on the "events" port with this dedicated read
-                // loop read incoming blocking events for block_wait_time_ms_
-                while (time_since(t_detection) < block_wait_time_() &&
-                       detection_criterion) {
-                    std::tie(alive, gate_just_closed, std::ignore) =
-                        is_there_target(block_in_port_,
-                                        blocking_events_counter_,
-                                        arrival_times_per_slot_blocking_events,
-                                        arrival_hwTS_per_slot_blocking_events);
-
-                    if (!alive) {
-                        break;
-                    } // exit inner while loop
-
-                    if (gate_just_closed) {
-                        ++n_blocked_events_;
-                        LOG(UPDATE) << name() << ". Target event "
-                                    << target_event_().event()
-                                    << " was filtered out (blocking event "
-                                       "arrived after target).";
-                        detection_criterion = false;
-                        gate_close_time_ = Clock::now();
-                    }
-                }
-                if (!alive) {
-                    break;
-                } // break outer (context) while loop
-
-                if (!gate_just_closed) { // no post detection block
-                    // finally send event
-                    data_out = data_out_port_->slot(0)->ClaimData(false);
-                    data_out->set_hardware_timestamp(
-                        arrival_hwTS_per_slot_events[slot_last]);
-                    data_out->set_source_timestamp();
-                    data_out_port_->slot(0)->PublishData();
-                    detection_criterion = false;
-                }
+                // if open, schedule the event on the output after
+                // block_wait_time_, unless a blocking event arrives soon after
+                // the target event
+                std::lock_guard<std::mutex> lock(mutex_);
+                TimePoint deadline =
+                    Clock::now() +
+                    std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double, std::milli>(
+                            block_wait_time_()));
+                uint64_t hardware_timestamp =
+                    arrival_hwTS_per_slot_events[slot_last];
+                emission_pending_ = true;
+                emission_timer_ = timers_->Schedule(
+                    deadline, [this, deadline, hardware_timestamp]() {
+                        send_target(deadline, hardware_timestamp);
+                    });
             }
         }
     }
 }
 
+void EventFilter::send_target(TimePoint deadline,
+                              uint64_t hardware_timestamp) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!emission_pending_) {
+        return; // blocked or stopped in the mean time
+    }
+    emission_pending_ = false;
+
+    EventType::Data *data_out = data_out_port_->slot(0)->TryClaimData(false);
+    if (data_out == nullptr) {
+        LOG_IF(WARNING, n_dropped_events_ == 0)
+            << name() << ". Output buffer is full, dropped target event "
+            << target_event_().event() << ".";
+        ++n_dropped_events_;
+        return;
+    }
+    data_out->set_hardware_timestamp(hardware_timestamp);
+    data_out->set_source_timestamp();
+    data_out_port_->slot(0)->PublishData();
+
+    emission_lateness_.Record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             deadline)
+            .count());
+}
+
 void EventFilter::Postprocess(ProcessingContext &context) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (emission_pending_) {
+            timers_->Cancel(emission_timer_);
+            emission_pending_ = false;
+        }
+    }
+
     log_and_reset_counters(data_in_port_->name(), event_counter_);
     log_and_reset_counters(block_in_port_->name(), blocking_events_counter_);
 
@@ -243,6 +278,17 @@ void EventFilter::Postprocess(ProcessingContext &context) {
     LOG(INFO) << name() << ". " << n_blocked_events_
               << " target events were blocked.";
     n_blocked_events_ = 0;
+
+    LOG_IF(WARNING, n_dropped_events_ > 0)
+        << name() << ". " << n_dropped_events_
+        << " target events were dropped because the output buffer was full.";
+
+    if (emission_lateness_.count() > 0) {
+        LOG(INFO) << name()
+                  << ". Delay from the end of the block wait time to the "
+                     "publication of target events: "
+                  << emission_lateness_.summary();
+    }
 }
 
 std::tuple<bool, bool, std::size_t>
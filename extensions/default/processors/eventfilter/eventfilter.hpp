@@ -19,14 +19,18 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <limits>
+#include <mutex>
 #include <tuple>
 #include <vector>
 
 #include "eventsync/eventsync.hpp"
+#include "latencyhistogram.hpp"
 #include "options/options.hpp"
 #include "utilities/time.hpp"
+#include "utilities/timerwheel.hpp"
 
 class DetectionCriterionValue : public options::Value<SlotType, false> {
   public:
@@ -61,6 +65,12 @@ class EventFilter : public EventSync {
                     std::vector<TimePoint> &arrival_times,
                     std::vector<uint64_t> &arrival_timestamps);
 
+    // timer callback that sends the pending target event, unless it was
+    // blocked in the mean time. It runs on the timer thread shared by all
+    // processors, so it does not wait for a free item in the output buffer
+    // but drops and counts the event
+    void send_target(TimePoint deadline, uint64_t hardware_timestamp);
+
     // return time in milliseconds past from two given time points t1 and t2
     inline double time_between(TimePoint t2, TimePoint t1) {
         duration = t2 - t1;
@@ -83,6 +93,17 @@ class EventFilter : public EventSync {
     TimePoint gate_close_time_;
     std::chrono::duration<double, std::milli> duration;
 
+    // target event waiting for the block wait time, shared with the timer
+    // callback; the processing thread never waits while holding mutex_
+    TimerWheel *timers_;
+    std::mutex mutex_;
+    std::atomic<bool> emission_pending_{false};
+    TimerWheel::TimerID emission_timer_;
+    unsigned int n_dropped_events_;
+    // time from the end of the block wait time to the publication of target
+    // events
+    LatencyHistogram emission_lateness_;
+
     // CONSTANTS
   protected:
     const uint64_t NULL_TIMESTAMP = std::numeric_limits<uint64_t>::max();
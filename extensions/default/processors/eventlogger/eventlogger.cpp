@@ -41,11 +41,11 @@ void EventLogger::Process(ProcessingContext &context) {
 
         if (*data == target_event_()) {
             ++event_counter_.target;
-            LOG(UPDATE) << name() << ": received target event " << data->event()
-                        << ".";
+            FASTLOG(UPDATE, "{}: received target event {}.", name(),
+                    data->event());
         } else {
             ++event_counter_.non_target;
-            LOG(UPDATE) << name() << ": skipped event " << data->event() << ".";
+            FASTLOG(UPDATE, "{}: skipped event {}.", name(), data->event());
         }
         event_port_->slot(0)->ReleaseData();
     }
@@ -30,7 +30,9 @@ EventSource::EventSource() : IProcessor() {
 }
 
 void EventSource::Configure(const GlobalContext &context) {
+    event_ids_.clear();
     for (auto &el : event_list_()) {
+        event_ids_.push_back(EventNames::intern(el));
         LOG(INFO) << name() << ". Event " << el << " configured for streaming.";
     }
 
@@ -64,7 +66,7 @@ void EventSource::Process(ProcessingContext &context) {
         data->set_hardware_timestamp(static_cast<uint64_t>(
             data->time_since(context.run().start_time()).count()));
 
-        data->set_event(event_list_()[distribution(generator)]);
+        data->set_event(event_ids_[distribution(generator)]);
         event_port_->slot(0)->PublishData();
     }
 }
@@ -52,4 +52,6 @@ class EventSource : public IProcessor {
 
     options::Measurement<double> event_rate_{DEFAULT_EVENT_RATE, "Hz",
                                              options::positive<double>()};
+
+    std::vector<EventIDType> event_ids_;
 };
@@ -28,7 +28,8 @@
 
 FileSerializer::FileSerializer() : IProcessor() {
     add_option("path", path_, "Path (server-side) where to save data.");
-    add_option("encoding", encoding_, "Binary or YAML encoding.");
+    add_option("encoding", encoding_,
+               "Binary, packed, flatbuffer or YAML encoding.");
     add_option("format", format_,
                "Data format (none, full, headeronly, streamheader, compact).");
     add_option("overwrite", overwrite_, "Overwrite existing files.");
@@ -43,6 +44,32 @@ FileSerializer::FileSerializer() : IProcessor() {
                "Smoothly changes throttle level as threshold is reached "
                "(value between 0 and 1).");
     add_option("preamble", preamble_, "Add YAML preamble to file.");
+    add_option("io backend", io_backend_,
+               "Write files with system calls (sync) or with batched "
+               "asynchronous io_uring submissions (io_uring).");
+    add_option("write behind/enabled", write_behind_,
+               "Serialize into preallocated chunks that are written to file "
+               "by a background I/O thread.");
+    add_option("write behind/chunk size", write_behind_chunk_size_,
+               "Size of a write-behind chunk in MiB.");
+    add_option("write behind/queue depth", write_behind_queue_depth_,
+               "Number of write-behind chunks that can be waiting to be "
+               "written.");
+    add_option("write behind/direct io", write_behind_direct_io_,
+               "Write chunks with O_DIRECT, bypassing the page cache.");
+    add_option("packed/step", packed_step_,
+               "Quantization step of samples in packed encoding (e.g. AD "
+               "bit value in microvolts).");
+    add_option("chunked/enabled", chunked_,
+               "Write records in chunks with a trailing timestamp index for "
+               "random access.");
+    add_option("chunked/chunk size", chunk_size_,
+               "Size of the record data in a chunk in KiB.");
+    add_option("mmap/enabled", mmap_,
+               "Write files through a memory mapping of preallocated "
+               "extents.");
+    add_option("mmap/extent size", mmap_extent_size_,
+               "Size of the preallocated and mapped file extents in MiB.");
 }
 
 void FileSerializer::CreatePorts() {
@@ -57,25 +84,69 @@ void FileSerializer::Configure(const GlobalContext &context) {
     LOG(INFO) << "throttle enabled: " << throttle_();
     LOG(INFO) << "throttle threshold: " << throttle_threshold_();
     LOG(INFO) << "throttle smooth: " << throttle_smooth_();
+    if (write_behind_() && mmap_()) {
+        throw ProcessingConfigureError(
+            "Write behind and mmap storage cannot be enabled together.",
+            name());
+    }
+    if (mmap_()) {
+        LOG(INFO) << "mmap storage: extents of " << mmap_extent_size_()
+                  << " MiB";
+        LOG_IF(INFO, io_backend_() != IoBackend::SYNC)
+            << name() << ". io backend option is ignored with mmap storage.";
+    }
+    if (write_behind_()) {
+        LOG(INFO) << "write behind: " << write_behind_queue_depth_()
+                  << " chunks of " << write_behind_chunk_size_() << " MiB"
+                  << (write_behind_direct_io_() ? " (direct io)" : "");
+        LOG_IF(INFO, io_backend_() != IoBackend::SYNC)
+            << name() << ". io backend option is ignored with write behind.";
+    }
 }
 
 void FileSerializer::Preprocess(ProcessingContext &context) {
     // create serializer object
     serializer_.reset(Serialization::serializer(encoding_(), format_()));
+    if (encoding_() == Serialization::Encoding::PACKED) {
+        static_cast<Serialization::PackedSerializer *>(serializer_.get())
+            ->set_step(packed_step_());
+    }
 
     // initialization
     packetid_.assign(data_port_->number_of_slots(), 0);
     upstream_buffer_size_.assign(data_port_->number_of_slots(), 0);
     nskipped_.assign(data_port_->number_of_slots(), 0);
     throttle_level_ = 0;
+    flush_latency_.Reset();
+    nflushed_bytes_ = 0;
 
     // create output file streams
+    chunk_writers_.clear();
     streams_.clear();
+    writer_.reset();
+    if (write_behind_()) {
+        writer_.reset(new AsyncFileWriter(
+            static_cast<std::size_t>(write_behind_chunk_size_()) << 20,
+            write_behind_queue_depth_(), write_behind_direct_io_(),
+            [this](std::size_t nbytes, int64_t nanoseconds) {
+                flush_latency_.Record(nanoseconds);
+                nflushed_bytes_.fetch_add(nbytes, std::memory_order_relaxed);
+            }));
+    }
     std::string path = context.resolve_path(path_(), "run");
     std::string address;
     std::string filename;
     std::unique_ptr<std::ostream> stream;
 
+    bool use_io_uring =
+        !writer_ && !mmap_() && io_backend_() == IoBackend::IO_URING;
+    if (use_io_uring && !IoUring::supported()) {
+        LOG(WARNING) << name()
+                     << ". io_uring is not supported, falling back to "
+                        "system calls.";
+        use_io_uring = false;
+    }
+
     for (int k = 0; k < data_port_->number_of_slots(); k++) {
         address = data_port_->slot(k)->upstream_address().string();
         filename = path + "/" + name() + "." + std::to_string(k) + "_" +
@@ -87,8 +158,41 @@ void FileSerializer::Preprocess(ProcessingContext &context) {
                                   name());
         }
         // try to open file
-        stream = std::unique_ptr<std::ostream>(new std::ofstream(
-            filename, std::ofstream::out | std::ofstream::binary));
+        if (writer_) {
+            try {
+                stream = writer_->Open(filename);
+            } catch (std::runtime_error &e) {
+                throw ProcessingError("Error opening output file " + filename +
+                                          " (" + e.what() + ").",
+                                      name());
+            }
+        } else if (mmap_()) {
+            try {
+                stream = std::unique_ptr<std::ostream>(new MappedOfstream(
+                    filename,
+                    static_cast<std::size_t>(mmap_extent_size_()) << 20));
+            } catch (std::runtime_error &e) {
+                throw ProcessingError("Error opening output file " + filename +
+                                          " (" + e.what() + ").",
+                                      name());
+            }
+        } else if (use_io_uring) {
+            // setting up the ring can fail even if io_uring is supported
+            // (e.g. locked memory limit), use system calls in that case
+            try {
+                stream =
+                    std::unique_ptr<std::ostream>(new IoUringOfstream(filename));
+            } catch (std::runtime_error &e) {
+                LOG(WARNING) << name() << ". Unable to write " << filename
+                             << " through io_uring (" << e.what()
+                             << "), falling back to system calls.";
+                use_io_uring = false;
+            }
+        }
+        if (!stream) {
+            stream = std::unique_ptr<std::ostream>(new std::ofstream(
+                filename, std::ofstream::out | std::ofstream::binary));
+        }
 
         if (!stream->good()) {
             throw ProcessingError("Error opening output file " + filename + ".",
@@ -99,6 +203,11 @@ void FileSerializer::Preprocess(ProcessingContext &context) {
             create_preamble(*stream.get(), k);
         }
 
+        if (chunked_()) {
+            chunk_writers_.emplace_back(new ChunkedRecordWriter(
+                *stream, static_cast<std::size_t>(chunk_size_()) << 10));
+        }
+
         streams_.push_back(std::move(stream));
 
         LOG(DEBUG) << "Successfully opened output file for stream "
@@ -117,6 +226,9 @@ void FileSerializer::create_preamble(std::ostream &out, int slot) {
     node["interleaved"] = false;
     node["format"] = format_.to_yaml();
     node["encoding"] = encoding_.to_yaml();
+    if (chunked_()) {
+        node["container"] = "chunked";
+    }
     node["stream"] = slot;
     node["data"] = serializer_->DataDescription(
         data_port_->slot(slot)->GetDataPrototype());
@@ -127,6 +239,28 @@ void FileSerializer::create_preamble(std::ostream &out, int slot) {
     emit << YAML::EndDoc;
 }
 
+void FileSerializer::serialize(int slot, AnyType::Data *data) {
+    std::ostream *out = streams_[slot].get();
+    if (!chunk_writers_.empty()) {
+        if (chunk_writers_[slot]->BeginRecord(packetid_[slot],
+                                              data->hardware_timestamp())) {
+            serializer_->Restart(slot);
+        }
+        out = &chunk_writers_[slot]->stream();
+    }
+    auto &address = data_port_->slot(slot)->upstream_address();
+    serializer_->Serialize(*out, data, slot, packetid_[slot]++,
+                           address.processor(), address.port(),
+                           address.slot());
+}
+
+double FileSerializer::buffer_load(int slot, uint64_t nread) const {
+    if (writer_) {
+        return writer_->fill_level();
+    }
+    return static_cast<double>(nread) / upstream_buffer_size_[slot];
+}
+
 void FileSerializer::Process(ProcessingContext &context) {
     std::vector<AnyType::Data *> data;
 
@@ -147,22 +281,22 @@ void FileSerializer::Process(ProcessingContext &context) {
                 continue;
             }
 
+            if (writer_ && writer_->failed()) {
+                throw ProcessingError("Error writing output files.", name());
+            }
+
             if (!throttle_()) {
-                LOG_IF(WARNING, (nread > 0.5 * upstream_buffer_size_[k]))
+                LOG_IF(WARNING, (buffer_load(k, nread) > 0.5))
                     << name() << ": buffer is more than half full (stream " << k
                     << ")";
                 for (auto &it : data) {
-                    serializer_->Serialize(
-                        *(streams_[k]), it, k, packetid_[k]++,
-                        data_port_->slot(k)->upstream_address().processor(),
-                        data_port_->slot(k)->upstream_address().port(),
-                        data_port_->slot(k)->upstream_address().slot());
+                    serialize(k, it);
                 }
 
             } else {
                 // update throttle level
                 throttle_level_ *= (1 - throttle_smooth_());
-                if (nread > throttle_threshold_() * upstream_buffer_size_[k]) {
+                if (buffer_load(k, nread) > throttle_threshold_()) {
                     throttle_level_ += throttle_smooth_();
                 }
 
@@ -173,11 +307,7 @@ void FileSerializer::Process(ProcessingContext &context) {
                     (throttle_level_ < 0.5 && remainder > nread)) {
                     // keep all
                     for (auto &it : data) {
-                        serializer_->Serialize(
-                            *(streams_[k]), it, k, packetid_[k]++,
-                            data_port_->slot(k)->upstream_address().processor(),
-                            data_port_->slot(k)->upstream_address().port(),
-                            data_port_->slot(k)->upstream_address().slot());
+                        serialize(k, it);
                     }
                 } else if (throttle_level_ < 0.5) {
                     // skip small fraction
@@ -187,11 +317,7 @@ void FileSerializer::Process(ProcessingContext &context) {
                             nskipped_[k]++;
                             continue;
                         }
-                        serializer_->Serialize(
-                            *(streams_[k]), data[n], k, packetid_[k]++,
-                            data_port_->slot(k)->upstream_address().processor(),
-                            data_port_->slot(k)->upstream_address().port(),
-                            data_port_->slot(k)->upstream_address().slot());
+                        serialize(k, data[n]);
                     }
                 } else if (throttle_level_ == 1 ||
                            (throttle_level_ >= 0.5 && remainder > nread)) {
@@ -206,11 +332,7 @@ void FileSerializer::Process(ProcessingContext &context) {
                             nskipped_[k]++;
                             continue;
                         }
-                        serializer_->Serialize(
-                            *(streams_[k]), data[n], k, packetid_[k]++,
-                            data_port_->slot(k)->upstream_address().processor(),
-                            data_port_->slot(k)->upstream_address().port(),
-                            data_port_->slot(k)->upstream_address().slot());
+                        serialize(k, data[n]);
                     }
                 }
             }
@@ -220,9 +342,45 @@ void FileSerializer::Process(ProcessingContext &context) {
 }
 
 void FileSerializer::Postprocess(ProcessingContext &context) {
-    streams_.clear(); // forces destruction and closing of resources
+    // write the last chunks and the index
+    for (auto &writer : chunk_writers_) {
+        writer->Close();
+    }
+    chunk_writers_.clear();
+
+    for (std::size_t k = 0; k < streams_.size(); ++k) {
+        LOG_IF(ERROR, !streams_[k]->good())
+            << name() << ": error writing output file for stream " << k
+            << ".";
+    }
+    // forces destruction and closing of resources (memory mapped files are
+    // truncated to the length that was written)
+    streams_.clear();
+
+    if (encoding_() == Serialization::Encoding::PACKED) {
+        auto packed =
+            static_cast<Serialization::PackedSerializer *>(serializer_.get());
+        LOG_IF(UPDATE, packed->nraw() > 0)
+            << name() << ": " << packed->nraw() << " of "
+            << packed->nraw() + packed->npacked()
+            << " sample blocks could not be packed with step "
+            << packed_step_() << " and were stored raw.";
+    }
     serializer_.reset();
 
+    if (writer_) {
+        LOG(UPDATE) << name() << ": wrote " << (nflushed_bytes_ >> 20)
+                    << " MiB in " << flush_latency_.count()
+                    << " flushes. Flush latency: "
+                    << flush_latency_.summary();
+        LOG_IF(WARNING, writer_->nstalls() > 0)
+            << name() << ": waited " << writer_->nstalls()
+            << " times for a free write-behind chunk.";
+        LOG_IF(ERROR, writer_->failed())
+            << name() << ": error writing output files.";
+        writer_.reset();
+    }
+
     for (SlotType k = 0; k < data_port_->number_of_slots(); k++) {
         if (nskipped_[k] != 0) {
             LOG(UPDATE) << name() << ": stream " << k << ": received "
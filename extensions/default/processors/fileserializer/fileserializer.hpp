@@ -18,12 +18,19 @@
 // ---------------------------------------------------------------------
 
 #pragma once
+#include <atomic>
 #include <memory>
 #include <vector>
 
 #include "iprocessor.hpp"
+#include "latencyhistogram.hpp"
+#include "neuralynx/nlx.hpp"
 #include "options/options.hpp"
 #include "serializer.hpp"
+#include "utilities/asyncwriter.hpp"
+#include "utilities/chunkedrecording.hpp"
+#include "utilities/iouring.hpp"
+#include "utilities/mappedfile.hpp"
 
 class FileSerializer : public IProcessor {
     // CONSTRUCTOR and OVERLOADED METHODS
@@ -45,6 +52,23 @@ class FileSerializer : public IProcessor {
      */
     void create_preamble(std::ostream &out, int slot);
 
+    /* Serialize a data packet to the file of a slot (through the chunk
+     * writer if enabled)
+     *
+     * @input slot the slot number
+     * @input data the data packet
+     */
+    void serialize(int slot, AnyType::Data *data);
+
+    /* Fill level (fraction between 0 and 1) that drives throttling: the
+     * fraction of write-behind chunks in flight if enabled, otherwise the
+     * fill level of the upstream ring buffer
+     *
+     * @input slot the slot number
+     * @input nread number of packets available in the slot
+     */
+    double buffer_load(int slot, uint64_t nread) const;
+
     // DATA PORTS
   protected:
     PortIn<AnyType> *data_port_;
@@ -52,11 +76,15 @@ class FileSerializer : public IProcessor {
     // VARIABLES
   protected:
     std::unique_ptr<Serialization::Serializer> serializer_;
+    std::unique_ptr<AsyncFileWriter> writer_;
     std::vector<std::unique_ptr<std::ostream>> streams_;
+    std::vector<std::unique_ptr<ChunkedRecordWriter>> chunk_writers_;
     std::vector<uint64_t> packetid_;
     std::vector<unsigned int> upstream_buffer_size_;
     double throttle_level_;
     std::vector<uint64_t> nskipped_;
+    LatencyHistogram flush_latency_;
+    std::atomic<uint64_t> nflushed_bytes_;
 
     // OPTIONS
   protected:
@@ -70,4 +98,20 @@ class FileSerializer : public IProcessor {
     options::Double throttle_threshold_{0.3, options::inrange<double>(0., 1.)};
     options::Double throttle_smooth_{0.5, options::inrange<double>(0., 1.)};
     options::Bool preamble_{true};
+    options::Value<IoBackend, false> io_backend_{IoBackend::SYNC};
+    options::Bool write_behind_{false};
+    options::Value<unsigned int, false> write_behind_chunk_size_{
+        4, options::inrange<unsigned int>(1, 1024)};
+    options::Value<unsigned int, false> write_behind_queue_depth_{
+        8, options::inrange<unsigned int>(1, 1024)};
+    options::Bool write_behind_direct_io_{false};
+    // default is the AD bit value of Neuralynx Digilynx systems in microvolts
+    options::Double packed_step_{nlx::NLX_AD_BIT_MICROVOLTS,
+                                 options::positive<double>(true)};
+    options::Bool chunked_{false};
+    options::Value<unsigned int, false> chunk_size_{
+        1024, options::inrange<unsigned int>(4, 1 << 20)};
+    options::Bool mmap_{false};
+    options::Value<unsigned int, false> mmap_extent_size_{
+        64, options::inrange<unsigned int>(1, 4096)};
 };
@@ -19,6 +19,7 @@
 
 #include "multichannelfilter.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
 #include <string>
@@ -26,6 +27,13 @@
 
 MultiChannelFilter::MultiChannelFilter() : IProcessor() {
     add_option("filter", filter_def_, "Filter definition.", true);
+    add_option("worker threads", nworkers_,
+               "Number of threads that filter the input slots in parallel.");
+    add_option("worker cores", worker_cores_,
+               "Cores to pin the additional worker threads to.");
+    add_option("data type", sample_type_,
+               "Element type of the input and output samples (float64 or "
+               "float32).");
 }
 
 void MultiChannelFilter::Configure(const GlobalContext &context) {
@@ -36,18 +44,32 @@ void MultiChannelFilter::Configure(const GlobalContext &context) {
             filter_def_()["file"].as<std::string>(), "filters");
         filter_template_.reset(dsp::filter::construct_from_file(f));
     }
+
+    // FFT block processing of long FIR filters, also for filter files
+    auto fir = dynamic_cast<dsp::filter::FirFilter *>(filter_template_.get());
+    if (fir != nullptr && filter_def_()["fft threshold"]) {
+        fir->set_fft_threshold(
+            filter_def_()["fft threshold"].as<unsigned int>());
+    }
 }
 
 void MultiChannelFilter::CreatePorts() {
-    data_in_port_ = create_input_port<MultiChannelType<double>>(
+    dispatch_sample_type<double, float>(
+        sample_type_(), [this](auto x) { CreateTypedPorts<decltype(x)>(); });
+}
+
+template <typename T> void MultiChannelFilter::CreateTypedPorts() {
+    data_in_port_ = create_input_port<MultiChannelType<T>>(
         "data",
-        MultiChannelType<double>::Capabilities(ChannelRange(1, MAX_NCHANNELS)),
+        typename MultiChannelType<T>::Capabilities(
+            ChannelRange(1, MAX_NCHANNELS)),
         PortInPolicy(SlotRange(0, MAX_NCHANNELS)));
 
-    data_out_port_ = create_output_port<MultiChannelType<double>>(
+    data_out_port_ = create_output_port<MultiChannelType<T>>(
         "data",
-        MultiChannelType<double>::Capabilities(ChannelRange(1, MAX_NCHANNELS)),
-        MultiChannelType<double>::Parameters(),
+        typename MultiChannelType<T>::Capabilities(
+            ChannelRange(1, MAX_NCHANNELS)),
+        typename MultiChannelType<T>::Parameters(),
         PortOutPolicy(SlotRange(0, MAX_NCHANNELS)));
 }
 
@@ -63,15 +85,26 @@ void MultiChannelFilter::CompleteStreamInfo() {
         throw ProcessingStreamInfoError(err_msg, name());
     }
 
+    dispatch_sample_type<double, float>(sample_type_(), [this](auto x) {
+        CompleteTypedStreamInfo<decltype(x)>();
+    });
+}
+
+template <typename T> void MultiChannelFilter::CompleteTypedStreamInfo() {
     for (int k = 0; k < data_in_port_->number_of_slots(); ++k) {
-        data_out_port_->streaminfo(k).set_stream_rate(
-            data_in_port_->streaminfo(k).stream_rate());
-        data_out_port_->streaminfo(k).set_parameters(
-            data_in_port_->streaminfo(k).parameters());
+        data_out_port<T>()->streaminfo(k).set_stream_rate(
+            data_in_port<T>()->streaminfo(k).stream_rate());
+        data_out_port<T>()->streaminfo(k).set_parameters(
+            data_in_port<T>()->streaminfo(k).parameters());
     }
 }
 
 void MultiChannelFilter::Prepare(GlobalContext &context) {
+    dispatch_sample_type<double, float>(
+        sample_type_(), [this](auto x) { PrepareFilters<decltype(x)>(); });
+}
+
+template <typename T> void MultiChannelFilter::PrepareFilters() {
     // realize filter for each input slot, dependent on the number of channels
     // upstream is sending
     filters_.clear();
@@ -79,37 +112,102 @@ void MultiChannelFilter::Prepare(GlobalContext &context) {
         filters_.push_back(std::move(
             std::unique_ptr<dsp::filter::IFilter>(filter_template_->clone())));
         filters_.back()->realize(
-            data_in_port_->streaminfo(k).parameters().nchannels);
+            data_in_port<T>()->streaminfo(k).parameters().nchannels);
     }
 }
 
 void MultiChannelFilter::Process(ProcessingContext &context) {
-    MultiChannelType<double>::Data *data_in = nullptr;
-    MultiChannelType<double>::Data *data_out = nullptr;
-    auto nslots = data_in_port_->number_of_slots();
-    decltype(nslots) k = 0;
+    unsigned int nworkers = std::min<unsigned int>(
+        nworkers_(), data_in_port_->number_of_slots());
+
+    auto process_slots = [this, &context, nworkers](unsigned int worker) {
+        dispatch_sample_type<double, float>(
+            sample_type_(), [this, &context, worker, nworkers](auto x) {
+                ProcessSlots<decltype(x)>(context, worker, nworkers);
+            });
+    };
+
+    // the processor thread is the first worker, additional workers get the
+    // same priority and are pinned to the configured cores
+    std::vector<std::thread> workers;
+    for (unsigned int w = 1; w < nworkers; ++w) {
+        workers.emplace_back([&context, &process_slots, w]() {
+            try {
+                process_slots(w);
+            } catch (std::exception &e) {
+                context.TerminateWithError("Process", e.what());
+            }
+        });
+
+        if (!set_realtime_priority(workers.back().native_handle(),
+                                   thread_priority())) {
+            LOG(WARNING) << name() << ". Unable to set priority of worker "
+                         << w << ".";
+        }
+
+        ThreadCore core = CORE_NOT_PINNED;
+        if (w - 1 < worker_cores_().size()) {
+            core = worker_cores_()[w - 1];
+        }
+        if (!set_thread_core(workers.back().native_handle(), core)) {
+            LOG(WARNING) << name() << ". Unable to pin worker " << w
+                         << " to core " << core << ".";
+        } else if (core >= 0) {
+            LOG(INFO) << name() << ". Pinned worker " << w << " to core "
+                      << core << ".";
+        }
+    }
+
+    try {
+        process_slots(0);
+    } catch (std::exception &e) {
+        // workers waiting for data are woken up when the graph stops
+        context.TerminateWithError("Process", e.what());
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        throw;
+    }
+
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+template <typename T>
+void MultiChannelFilter::ProcessSlots(ProcessingContext &context,
+                                      unsigned int worker,
+                                      unsigned int nworkers) {
+    auto in_port = data_in_port<T>();
+    auto out_port = data_out_port<T>();
+    typename MultiChannelType<T>::Data *data_in = nullptr;
+    typename MultiChannelType<T>::Data *data_out = nullptr;
+    int nslots = data_in_port_->number_of_slots();
+    int k = 0;
 
     while (!context.terminated()) {
-        // go through all slots
-        for (k = 0; k < nslots; ++k) {
+        // go through all slots assigned to this worker; each slot is only
+        // handled by a single worker, so the order of buckets is preserved
+        for (k = worker; k < nslots; k += nworkers) {
             // retrieve new data
-            if (!data_in_port_->slot(k)->RetrieveData(data_in)) {
+            if (!in_port->slot(k)->RetrieveData(data_in)) {
                 break;
             }
 
             // claim output data buckets
-            data_out = data_out_port_->slot(k)->ClaimData(false);
+            data_out = out_port->slot(k)->ClaimData(false);
 
             // filter incoming data
             filters_[k]->process_by_channel(data_in->nsamples(),
-                                            data_in->data(), data_out->data());
+                                            data_in->data().data(),
+                                            data_out->data().data());
 
             data_out->set_sample_timestamps(data_in->sample_timestamps());
             data_out->CloneTimestamps(*data_in);
 
             // publish and release data
-            data_out_port_->slot(k)->PublishData();
-            data_in_port_->slot(k)->ReleaseData();
+            out_port->slot(k)->PublishData();
+            in_port->slot(k)->ReleaseData();
         }
     }
 }
@@ -24,6 +24,7 @@
 
 #include "iprocessor.hpp"
 #include "multichanneldata/multichanneldata.hpp"
+#include "threadutilities.hpp"
 #include <dsp/filter.hpp>
 
 class MultiChannelFilter : public IProcessor {
@@ -36,19 +37,41 @@ class MultiChannelFilter : public IProcessor {
     void Prepare(GlobalContext &context) override;
     void Process(ProcessingContext &context) override;
 
+  protected:
+    template <typename T> void CreateTypedPorts();
+    template <typename T> void CompleteTypedStreamInfo();
+    template <typename T> void PrepareFilters();
+
+    // filter the slots k for which k % nworkers == worker
+    template <typename T>
+    void ProcessSlots(ProcessingContext &context, unsigned int worker,
+                      unsigned int nworkers);
+
+    template <typename T> PortIn<MultiChannelType<T>> *data_in_port() {
+        return static_cast<PortIn<MultiChannelType<T>> *>(data_in_port_);
+    }
+    template <typename T> PortOut<MultiChannelType<T>> *data_out_port() {
+        return static_cast<PortOut<MultiChannelType<T>> *>(data_out_port_);
+    }
+
     // VARIABLES
   protected:
     std::unique_ptr<dsp::filter::IFilter> filter_template_;
     std::vector<std::unique_ptr<dsp::filter::IFilter>> filters_;
 
-    // DATA PORTS
+    // DATA PORTS (element type selected by the data type option)
   protected:
-    PortIn<MultiChannelType<double>> *data_in_port_;
-    PortOut<MultiChannelType<double>> *data_out_port_;
+    IPortIn *data_in_port_;
+    IPortOut *data_out_port_;
 
     // OPTIONS
   protected:
     options::Value<YAML::Node, false> filter_def_{};
+    options::Value<unsigned int, false> nworkers_{
+        1, options::positive<unsigned int>(true)};
+    options::Value<std::vector<ThreadCore>, false> worker_cores_{
+        std::vector<ThreadCore>{}};
+    options::Value<SampleType, false> sample_type_{SampleType::FLOAT64};
 
     const uint32_t MAX_NCHANNELS = 384;
 };
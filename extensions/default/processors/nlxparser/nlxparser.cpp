@@ -71,6 +71,19 @@ NlxParser::NlxParser() : IProcessor(PRIORITY_HIGH) {
         "missed packets will be filled with the last available batch of "
         "samples "
         "at each iteration.");
+    add_option("data type", sample_type_,
+               "Element type of the output samples: float64 or float32 "
+               "(microvolts), or int16 (raw AD values, saturated at about "
+               "+/- 512 uV).");
+}
+
+template <typename T> void NlxParser::CreateSignalPort() {
+    output_port_signal_ = create_output_port<MultiChannelType<T>>(
+        "data",
+        typename MultiChannelType<T>::Capabilities(
+            ChannelRange(1, nlx::NLX_MAX_NCHANNELS)),
+        typename MultiChannelType<T>::Parameters(),
+        PortOutPolicy(SlotRange(1), 500));
 }
 
 void NlxParser::CreatePorts() {
@@ -78,12 +91,8 @@ void NlxParser::CreatePorts() {
         "udp", VectorType<uint32_t>::Capabilities(),
         PortInPolicy(SlotRange(1)));
 
-    output_port_signal_ = create_output_port<MultiChannelType<double>>(
-        "data",
-        MultiChannelType<double>::Capabilities(
-            ChannelRange(1, nlx::NLX_MAX_NCHANNELS)),
-        MultiChannelType<double>::Parameters(),
-        PortOutPolicy(SlotRange(1), 500));
+    dispatch_sample_type<double, float, int16_t>(
+        sample_type_(), [this](auto x) { CreateSignalPort<decltype(x)>(); });
 
     output_port_ttl_ = create_output_port<MultiChannelType<uint32_t>>(
         "ttl", MultiChannelType<uint32_t>::Capabilities(ChannelRange(1)),
@@ -104,13 +113,14 @@ void NlxParser::CompleteStreamInfo() {
 
     nlxrecord_.set_nchannels(nchannels_);
 
-    output_port_signal_->streaminfo(0).set_parameters(
-        MultiChannelType<double>::Parameters(
-            nchannels_, batch_size_(),
-            data_in_port_->slot(0)->streaminfo().stream_rate()));
-
-    output_port_signal_->streaminfo(0).set_stream_rate(
-        data_in_port_->slot(0)->streaminfo().stream_rate() / batch_size_());
+    double stream_rate = data_in_port_->slot(0)->streaminfo().stream_rate();
+    dispatch_sample_type<double, float, int16_t>(sample_type_(), [&](auto x) {
+        auto port = output_port_signal<decltype(x)>();
+        port->streaminfo(0).set_parameters(nsMultiChannel::Parameters(
+            nchannels_, batch_size_(), stream_rate,
+            nlx::sample_scale<decltype(x)>()));
+        port->streaminfo(0).set_stream_rate(stream_rate / batch_size_());
+    });
 
     output_port_ttl_->streaminfo(0).set_parameters(
         MultiChannelType<double>::Parameters(
@@ -139,14 +149,21 @@ void NlxParser::Preprocess(ProcessingContext &context) {
 }
 
 void NlxParser::Process(ProcessingContext &context) {
+    dispatch_sample_type<double, float, int16_t>(sample_type_(), [&](auto x) {
+        ProcessPackets<decltype(x)>(context);
+    });
+}
+
+template <typename T>
+void NlxParser::ProcessPackets(ProcessingContext &context) {
+    auto signal_port = output_port_signal<T>();
     bool update_time = false;
     unsigned int i = 0;
     int b = 0;
     decltype(n_filling_packets_) packets_lag = 0;
 
     VectorType<uint32_t>::Data *data_in = nullptr;
-    MultiChannelType<double>::Data::sample_iterator data_iter;
-    MultiChannelType<double>::Data *data_out = nullptr;
+    typename MultiChannelType<T>::Data *data_out = nullptr;
     MultiChannelType<uint32_t>::Data *ttl_data_out = nullptr;
 
     while (!context.terminated()) {
@@ -208,7 +225,7 @@ void NlxParser::Process(ProcessingContext &context) {
         print_stats(update_time);
 
         if (sample_counter_ == batch_size_()) {
-            data_out = output_port_signal_->slot(0)->ClaimData(false);
+            data_out = signal_port->slot(0)->ClaimData(false);
             data_out->set_hardware_timestamp(timestamp_);
             ttl_data_out = output_port_ttl_->slot(0)->ClaimData(false);
             ttl_data_out->set_hardware_timestamp(timestamp_);
@@ -218,17 +235,14 @@ void NlxParser::Process(ProcessingContext &context) {
         // copy data from current packet onto buffer for each channel
         data_out->set_sample_timestamp(sample_counter_, timestamp_);
         ttl_data_out->set_sample_timestamp(sample_counter_, timestamp_);
-        data_iter = data_out->begin_sample(sample_counter_);
-        for (auto &channel : channel_list_) {
-            (*data_iter) = nlxrecord_.sample_microvolt(channel);
-            ++data_iter;
-        }
+        nlxrecord_.samples(channel_list_.data(), channel_list_.size(),
+                           data_out->begin_sample(sample_counter_));
         ttl_data_out->set_data_sample(sample_counter_, 0,
                                       nlxrecord_.parallel_port());
         ++sample_counter_;
 
         if (sample_counter_ == batch_size_()) {
-            output_port_signal_->slot(0)->PublishData();
+            signal_port->slot(0)->PublishData();
             output_port_ttl_->slot(0)->PublishData();
         }
 
@@ -237,7 +251,7 @@ void NlxParser::Process(ProcessingContext &context) {
             packets_lag = stats_.n_missed - n_filling_packets_;
             if (packets_lag >= batch_size_()) {
                 for (b = 0; b < packets_lag / batch_size_(); ++b) {
-                    data_out = output_port_signal_->slot(0)->ClaimData(false);
+                    data_out = signal_port->slot(0)->ClaimData(false);
                     LOG(DEBUG)
                         << name() << ". mcd packet timestamp_: " << timestamp_;
                     data_out->set_hardware_timestamp(timestamp_);
@@ -249,19 +263,16 @@ void NlxParser::Process(ProcessingContext &context) {
                     for (i = 0; i < batch_size_(); i++) {
                         data_out->set_sample_timestamp(i, timestamp_);
                         ttl_data_out->set_sample_timestamp(i, timestamp_);
-                        data_iter = data_out->begin_sample(i);
-
-                        for (auto &channel : channel_list_) {
-                            (*data_iter) = nlxrecord_.sample_microvolt(channel);
-                            ++data_iter;
-                        }
+                        nlxrecord_.samples(channel_list_.data(),
+                                           channel_list_.size(),
+                                           data_out->begin_sample(i));
 
                         ttl_data_out->set_data_sample(
                             i, 0, nlxrecord_.parallel_port());
                         LOG(DEBUG) << name() << ". timestamp_: " << timestamp_
                                    << "; i=" << i;
                     }
-                    output_port_signal_->slot(0)->PublishData();
+                    signal_port->slot(0)->PublishData();
                     output_port_ttl_->slot(0)->PublishData();
                     LOG(UPDATE)
                         << name() << ". Streamed " << batch_size_()
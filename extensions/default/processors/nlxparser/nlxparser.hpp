@@ -72,6 +72,13 @@ class NlxParser : public IProcessor {
      */
     void print_stats(bool condition = true);
 
+    template <typename T> void CreateSignalPort();
+    template <typename T> void ProcessPackets(ProcessingContext &context);
+
+    template <typename T> PortOut<MultiChannelType<T>> *output_port_signal() {
+        return static_cast<PortOut<MultiChannelType<T>> *>(output_port_signal_);
+    }
+
     // VARIABLES
   protected:
     unsigned int nchannels_;
@@ -87,7 +94,7 @@ class NlxParser : public IProcessor {
 
     // PORTS
   protected:
-    PortOut<MultiChannelType<double>> *output_port_signal_;
+    IPortOut *output_port_signal_; // element type set by data type option
     PortOut<MultiChannelType<uint32_t>> *output_port_ttl_;
     PortIn<VectorType<uint32_t>> *data_in_port_;
 
@@ -105,4 +112,5 @@ class NlxParser : public IProcessor {
     options::Bool triggered_{false};
     options::Value<uint32_t, false> hardware_trigger_channel_{0};
     options::Value<GapFill, false> gap_fill_{GapFill::ASAP};
+    options::Value<SampleType, false> sample_type_{SampleType::FLOAT64};
 };
@@ -19,6 +19,7 @@
 
 #include "nlxpurereader.hpp"
 
+#include <algorithm>
 #include <limits>
 #include <memory>
 
@@ -33,6 +34,16 @@ NlxPureReader::NlxPureReader() : IProcessor(PRIORITY_HIGH) {
                "(0 means continuous recording).");
     add_option("nchannels", nchannels_,
                "The number of channels of the Digilynx acquisition system.");
+    add_option("receive batch", receive_batch_,
+               "The maximum number of packets that are read from the socket "
+               "in a single system call.");
+    add_option("kernel timestamps", kernel_timestamps_,
+               "Use the time at which packets arrived in the kernel as "
+               "source timestamp, rather than the time at which they were "
+               "read.");
+    add_option("io backend", io_backend_,
+               "Receive packets with system calls (sync) or through a "
+               "multishot io_uring request (io_uring).");
 }
 
 void NlxPureReader::CreatePorts() {
@@ -44,6 +55,10 @@ void NlxPureReader::CreatePorts() {
     n_invalid_ = create_broadcaster_state<uint64_t>(
         "n_invalid", 0, Permission::READ,
         "The number of invalid packets that were received.");
+
+    datagrams_per_receive_ = create_broadcaster_state<double>(
+        "datagrams_per_receive", 0, Permission::READ,
+        "The average number of packets read per system call.");
 }
 
 void NlxPureReader::CompleteStreamInfo() {
@@ -63,8 +78,31 @@ void NlxPureReader::Prepare(GlobalContext &context) {
 
 void NlxPureReader::Preprocess(ProcessingContext &context) {
     valid_packet_counter_ = 0;
+    nreceive_calls_ = 0;
+    ndatagrams_ = 0;
     const int reuse_address = 1;
     n_invalid_->set(0);
+    datagrams_per_receive_->set(0);
+
+    // a batch is claimed from the output ring buffer in one go, so it can
+    // never be larger than the buffer
+    unsigned int buffer_size = output_port_->slot(0)->buffer_size();
+    if (receive_batch_() > buffer_size) {
+        LOG(WARNING) << name() << ". Receive batch of " << receive_batch_()
+                     << " packets exceeds the output buffer size, using "
+                     << buffer_size << " instead.";
+        receive_batch_ = buffer_size;
+    }
+
+    messages_.assign(receive_batch_(), mmsghdr{});
+    iovecs_.assign(receive_batch_(), iovec{});
+    arrival_times_.assign(receive_batch_(), TimePoint());
+    controls_.assign(receive_batch_() * RECEIVE_TIMESTAMP_CONTROL_SIZE, 0);
+    for (unsigned int k = 0; k < receive_batch_(); ++k) {
+        messages_[k].msg_hdr.msg_iov = &iovecs_[k];
+        messages_[k].msg_hdr.msg_iovlen = 1;
+    }
+    receive_delay_.Reset();
     sleep(1); // reduces probability of missed packets when connecting to
               // ongoing stream
 
@@ -82,11 +120,41 @@ void NlxPureReader::Preprocess(ProcessingContext &context) {
     }
 
     LOG(UPDATE) << name() << ". Socket binding successful.";
+
+    use_kernel_timestamps_ = kernel_timestamps_();
+    if (use_kernel_timestamps_ && !enable_receive_timestamps(udp_socket_)) {
+        LOG(WARNING) << name() << ". Kernel receive timestamps are not "
+                                  "supported, using read time instead.";
+        use_kernel_timestamps_ = false;
+    }
+
+    if (io_backend_() == IoBackend::IO_URING) {
+        try {
+            receiver_.reset(new IoUringReceiver(
+                udp_socket_, 4 * receive_batch_(),
+                nlx::NLX_NFIELDS(nchannels_()) * sizeof(uint32_t),
+                use_kernel_timestamps_ ? RECEIVE_TIMESTAMP_CONTROL_SIZE : 0));
+            LOG(UPDATE) << name() << ". Receiving packets through io_uring.";
+        } catch (std::runtime_error &e) {
+            LOG(WARNING) << name() << ". " << e.what()
+                         << " Falling back to system calls.";
+        }
+    }
+
     udp_socket_select_ = udp_socket_ + 1;
 }
 
 void NlxPureReader::Process(ProcessingContext &context) {
+    auto slot = output_port_->slot(0);
+    const std::size_t packet_size =
+        nlx::NLX_NFIELDS(nchannels_()) * sizeof(uint32_t);
+
     while (!context.terminated() && valid_packet_counter_ < npackets_()) {
+        if (receiver_) {
+            ProcessUringPackets();
+            continue;
+        }
+
         // check if packets have arrived (with time-out)
         // clear the file descriptor set
         FD_ZERO(&file_descriptor_set_);
@@ -109,29 +177,78 @@ void NlxPureReader::Process(ProcessingContext &context) {
         } else if (size_ == -1) {
             LOG(DEBUG) << name() << ": Select error on UDP socket.";
             continue;
-        } else if (size_ > 0) { // received packet
-            data_out_ = output_port_->slot(0)->ClaimData(false);
+        } else if (size_ > 0) { // received packet(s)
+            // claim enough buckets for a full batch and receive all pending
+            // packets straight into them
+            unsigned int nrequested = std::min<uint64_t>(
+                receive_batch_(), npackets_() - valid_packet_counter_);
+            auto data_out = slot->ClaimDataN(nrequested, false);
+            for (unsigned int k = 0; k < nrequested; ++k) {
+                iovecs_[k].iov_base = data_out[k]->data().data();
+                iovecs_[k].iov_len = packet_size;
+            }
+            if (use_kernel_timestamps_) {
+                // the kernel overwrites the control length on receive
+                for (unsigned int k = 0; k < nrequested; ++k) {
+                    messages_[k].msg_hdr.msg_control =
+                        controls_.data() + k * RECEIVE_TIMESTAMP_CONTROL_SIZE;
+                    messages_[k].msg_hdr.msg_controllen =
+                        RECEIVE_TIMESTAMP_CONTROL_SIZE;
+                }
+            }
 
-            recvlen_ = recvfrom(
-                udp_socket_, reinterpret_cast<char *>(data_out_->data().data()),
-                data_out_->data().size() * sizeof(uint32_t), 0, NULL, NULL);
+            int nreceived = recvmmsg(udp_socket_, messages_.data(), nrequested,
+                                     MSG_DONTWAIT, NULL);
+            ++nreceive_calls_;
+            if (nreceived < 0) {
+                nreceived = 0;
+            }
+            ndatagrams_ += nreceived;
 
-            if (recvlen_ !=
-                static_cast<int>(data_out_->data().size()) * sizeof(uint32_t)) {
-                n_invalid_->set(n_invalid_->get() + 1);
-                LOG(UPDATE) << name() << ". Received invalid record.";
-                continue;
-            } else {
-                valid_packet_counter_++;
+            auto now = Clock::now();
+            auto offset = use_kernel_timestamps_
+                              ? system_clock_offset()
+                              : std::chrono::nanoseconds(0);
+
+            // keep valid packets contiguous at the start of the batch
+            unsigned int nvalid = 0;
+            for (int k = 0; k < nreceived; ++k) {
+                if (messages_[k].msg_len != packet_size ||
+                    (messages_[k].msg_hdr.msg_flags & MSG_TRUNC)) {
+                    n_invalid_->set(n_invalid_->get() + 1);
+                    LOG(UPDATE) << name() << ". Received invalid record.";
+                    continue;
+                }
+                if (nvalid != static_cast<unsigned int>(k)) {
+                    data_out[nvalid]->data() = data_out[k]->data();
+                }
+                arrival_times_[nvalid] = now;
+                if (use_kernel_timestamps_ &&
+                    receive_timestamp(messages_[k].msg_hdr, offset,
+                                      arrival_times_[nvalid])) {
+                    receive_delay_.Record(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            now - arrival_times_[nvalid])
+                            .count());
+                }
+                ++nvalid;
             }
 
-            if (valid_packet_counter_ == 1) {
+            if (nvalid > 0 && valid_packet_counter_ == 0) {
                 first_valid_packet_arrival_time_ = Clock::now();
                 LOG(UPDATE) << name() << ". Received first UDP data packet.";
             }
+            valid_packet_counter_ += nvalid;
+
+            for (unsigned int k = 0; k < nvalid; ++k) {
+                data_out[k]->set_source_timestamp(arrival_times_[k]);
+            }
+
+            // unused buckets are handed back to the ring buffer
+            slot->PublishData(nvalid);
 
-            data_out_->set_source_timestamp();
-            output_port_->slot(0)->PublishData();
+            datagrams_per_receive_->set(static_cast<double>(ndatagrams_) /
+                                        nreceive_calls_);
         } else {
             throw ProcessingError("Unexpected size value returned.", name());
         }
@@ -142,6 +259,59 @@ void NlxPureReader::Process(ProcessingContext &context) {
            "processing.";
 }
 
+void NlxPureReader::ProcessUringPackets() {
+    if (!receiver_->Wait(TIMEOUT_SEC * 1000)) {
+        LOG(DEBUG) << name() << ": Timed out waiting for data. Connection lost?";
+        return;
+    }
+
+    auto slot = output_port_->slot(0);
+    const std::size_t packet_size =
+        nlx::NLX_NFIELDS(nchannels_()) * sizeof(uint32_t);
+    auto now = Clock::now();
+    auto offset = use_kernel_timestamps_ ? system_clock_offset()
+                                         : std::chrono::nanoseconds(0);
+
+    // the kernel fills its own buffers, so every valid packet is copied into
+    // a bucket
+    ++nreceive_calls_;
+    ndatagrams_ += receiver_->ForEachDatagram(
+        [&](const char *payload, uint32_t length,
+            const struct msghdr &message) {
+            if (valid_packet_counter_ >= npackets_()) {
+                return;
+            }
+            if (length != packet_size || (message.msg_flags & MSG_TRUNC)) {
+                n_invalid_->set(n_invalid_->get() + 1);
+                LOG(UPDATE) << name() << ". Received invalid record.";
+                return;
+            }
+
+            TimePoint arrival_time = now;
+            if (use_kernel_timestamps_ &&
+                receive_timestamp(message, offset, arrival_time)) {
+                receive_delay_.Record(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        now - arrival_time)
+                        .count());
+            }
+
+            if (valid_packet_counter_ == 0) {
+                first_valid_packet_arrival_time_ = now;
+                LOG(UPDATE) << name() << ". Received first UDP data packet.";
+            }
+            ++valid_packet_counter_;
+
+            auto data_out = slot->ClaimData(false);
+            memcpy(data_out->data().data(), payload, packet_size);
+            data_out->set_source_timestamp(arrival_time);
+            slot->PublishData();
+        });
+
+    datagrams_per_receive_->set(static_cast<double>(ndatagrams_) /
+                                nreceive_calls_);
+}
+
 void NlxPureReader::Postprocess(ProcessingContext &context) {
     std::chrono::milliseconds runtime(
         std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -155,8 +325,25 @@ void NlxPureReader::Postprocess(ProcessingContext &context) {
                        (static_cast<double>(runtime.count()) / 1000)
                 << " packets/second.";
 
+    if (receiver_) {
+        LOG(UPDATE) << name() << ". The io_uring receive request was re-armed "
+                    << receiver_->nrearmed() << " times.";
+        receiver_.reset();
+    }
+
     close(udp_socket_);
 
+    LOG(UPDATE) << name() << ". Read " << ndatagrams_ << " packets in "
+                << nreceive_calls_ << " system calls ("
+                << (nreceive_calls_ > 0
+                        ? static_cast<double>(ndatagrams_) / nreceive_calls_
+                        : 0.)
+                << " packets per call).";
+
+    LOG_IF(UPDATE, use_kernel_timestamps_)
+        << name() << ". Delay between kernel and user-space arrival of "
+        << receive_delay_.count() << " packets: " << receive_delay_.summary();
+
     LOG(UPDATE) << name() << ". Streamed "
                 << output_port_->slot(0)->nitems_produced()
                 << " multi-channel data items.";
@@ -21,13 +21,19 @@
 
 #include <arpa/inet.h>
 #include <limits>
+#include <memory>
 #include <netinet/in.h>
 #include <sys/select.h>
+#include <sys/socket.h>
 #include <sys/time.h>
+#include <vector>
 
 #include "iprocessor.hpp"
+#include "latencyhistogram.hpp"
 #include "neuralynx/nlx.hpp"
 #include "options/options.hpp"
+#include "utilities/iouring.hpp"
+#include "utilities/socketutil.hpp"
 #include "utilities/time.hpp"
 #include "vectordata/vectordata.hpp"
 
@@ -42,6 +48,10 @@ class NlxPureReader : public IProcessor {
     void Process(ProcessingContext &context) override;
     void Postprocess(ProcessingContext &context) override;
 
+    // METHODS
+  protected:
+    void ProcessUringPackets();
+
     // PORTS
   protected:
     PortOut<VectorType<uint32_t>> *output_port_;
@@ -49,6 +59,7 @@ class NlxPureReader : public IProcessor {
     // STATES
   protected:
     BroadcasterState<uint64_t> *n_invalid_;
+    BroadcasterState<double> *datagrams_per_receive_;
 
     // VARIABLES
   protected:
@@ -60,8 +71,24 @@ class NlxPureReader : public IProcessor {
     struct timeval timeout_;
     TimePoint first_valid_packet_arrival_time_;
     ssize_t size_;
-    int recvlen_;
-    VectorType<uint32_t>::Data *data_out_;
+    uint64_t nreceive_calls_;
+    uint64_t ndatagrams_;
+
+    // one message header and io vector per datagram in a receive batch,
+    // the io vectors point into the claimed ring buffer items
+    std::vector<struct mmsghdr> messages_;
+    std::vector<struct iovec> iovecs_;
+
+    // control buffers for the kernel receive timestamps and the delay
+    // between kernel arrival and user-space arrival of each packet
+    bool use_kernel_timestamps_;
+    std::vector<char> controls_;
+    std::vector<TimePoint> arrival_times_;
+    LatencyHistogram receive_delay_;
+
+    // multishot receive request, used instead of recvmmsg with the io_uring
+    // backend
+    std::unique_ptr<IoUringReceiver> receiver_;
 
     // CONSTANTS
   public:
@@ -74,4 +101,8 @@ class NlxPureReader : public IProcessor {
     options::Value<std::uint64_t, false> npackets_{
         0, options::zeroismax<std::uint64_t>()};
     options::Value<unsigned int, false> nchannels_{nlx::NLX_DEFAULT_NCHANNELS};
+    options::Value<unsigned int, false> receive_batch_{
+        32, options::inrange<unsigned int>(1, 256)};
+    options::Bool kernel_timestamps_{false};
+    options::Value<IoBackend, false> io_backend_{IoBackend::SYNC};
 };
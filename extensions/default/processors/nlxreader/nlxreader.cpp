@@ -20,6 +20,7 @@
 
 #include <chrono>
 #include <limits>
+#include <stdexcept>
 
 constexpr uint16_t NlxReader::MAX_NCHANNELS;
 constexpr decltype(NlxReader::MAX_NCHANNELS) NlxReader::UDP_BUFFER_SIZE;
@@ -48,6 +49,33 @@ NlxReader::NlxReader() : IProcessor(PRIORITY_HIGH) {
                "streaming data packets.");
     add_option("trigger/channel", hardware_trigger_channel_,
                "Digital input channel to use as hardware trigger");
+    add_option("data type", sample_type_,
+               "Element type of the output samples: float64 or float32 "
+               "(microvolts), or int16 (raw AD values, saturated at about "
+               "+/- 512 uV).");
+    add_option("receive batch", receive_batch_,
+               "The maximum number of packets that are read from the socket "
+               "in a single system call.");
+    add_option("kernel timestamps", kernel_timestamps_,
+               "Use the time at which packets arrived in the kernel as "
+               "source timestamp, rather than the time at which they were "
+               "read.");
+    add_option("io backend", io_backend_,
+               "Receive packets with system calls (sync) or through a "
+               "multishot io_uring request (io_uring).");
+    add_option("packet ring/enable", packet_ring_enabled_,
+               "Capture packets through a memory-mapped packet ring rather "
+               "than reading them from a socket (requires CAP_NET_RAW).");
+    add_option("packet ring/interface", packet_ring_interface_,
+               "Network interface on which packets are captured.");
+    add_option("packet ring/block size", packet_ring_block_size_,
+               "Size of a packet ring block in bytes (multiple of the page "
+               "size).");
+    add_option("packet ring/nblocks", packet_ring_nblocks_,
+               "Number of blocks in the packet ring.");
+    add_option("packet ring/block timeout", packet_ring_block_timeout_,
+               "Time in milliseconds after which a partially filled block is "
+               "handed over.");
 }
 
 void NlxReader::Configure(const GlobalContext &context) {
@@ -55,25 +83,37 @@ void NlxReader::Configure(const GlobalContext &context) {
 }
 
 void NlxReader::CreatePorts() {
+    dispatch_sample_type<double, float, int16_t>(
+        sample_type_(), [this](auto x) { CreateTypedPorts<decltype(x)>(); });
+}
+
+template <typename T> void NlxReader::CreateTypedPorts() {
     for (auto &it : channelmap_()) {
-        data_ports_[it.first] = create_output_port<MultiChannelType<double>>(
+        data_ports_[it.first] = create_output_port<MultiChannelType<T>>(
             it.first,
-            MultiChannelType<double>::Capabilities(
+            typename MultiChannelType<T>::Capabilities(
                 ChannelRange(it.second.size())),
-            MultiChannelType<double>::Parameters(),
+            typename MultiChannelType<T>::Parameters(),
             PortOutPolicy(SlotRange(1), 500, WaitStrategy::kBlockingStrategy));
     }
 }
 
 void NlxReader::CompleteStreamInfo() {
+    dispatch_sample_type<double, float, int16_t>(
+        sample_type_(),
+        [this](auto x) { CompleteTypedStreamInfo<decltype(x)>(); });
+}
+
+template <typename T> void NlxReader::CompleteTypedStreamInfo() {
     for (auto &it : data_ports_) {
+        auto port = static_cast<PortOut<MultiChannelType<T>> *>(it.second);
         // finalize data type with nsamples == batch_size and nchannels taken
         // from channel map
-        it.second->streaminfo(0).set_parameters(
-            MultiChannelType<double>::Parameters(
+        port->streaminfo(0).set_parameters(
+            typename MultiChannelType<T>::Parameters(
                 channelmap_().at(it.first).size(), batch_size_(),
-                nlx::NLX_SIGNAL_SAMPLING_FREQUENCY));
-        it.second->streaminfo(0).set_stream_rate(
+                nlx::NLX_SIGNAL_SAMPLING_FREQUENCY, nlx::sample_scale<T>()));
+        port->streaminfo(0).set_stream_rate(
             nlx::NLX_SIGNAL_SAMPLING_FREQUENCY / batch_size_());
     }
 }
@@ -95,6 +135,20 @@ void NlxReader::Preprocess(ProcessingContext &context) {
 
     stats_.clear();
 
+    nreceive_calls_ = 0;
+    ndatagrams_ = 0;
+    buffers_.assign(receive_batch_() * UDP_BUFFER_SIZE, 0);
+    messages_.assign(receive_batch_(), mmsghdr{});
+    iovecs_.assign(receive_batch_(), iovec{});
+    controls_.assign(receive_batch_() * RECEIVE_TIMESTAMP_CONTROL_SIZE, 0);
+    for (unsigned int k = 0; k < receive_batch_(); ++k) {
+        iovecs_[k].iov_base = buffers_.data() + k * UDP_BUFFER_SIZE;
+        iovecs_[k].iov_len = UDP_BUFFER_SIZE;
+        messages_[k].msg_hdr.msg_iov = &iovecs_[k];
+        messages_[k].msg_hdr.msg_iovlen = 1;
+    }
+    receive_delay_.Reset();
+
     if (context.test()) {
         prepare_latency_test(context);
     }
@@ -112,16 +166,75 @@ void NlxReader::Preprocess(ProcessingContext &context) {
         throw ProcessingPreprocessingError("Socket binding failed.", name());
     }
     LOG(UPDATE) << name() << ". Socket binding successful.";
+
+    use_kernel_timestamps_ = kernel_timestamps_();
+
+    if (packet_ring_enabled_()) {
+        // the socket only keeps the port claimed, data is captured from the
+        // packet ring (which always has kernel receive times)
+        if (!discard_socket_input(udp_socket_)) {
+            close(udp_socket_);
+            throw ProcessingPrepareError(
+                "Unable to discard input on UDP socket.", name());
+        }
+        try {
+            packet_ring_.Open(packet_ring_interface_(),
+                              server_addr_.sin_addr.s_addr, port_(),
+                              packet_ring_block_size_(), packet_ring_nblocks_(),
+                              packet_ring_block_timeout_());
+        } catch (std::runtime_error &e) {
+            close(udp_socket_);
+            throw ProcessingPreprocessingError(e.what(), name());
+        }
+        LOG(UPDATE) << name() << ". Capturing packets on interface "
+                    << packet_ring_interface_() << ".";
+        return;
+    }
+
+    if (use_kernel_timestamps_ && !enable_receive_timestamps(udp_socket_)) {
+        LOG(WARNING) << name() << ". Kernel receive timestamps are not "
+                                  "supported, using read time instead.";
+        use_kernel_timestamps_ = false;
+    }
+
+    if (io_backend_() == IoBackend::IO_URING) {
+        try {
+            receiver_.reset(new IoUringReceiver(
+                udp_socket_, 4 * receive_batch_(), UDP_BUFFER_SIZE,
+                use_kernel_timestamps_ ? RECEIVE_TIMESTAMP_CONTROL_SIZE : 0));
+            LOG(UPDATE) << name() << ". Receiving packets through io_uring.";
+        } catch (std::runtime_error &e) {
+            LOG(WARNING) << name() << ". " << e.what()
+                         << " Falling back to system calls.";
+        }
+    }
 }
 
 void NlxReader::Process(ProcessingContext &context) {
-    bool update_time = false;
-    int data_index = 0;
-    MultiChannelType<double>::Data::sample_iterator data_iter;
-    std::vector<MultiChannelType<double>::Data *> data_vector(
+    dispatch_sample_type<double, float, int16_t>(sample_type_(), [&](auto x) {
+        ProcessPackets<decltype(x)>(context);
+    });
+}
+
+template <typename T>
+void NlxReader::ProcessPackets(ProcessingContext &context) {
+    std::vector<typename MultiChannelType<T>::Data *> data_vector(
         data_ports_.size());
+    std::vector<PortOut<MultiChannelType<T>> *> ports;
+    for (auto &it : data_ports_) {
+        ports.push_back(static_cast<PortOut<MultiChannelType<T>> *>(it.second));
+    }
 
     while (!context.terminated() && valid_packet_counter_ < npackets_()) {
+        if (packet_ring_.is_open()) {
+            ProcessRingPackets<T>(ports, data_vector);
+            continue;
+        }
+        if (receiver_) {
+            ProcessUringPackets<T>(ports, data_vector);
+            continue;
+        }
+
         // check if packets have arrived (with time-out)
         FD_ZERO(&file_descriptor_set_); // clear the file descriptor set
         FD_SET(udp_socket_, &file_descriptor_set_);
@@ -143,100 +256,45 @@ void NlxReader::Process(ProcessingContext &context) {
         } else if (size == -1) {
             LOG(DEBUG) << name() << ": Select error on UDP socket.";
             continue;
-        } else if (size > 0) { // receive packet
-            int recvlen =
-                recvfrom(udp_socket_, buffer_, UDP_BUFFER_SIZE, 0, NULL, NULL);
-
-            int rc = nlxrecord_.FromNetworkBuffer(buffer_, recvlen);
-
-            if (rc != 0) {
-                ++stats_.n_invalid;
-
-                LOG(INFO) << name() << ": Received invalid record.";
-
-                LOG(DEBUG) << name() << ". STX field: "
-                           << nlxrecord_.buffer_[nlx::NLX_FIELD_STX]
-                           << " instead of " << nlx::NLX_STX;
-                LOG(DEBUG) << name() << ". Raw packet id:"
-                           << nlxrecord_.buffer_[nlx::NLX_FIELD_RAWPACKETID]
-                           << " instead of " << nlx::NLX_RAWPACKETID;
-                LOG(DEBUG) << name() << ". Packet size field: "
-                           << "Actual size: " << recvlen
-                           << " \nReported size in the packet: "
-                           << nlxrecord_.buffer_[nlx::NLX_FIELD_PACKETSIZE]
-                           << " \nExpected size: "
-                           << nlxrecord_.nlx_packetsize_;
-                LOG_IF(DEBUG, rc == nlx::ERROR_BAD_CRC)
-                    << name() << ". Error Bad CRC";
-
-                continue;
-            }
-
-            timestamp_ =
-                nlx::CheckTimestamp(nlxrecord_, last_timestamp_, stats_);
-            valid_packet_counter_++;
-
-            if (valid_packet_counter_ == 1) {
-                first_valid_packet_arrival_time_ = Clock::now();
-                LOG(UPDATE) << name() << ": Received first valid data packet"
-                            << " (TS = " << timestamp_ << ").";
-            }
-
-            update_time = valid_packet_counter_ % update_interval_() == 0;
-            LOG_IF(UPDATE, update_time)
-                << name() << ": " << valid_packet_counter_ << " packets ("
-                << valid_packet_counter_ / nlx::NLX_SIGNAL_SAMPLING_FREQUENCY
-                << " s) received.";
-            print_stats(update_time);
-
-            if (triggered_()) {
-                LOG_IF(UPDATE, (valid_packet_counter_ == 1))
-                    << name() << ". Waiting for hardware trigger on channel "
-                    << hardware_trigger_channel_() << ".";
-                if (nlxrecord_.parallel_port() &
-                    (1 << hardware_trigger_channel_())) {
-                    triggered_ = true;
-                    LOG(UPDATE) << name() << ". Dispatching starts now.";
-                } else {
-                    continue;
-                }
-            }
-
-            // claim new data buckets
-            if (sample_counter_ == batch_size_()) {
-                data_index = 0;
-                for (auto &it : data_ports_) {
-                    data_vector[data_index] =
-                        it.second->slot(0)->ClaimData(false);
-                    // set data bucket metadata
-                    data_vector[data_index]->set_hardware_timestamp(timestamp_);
-                    data_vector[data_index]->set_source_timestamp();
-                    data_index++;
+        } else if (size > 0) { // receive all pending packets
+            if (use_kernel_timestamps_) {
+                // the kernel overwrites the control length on receive
+                for (unsigned int k = 0; k < receive_batch_(); ++k) {
+                    messages_[k].msg_hdr.msg_control =
+                        controls_.data() + k * RECEIVE_TIMESTAMP_CONTROL_SIZE;
+                    messages_[k].msg_hdr.msg_controllen =
+                        RECEIVE_TIMESTAMP_CONTROL_SIZE;
                 }
-                sample_counter_ = 0;
             }
-
-            // copy data onto buffers for each configured channel group
-            data_index = 0;
-            for (auto &it : channelmap_()) {
-                data_vector[data_index]->set_sample_timestamp(
-                    sample_counter_, nlxrecord_.timestamp());
-                data_iter =
-                    data_vector[data_index]->begin_sample(sample_counter_);
-                for (auto &channel : it.second) {
-                    (*data_iter) = nlxrecord_.sample_microvolt(channel);
-                    ++data_iter;
-                }
-                data_index++;
+            int nreceived =
+                recvmmsg(udp_socket_, messages_.data(), receive_batch_(),
+                         MSG_DONTWAIT, NULL);
+            ++nreceive_calls_;
+            if (nreceived < 0) {
+                continue;
             }
-
-            ++sample_counter_;
-
-            // publish data buckets
-            if (sample_counter_ == batch_size_()) {
-                for (auto &it : data_ports_) {
-                    it.second->slot(0)->PublishData();
+            ndatagrams_ += nreceived;
+
+            auto now = Clock::now();
+            auto offset = use_kernel_timestamps_
+                              ? system_clock_offset()
+                              : std::chrono::nanoseconds(0);
+
+            for (int k = 0; k < nreceived &&
+                            valid_packet_counter_ < npackets_();
+                 ++k) {
+                TimePoint arrival_time = now;
+                if (use_kernel_timestamps_ &&
+                    receive_timestamp(messages_[k].msg_hdr, offset,
+                                      arrival_time)) {
+                    receive_delay_.Record(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            now - arrival_time)
+                            .count());
                 }
+                ProcessPacket<T>(buffers_.data() + k * UDP_BUFFER_SIZE,
+                                 messages_[k].msg_len, arrival_time, ports,
+                                 data_vector);
             }
         }
     }
@@ -251,6 +309,159 @@ void NlxReader::Process(ProcessingContext &context) {
     }
 }
 
+template <typename T>
+void NlxReader::ProcessUringPackets(
+    std::vector<PortOut<MultiChannelType<T>> *> &ports,
+    std::vector<typename MultiChannelType<T>::Data *> &data_vector) {
+    if (!receiver_->Wait(TIMEOUT_SEC * 1000)) {
+        LOG(DEBUG) << name() << ": Timed out waiting for data. Connection lost?";
+        return;
+    }
+
+    auto now = Clock::now();
+    auto offset = use_kernel_timestamps_ ? system_clock_offset()
+                                         : std::chrono::nanoseconds(0);
+    ++nreceive_calls_;
+    ndatagrams_ += receiver_->ForEachDatagram(
+        [&](const char *payload, uint32_t length,
+            const struct msghdr &message) {
+            if (valid_packet_counter_ >= npackets_()) {
+                return;
+            }
+            TimePoint arrival_time = now;
+            if (use_kernel_timestamps_ &&
+                receive_timestamp(message, offset, arrival_time)) {
+                receive_delay_.Record(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        now - arrival_time)
+                        .count());
+            }
+            ProcessPacket<T>(payload, length, arrival_time, ports,
+                             data_vector);
+        });
+}
+
+template <typename T>
+void NlxReader::ProcessRingPackets(
+    std::vector<PortOut<MultiChannelType<T>> *> &ports,
+    std::vector<typename MultiChannelType<T>::Data *> &data_vector) {
+    if (!packet_ring_.Wait(TIMEOUT_SEC * 1000)) {
+        LOG(DEBUG) << name() << ": Timed out waiting for data. Connection lost?";
+        return;
+    }
+
+    auto now = Clock::now();
+    ++nreceive_calls_;
+    ndatagrams_ += packet_ring_.ForEachDatagram(
+        [&](const char *payload, uint32_t length, TimePoint kernel_time) {
+            if (valid_packet_counter_ >= npackets_()) {
+                return;
+            }
+            TimePoint arrival_time = now;
+            if (use_kernel_timestamps_) {
+                arrival_time = kernel_time;
+                receive_delay_.Record(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        now - kernel_time)
+                        .count());
+            }
+            ProcessPacket<T>(payload, length, arrival_time, ports,
+                             data_vector);
+        });
+}
+
+template <typename T>
+void NlxReader::ProcessPacket(
+    const char *buffer, int recvlen, TimePoint arrival_time,
+    std::vector<PortOut<MultiChannelType<T>> *> &ports,
+    std::vector<typename MultiChannelType<T>::Data *> &data_vector) {
+    bool update_time = false;
+    int data_index = 0;
+
+    int rc = nlxrecord_.FromNetworkBuffer(buffer, recvlen);
+
+    if (rc != 0) {
+        ++stats_.n_invalid;
+
+        FASTLOG(INFO, "{}: Received invalid record.", name());
+
+        FASTLOG(DEBUG, "{}. STX field: {} instead of {}", name(),
+                nlxrecord_.buffer_[nlx::NLX_FIELD_STX], nlx::NLX_STX);
+        FASTLOG(DEBUG, "{}. Raw packet id:{} instead of {}", name(),
+                nlxrecord_.buffer_[nlx::NLX_FIELD_RAWPACKETID],
+                nlx::NLX_RAWPACKETID);
+        FASTLOG(DEBUG,
+                "{}. Packet size field: Actual size: {} \n"
+                "Reported size in the packet: {} \nExpected size: {}",
+                name(), recvlen, nlxrecord_.buffer_[nlx::NLX_FIELD_PACKETSIZE],
+                nlxrecord_.nlx_packetsize_);
+        FASTLOG_IF(DEBUG, rc == nlx::ERROR_BAD_CRC, "{}. Error Bad CRC",
+                   name());
+
+        return;
+    }
+
+    timestamp_ = nlx::CheckTimestamp(nlxrecord_, last_timestamp_, stats_);
+    valid_packet_counter_++;
+
+    if (valid_packet_counter_ == 1) {
+        first_valid_packet_arrival_time_ = Clock::now();
+        FASTLOG(UPDATE, "{}: Received first valid data packet (TS = {}).",
+                name(), timestamp_);
+    }
+
+    update_time = valid_packet_counter_ % update_interval_() == 0;
+    FASTLOG_IF(UPDATE, update_time, "{}: {} packets ({} s) received.", name(),
+               valid_packet_counter_,
+               valid_packet_counter_ / nlx::NLX_SIGNAL_SAMPLING_FREQUENCY);
+    print_stats(update_time);
+
+    if (triggered_()) {
+        FASTLOG_IF(UPDATE, valid_packet_counter_ == 1,
+                   "{}. Waiting for hardware trigger on channel {}.", name(),
+                   hardware_trigger_channel_());
+        if (nlxrecord_.parallel_port() & (1 << hardware_trigger_channel_())) {
+            triggered_ = true;
+            FASTLOG(UPDATE, "{}. Dispatching starts now.", name());
+        } else {
+            return;
+        }
+    }
+
+    // claim new data buckets
+    if (sample_counter_ == batch_size_()) {
+        data_index = 0;
+        for (auto &port : ports) {
+            data_vector[data_index] = port->slot(0)->ClaimData(false);
+            // set data bucket metadata
+            data_vector[data_index]->set_hardware_timestamp(timestamp_);
+            data_vector[data_index]->set_source_timestamp(arrival_time);
+            data_index++;
+        }
+        sample_counter_ = 0;
+    }
+
+    // copy data onto buffers for each configured channel group
+    data_index = 0;
+    for (auto &it : channelmap_()) {
+        data_vector[data_index]->set_sample_timestamp(sample_counter_,
+                                                      nlxrecord_.timestamp());
+        nlxrecord_.samples(
+            it.second.data(), it.second.size(),
+            data_vector[data_index]->begin_sample(sample_counter_));
+        data_index++;
+    }
+
+    ++sample_counter_;
+
+    // publish data buckets
+    if (sample_counter_ == batch_size_()) {
+        for (auto &port : ports) {
+            port->slot(0)->PublishData();
+        }
+    }
+}
+
 void NlxReader::Postprocess(ProcessingContext &context) {
     LOG_IF(UPDATE, (valid_packet_counter_ == npackets_()))
         << "Requested number of packets was read. You can now STOP processing.";
@@ -268,6 +479,28 @@ void NlxReader::Postprocess(ProcessingContext &context) {
                 << " packets/second.";
     print_stats();
 
+    LOG(UPDATE) << name() << ". Read " << ndatagrams_ << " packets in "
+                << nreceive_calls_
+                << (packet_ring_.is_open() || receiver_
+                        ? " completion passes ("
+                        : " system calls (")
+                << (nreceive_calls_ > 0
+                        ? static_cast<double>(ndatagrams_) / nreceive_calls_
+                        : 0.)
+                << " packets per call).";
+
+    if (receiver_) {
+        LOG(UPDATE) << name() << ". The io_uring receive request was re-armed "
+                    << receiver_->nrearmed() << " times.";
+        receiver_.reset();
+    }
+
+    if (packet_ring_.is_open()) {
+        LOG(UPDATE) << name() << ". " << packet_ring_.ndropped()
+                    << " packets were dropped by the packet ring.";
+        packet_ring_.Close();
+    }
+
     close(udp_socket_);
 
     if (context.test()) {
@@ -276,11 +509,16 @@ void NlxReader::Postprocess(ProcessingContext &context) {
 }
 
 void NlxReader::print_stats(bool condition) {
-    LOG_IF(UPDATE, condition)
-        << name() << ". Stats report: " << stats_.n_invalid << " invalid, "
-        << stats_.n_duplicated << " duplicated, " << stats_.n_outoforder
-        << " out of order, " << stats_.n_missed << " missed, " << stats_.n_gaps
-        << " gaps.";
+    FASTLOG_IF(UPDATE, condition,
+               "{}. Stats report: {} invalid, {} duplicated, {} out of order, "
+               "{} missed, {} gaps.",
+               name(), stats_.n_invalid, stats_.n_duplicated,
+               stats_.n_outoforder, stats_.n_missed, stats_.n_gaps);
+    // the summary does not fit a fast log record, and is only built when
+    // reporting
+    LOG_IF(UPDATE, condition && use_kernel_timestamps_)
+        << name() << ". Delay between kernel and user-space arrival of "
+        << receive_delay_.count() << " packets: " << receive_delay_.summary();
 }
 
 REGISTERPROCESSOR(NlxReader)
@@ -22,18 +22,24 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/select.h>
+#include <sys/socket.h>
 #include <sys/time.h>
 
 #include <cstdint>
 #include <limits>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "iprocessor.hpp"
+#include "latencyhistogram.hpp"
 #include "multichanneldata/multichanneldata.hpp"
 #include "neuralynx/nlx.hpp"
 #include "options/options.hpp"
+#include "utilities/iouring.hpp"
+#include "utilities/packetring.hpp"
+#include "utilities/socketutil.hpp"
 #include "utilities/time.hpp"
 
 typedef std::map<std::string, std::vector<unsigned int>> ChannelMap;
@@ -58,9 +64,26 @@ class NlxReader : public IProcessor {
      */
     void print_stats(bool condition = true);
 
-    // PORT
+    template <typename T> void CreateTypedPorts();
+    template <typename T> void CompleteTypedStreamInfo();
+    template <typename T> void ProcessPackets(ProcessingContext &context);
+    template <typename T>
+    void ProcessUringPackets(
+        std::vector<PortOut<MultiChannelType<T>> *> &ports,
+        std::vector<typename MultiChannelType<T>::Data *> &data_vector);
+    template <typename T>
+    void ProcessRingPackets(
+        std::vector<PortOut<MultiChannelType<T>> *> &ports,
+        std::vector<typename MultiChannelType<T>::Data *> &data_vector);
+    template <typename T>
+    void ProcessPacket(
+        const char *buffer, int recvlen, TimePoint arrival_time,
+        std::vector<PortOut<MultiChannelType<T>> *> &ports,
+        std::vector<typename MultiChannelType<T>::Data *> &data_vector);
+
+    // PORT (element type selected by the data type option)
   protected:
-    std::map<std::string, PortOut<MultiChannelType<double>> *> data_ports_;
+    std::map<std::string, IPortOut *> data_ports_;
 
     // CONSTANTS
   public:
@@ -83,8 +106,27 @@ class NlxReader : public IProcessor {
     uint64_t timestamp_;
     uint64_t last_timestamp_;
 
-    // UDP_BUFFER_SIZE is in bytes, so divide by size of int32_t
-    char buffer_[UDP_BUFFER_SIZE];
+    // receive buffers of UDP_BUFFER_SIZE bytes for a batch of packets, with
+    // one message header and io vector per packet
+    std::vector<char> buffers_;
+    std::vector<struct mmsghdr> messages_;
+    std::vector<struct iovec> iovecs_;
+    uint64_t nreceive_calls_;
+    uint64_t ndatagrams_;
+
+    // control buffers for the kernel receive timestamps and the delay
+    // between kernel arrival and user-space arrival of each packet
+    bool use_kernel_timestamps_;
+    std::vector<char> controls_;
+    LatencyHistogram receive_delay_;
+
+    // memory-mapped capture ring, used instead of reading from the socket
+    // when the packet ring is enabled
+    PacketRing packet_ring_;
+
+    // multishot receive request, used instead of recvmmsg with the io_uring
+    // backend
+    std::unique_ptr<IoUringReceiver> receiver_;
 
     nlx::NlxSignalRecord nlxrecord_;
     nlx::NlxStatistics stats_;
@@ -104,4 +146,17 @@ class NlxReader : public IProcessor {
             options::zeroismax<std::uint64_t>()};
     options::Bool triggered_{false};
     options::Value<uint32_t, false> hardware_trigger_channel_{0};
+    options::Value<SampleType, false> sample_type_{SampleType::FLOAT64};
+    options::Value<unsigned int, false> receive_batch_{
+        32, options::inrange<unsigned int>(1, 256)};
+    options::Bool kernel_timestamps_{false};
+    options::Value<IoBackend, false> io_backend_{IoBackend::SYNC};
+    options::Bool packet_ring_enabled_{false};
+    options::String packet_ring_interface_{"lo"};
+    options::Value<unsigned int, false> packet_ring_block_size_{
+        1 << 14, options::positive<unsigned int>(true)};
+    options::Value<unsigned int, false> packet_ring_nblocks_{
+        64, options::inrange<unsigned int>(2, 4096)};
+    options::Value<unsigned int, false> packet_ring_block_timeout_{
+        1, options::positive<unsigned int>(true)};
 };
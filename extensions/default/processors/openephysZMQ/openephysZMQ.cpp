@@ -35,20 +35,31 @@ OpenEphysZMQ::OpenEphysZMQ()
                "single multi-channel data bucket.");
     add_option("nchannels", nchannels_,
                "The number of channels in the data packet sent by Open-Ephys.");
+    add_option("data type", sample_type_,
+               "Element type of the output samples (float64, float32 or "
+               "int16). Open-Ephys sends single precision samples.");
 }
 
 void OpenEphysZMQ::CreatePorts() {
-    data_port_ = create_output_port<MultiChannelType<double>>(
+    dispatch_sample_type<double, float, int16_t>(
+        sample_type_(), [this](auto x) { CreateTypedPorts<decltype(x)>(); });
+}
+
+template <typename T> void OpenEphysZMQ::CreateTypedPorts() {
+    data_port_ = create_output_port<MultiChannelType<T>>(
         "data",
-        MultiChannelType<double>::Capabilities(ChannelRange(nchannels_())),
-        MultiChannelType<double>::Parameters(),
+        typename MultiChannelType<T>::Capabilities(ChannelRange(nchannels_())),
+        typename MultiChannelType<T>::Parameters(),
         PortOutPolicy(SlotRange(1), 500, WaitStrategy::kBlockingStrategy));
 }
 
 void OpenEphysZMQ::CompleteStreamInfo() {
-    data_port_->streaminfo(0).set_parameters(
-        MultiChannelType<double>::Parameters(nchannels_(), batch_size_()));
-    data_port_->streaminfo(0).set_stream_rate(IRREGULARSTREAM);
+    dispatch_sample_type<double, float, int16_t>(sample_type_(), [&](auto x) {
+        auto port = data_port<decltype(x)>();
+        port->streaminfo(0).set_parameters(
+            nsMultiChannel::Parameters(nchannels_(), batch_size_()));
+        port->streaminfo(0).set_stream_rate(IRREGULARSTREAM);
+    });
 }
 
 void OpenEphysZMQ::Preprocess(ProcessingContext &context) {
@@ -74,10 +85,18 @@ void OpenEphysZMQ::Preprocess(ProcessingContext &context) {
 }
 
 void OpenEphysZMQ::Process(ProcessingContext &context) {
+    dispatch_sample_type<double, float, int16_t>(sample_type_(), [&](auto x) {
+        ProcessPackets<decltype(x)>(context);
+    });
+}
+
+template <typename T>
+void OpenEphysZMQ::ProcessPackets(ProcessingContext &context) {
+    auto port = data_port<T>();
     unsigned int sample_counter_ = batch_size_();
-    MultiChannelType<double>::Data::sample_iterator data_out_iter;
+    typename MultiChannelType<T>::Data::sample_iterator data_out_iter;
     flatbuffers::VectorIterator<float, float> data_in_iter;
-    MultiChannelType<double>::Data *data_out;
+    typename MultiChannelType<T>::Data *data_out;
     const openephysflatbuffer::ContinuousData *data;
 
     while (!context.terminated() && valid_packets_counter_ < npackets_()) {
@@ -129,7 +148,7 @@ void OpenEphysZMQ::Process(ProcessingContext &context) {
 
             for (uint64_t sample = 0; sample < n_samples; sample++) {
                 if (sample_counter_ == batch_size_()) {
-                    data_out = data_port_->slot(0)->ClaimData(false);
+                    data_out = port->slot(0)->ClaimData(false);
                     // set data bucket metadata
                     data_out->set_hardware_timestamp(init_ts);
                     data_out->set_source_timestamp();
@@ -142,7 +161,8 @@ void OpenEphysZMQ::Process(ProcessingContext &context) {
                 data_out_iter = data_out->begin_sample(sample_counter_);
 
                 for (uint64_t channel = 0; channel < nchannels_(); channel++) {
-                    (*data_out_iter) = *(data_in_iter + n_samples * channel);
+                    (*data_out_iter) = convert_sample<T>(
+                        *(data_in_iter + n_samples * channel));
                     ++data_out_iter;
                 }
 
@@ -150,7 +170,7 @@ void OpenEphysZMQ::Process(ProcessingContext &context) {
                 ++sample_counter_;
 
                 if (sample_counter_ == batch_size_()) {
-                    data_port_->slot(0)->PublishData();
+                    port->slot(0)->PublishData();
                 }
             }
         }
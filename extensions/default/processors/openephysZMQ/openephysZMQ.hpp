@@ -46,10 +46,20 @@ class OpenEphysZMQ : public IProcessor {
     options::Value<unsigned int, false> batch_size_{1};
     options::Value<unsigned int, false> nchannels_{
         384, options::positive<unsigned int>(true)};
+    options::Value<SampleType, false> sample_type_{SampleType::FLOAT64};
 
-    // PORT
+    // METHODS
   protected:
-    PortOut<MultiChannelType<double>> *data_port_;
+    template <typename T> void CreateTypedPorts();
+    template <typename T> void ProcessPackets(ProcessingContext &context);
+
+    template <typename T> PortOut<MultiChannelType<T>> *data_port() {
+        return static_cast<PortOut<MultiChannelType<T>> *>(data_port_);
+    }
+
+    // PORT (element type selected by the data type option)
+  protected:
+    IPortOut *data_port_;
 
     // VARIABLES
   protected:
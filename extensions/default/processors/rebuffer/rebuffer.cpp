@@ -28,6 +28,9 @@ Rebuffer::Rebuffer() : IProcessor() {
                "The factor for downsampling the signal.");
     add_option("buffer size", buffer_size_,
                "Output buffer size in samples or seconds.");
+    add_option("anti-aliasing filter", filter_def_,
+               "FIR filter definition (YAML or file) applied before "
+               "downsampling.");
 }
 
 void Rebuffer::CreatePorts() {
@@ -46,6 +49,34 @@ void Rebuffer::Configure(const GlobalContext &context) {
               << ".";
     LOG(INFO) << name() << ". Buffer size set to " << buffer_size_.to_string()
               << ".";
+
+    filter_template_.reset();
+
+    if (!filter_def_().IsMap()) {
+        return;
+    }
+
+    std::unique_ptr<dsp::filter::IFilter> filter;
+    if (!filter_def_()["file"]) {
+        filter.reset(dsp::filter::construct_from_yaml(filter_def_()));
+    } else {
+        std::string f = context.resolve_path(
+            filter_def_()["file"].as<std::string>(), "filters");
+        filter.reset(dsp::filter::construct_from_file(f));
+    }
+
+    // only FIR filters can skip the computation of discarded samples
+    auto fir = dynamic_cast<dsp::filter::FirFilter *>(filter.get());
+    if (fir == nullptr) {
+        throw ProcessingConfigureError(
+            "Anti-aliasing filter needs to be a FIR filter.", name());
+    }
+    filter.release();
+    filter_template_.reset(fir);
+
+    LOG(INFO) << name() << ". Anti-aliasing filter with "
+              << filter_template_->order() + 1 << " taps (group delay "
+              << filter_template_->group_delay() << " samples).";
 }
 
 void Rebuffer::CompleteStreamInfo() {
@@ -97,6 +128,21 @@ void Rebuffer::CompleteStreamInfo() {
     }
 }
 
+void Rebuffer::Prepare(GlobalContext &context) {
+    filters_.clear();
+
+    if (!filter_template_) {
+        return;
+    }
+
+    for (int k = 0; k < data_in_port_->number_of_slots(); ++k) {
+        filters_.emplace_back(
+            static_cast<dsp::filter::FirFilter *>(filter_template_->clone()));
+        filters_.back()->realize(
+            data_in_port_->streaminfo(k).parameters().nchannels);
+    }
+}
+
 void Rebuffer::Process(ProcessingContext &context) {
     auto nslots = data_in_port_->number_of_slots();
 
@@ -109,6 +155,9 @@ void Rebuffer::Process(ProcessingContext &context) {
     offset.assign(nslots, 0);
 
     unsigned int s = 0;
+    // next input sample that still needs to enter the filter delay line
+    unsigned int filtered = 0;
+    bool filter = !filters_.empty();
 
     while (!context.terminated()) {
         // go through all slots
@@ -119,15 +168,25 @@ void Rebuffer::Process(ProcessingContext &context) {
             }
 
             s = 0;
+            filtered = 0;
 
             while (s < data_in->nsamples()) {
                 for (s = offset[k]; s < data_in->nsamples() &&
                                     sample_out_counter[k] < sample_buffer_[k];
                      s += downsample_factor_()) {
-                    for (unsigned int c = 0; c < data_in->nchannels(); ++c) {
-                        data_out[k]->set_data_sample(
-                            sample_out_counter[k], c,
-                            data_in->data_sample(s, c));
+                    if (filter) {
+                        for (; filtered < s; ++filtered) {
+                            filters_[k]->skip_sample(
+                                data_in->begin_sample(filtered));
+                        }
+                        filters_[k]->process_sample(
+                            data_in->begin_sample(s),
+                            data_out[k]->begin_sample(sample_out_counter[k]));
+                        filtered = s + 1;
+                    } else {
+                        std::copy(
+                            data_in->begin_sample(s), data_in->end_sample(s),
+                            data_out[k]->begin_sample(sample_out_counter[k]));
                     }
                     data_out[k]->set_sample_timestamp(
                         sample_out_counter[k], data_in->sample_timestamp(s));
@@ -148,6 +207,12 @@ void Rebuffer::Process(ProcessingContext &context) {
                 }
             }
 
+            if (filter) {
+                for (; filtered < data_in->nsamples(); ++filtered) {
+                    filters_[k]->skip_sample(data_in->begin_sample(filtered));
+                }
+            }
+
             data_in_port_->slot(k)->ReleaseData();
         }
     }
@@ -19,10 +19,12 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "iprocessor.hpp"
 #include "multichanneldata/multichanneldata.hpp"
+#include <dsp/filter.hpp>
 
 #include "options/options.hpp"
 #include "options/units.hpp"
@@ -34,6 +36,7 @@ class Rebuffer : public IProcessor {
     Rebuffer();
     void Configure(const GlobalContext &context) override;
     void CreatePorts() override;
+    void Prepare(GlobalContext &context) override;
     void Process(ProcessingContext &context) override;
     void CompleteStreamInfo() override;
 
@@ -46,6 +49,10 @@ class Rebuffer : public IProcessor {
   protected:
     std::vector<unsigned int> sample_buffer_;
 
+    // optional anti-aliasing filter, only evaluated for retained samples
+    std::unique_ptr<dsp::filter::FirFilter> filter_template_;
+    std::vector<std::unique_ptr<dsp::filter::FirFilter>> filters_;
+
     // OPTIONS
   protected:
     options::Value<unsigned int, false> downsample_factor_{
@@ -53,4 +60,6 @@ class Rebuffer : public IProcessor {
 
     options::Measurement<double, false> buffer_size_{
         10., "sample", options::positive<double>(), {"second"}};
+
+    options::Value<YAML::Node, false> filter_def_{};
 };
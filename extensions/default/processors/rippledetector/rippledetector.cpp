@@ -38,12 +38,28 @@ RippleDetector::RippleDetector() : IProcessor() {
     add_option("statistics downsample factor", stats_downsample_factor_,
                "Downsample factor of streamed statistics signal");
     add_option("use power", use_power_, "Use power of signal for detection.");
+    add_option("data type", sample_type_,
+               "Element type of the input samples (float64 or float32).");
 }
 
-void RippleDetector::CreatePorts() {
-    data_in_port_ = create_input_port<MultiChannelType<double>>(
-        "data", MultiChannelType<double>::Capabilities(ChannelRange(1, 256)),
+template <typename T> void RippleDetector::CreateInputPort() {
+    data_in_port_ = create_input_port<MultiChannelType<T>>(
+        "data",
+        typename MultiChannelType<T>::Capabilities(ChannelRange(1, 256)),
         PortInPolicy(SlotRange(1)));
+}
+
+nsMultiChannel::Parameters RippleDetector::input_parameters() {
+    nsMultiChannel::Parameters parameters;
+    dispatch_sample_type<double, float>(sample_type_(), [&](auto x) {
+        parameters = data_in_port<decltype(x)>()->streaminfo(0).parameters();
+    });
+    return parameters;
+}
+
+void RippleDetector::CreatePorts() {
+    dispatch_sample_type<double, float>(
+        sample_type_(), [this](auto x) { CreateInputPort<decltype(x)>(); });
 
     event_out_port_ = create_output_port<EventType>(
         EVENTDATA, EventType::Capabilities(), EventType::Parameters("ripple"),
@@ -85,19 +101,20 @@ void RippleDetector::CreatePorts() {
 }
 
 void RippleDetector::CompleteStreamInfo() {
-    stats_nsamples_ = stats_buffer_size_() *
-                      data_in_port_->streaminfo(0).parameters().sample_rate /
-                      stats_downsample_factor_();
+    double sample_rate = input_parameters().sample_rate;
+    stats_nsamples_ =
+        stats_buffer_size_() * sample_rate / stats_downsample_factor_();
     stats_nsamples_ =
         std::max(static_cast<unsigned long>(stats_nsamples_), 1UL);
 
     stats_out_port_->streaminfo(0).set_parameters(
         MultiChannelType<double>::Parameters(
             N_STATS_OUT, stats_nsamples_,
-            data_in_port_->streaminfo(0).parameters().sample_rate /
-                stats_downsample_factor_()));
-    stats_out_port_->streaminfo(0).set_stream_rate(
-        data_in_port_->streaminfo(0));
+            sample_rate / stats_downsample_factor_()));
+    dispatch_sample_type<double, float>(sample_type_(), [this](auto x) {
+        stats_out_port_->streaminfo(0).set_stream_rate(
+            data_in_port<decltype(x)>()->streaminfo(0));
+    });
 }
 
 void RippleDetector::Preprocess(ProcessingContext &context) {
@@ -106,8 +123,7 @@ void RippleDetector::Preprocess(ProcessingContext &context) {
     signal_dev_->set(0);
     threshold_->set(0);
     block_ = 0;
-    sample_rate_ =
-        data_in_port_->slot(0)->streaminfo().parameters().sample_rate;
+    sample_rate_ = input_parameters().sample_rate;
     burn_in_ = initial_smooth_time_() * sample_rate_;
     double alpha = 1.0 / burn_in_;
 
@@ -117,7 +133,15 @@ void RippleDetector::Preprocess(ProcessingContext &context) {
 }
 
 void RippleDetector::Process(ProcessingContext &context) {
-    MultiChannelType<double>::Data *data_in = nullptr;
+    dispatch_sample_type<double, float>(sample_type_(), [&](auto x) {
+        ProcessSamples<decltype(x)>(context);
+    });
+}
+
+template <typename T>
+void RippleDetector::ProcessSamples(ProcessingContext &context) {
+    auto in_port = data_in_port<T>();
+    typename MultiChannelType<T>::Data *data_in = nullptr;
     EventType::Data *event_out = nullptr;
     MultiChannelType<double>::Data *stats_out = nullptr;
     double value, test_value;
@@ -127,7 +151,7 @@ void RippleDetector::Process(ProcessingContext &context) {
 
     // burn-in period
     while (running_statistics_->is_burning_in() && !context.terminated()) {
-        if (!data_in_port_->slot(0)->RetrieveData(data_in)) {
+        if (!in_port->slot(0)->RetrieveData(data_in)) {
             break;
         }
 
@@ -137,10 +161,11 @@ void RippleDetector::Process(ProcessingContext &context) {
             burnin_update_sent = true;
         }
         for (unsigned int sample = 0; sample < data_in->nsamples(); ++sample) {
-            running_statistics_->add_sample(compute_value(data_in, sample));
+            running_statistics_->add_sample(
+                compute_value<T>(data_in, sample));
         }
 
-        data_in_port_->slot(0)->ReleaseData();
+        in_port->slot(0)->ReleaseData();
     }
 
     if (!running_statistics_->is_burning_in()) {
@@ -158,7 +183,7 @@ void RippleDetector::Process(ProcessingContext &context) {
     // ripple detection
     while (!context.terminated()) {
         // retrieve new data
-        if (!data_in_port_->slot(0)->RetrieveData(data_in)) {
+        if (!in_port->slot(0)->RetrieveData(data_in)) {
             break;
         }
 
@@ -171,7 +196,7 @@ void RippleDetector::Process(ProcessingContext &context) {
 
         // loop through each sample
         for (unsigned int sample = 0; sample < data_in->nsamples(); ++sample) {
-            value = compute_value(data_in, sample);
+            value = compute_value<T>(data_in, sample);
             test_value = std::abs(value - running_statistics_->center());
 
             if (stats_out_->get()) {
@@ -224,7 +249,7 @@ void RippleDetector::Process(ProcessingContext &context) {
 
             running_statistics_->add_sample(value);
         }
-        data_in_port_->slot(0)->ReleaseData();
+        in_port->slot(0)->ReleaseData();
         signal_mean_->set(running_statistics_->center());
         signal_dev_->set(running_statistics_->dispersion());
     }
@@ -236,8 +261,9 @@ void RippleDetector::Postprocess(ProcessingContext &context) {
               << " ripple events.";
 }
 
+template <typename T>
 inline double
-RippleDetector::compute_value(MultiChannelType<double>::Data *data_in,
+RippleDetector::compute_value(typename MultiChannelType<T>::Data *data_in,
                               unsigned int sample) {
     if (use_power_()) {
         acc_ = std::pow(*data_in->begin_sample(sample), 2);
@@ -41,12 +41,23 @@ class RippleDetector : public IProcessor {
 
     // METHODS
   protected:
-    double compute_value(MultiChannelType<double>::Data *data_in,
+    template <typename T> void CreateInputPort();
+    template <typename T> void ProcessSamples(ProcessingContext &context);
+
+    template <typename T>
+    double compute_value(typename MultiChannelType<T>::Data *data_in,
                          unsigned int sample);
 
+    template <typename T> PortIn<MultiChannelType<T>> *data_in_port() {
+        return static_cast<PortIn<MultiChannelType<T>> *>(data_in_port_);
+    }
+
+    // parameters of the incoming stream, independent of the element type
+    nsMultiChannel::Parameters input_parameters();
+
     // DATA PORTS
   protected:
-    PortIn<MultiChannelType<double>> *data_in_port_;
+    IPortIn *data_in_port_; // element type selected by the data type option
     PortOut<EventType> *event_out_port_;
     PortOut<MultiChannelType<double>> *stats_out_port_;
 
@@ -98,4 +109,5 @@ class RippleDetector : public IProcessor {
     options::Value<unsigned int, false> stats_downsample_factor_{
         1, options::positive<unsigned int>(true)};
     options::Bool use_power_{true};
+    options::Value<SampleType, false> sample_type_{SampleType::FLOAT64};
 };
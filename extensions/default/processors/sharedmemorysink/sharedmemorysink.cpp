@@ -0,0 +1,185 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "sharedmemorysink.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "eventdata/eventdata.hpp"
+#include "idata.hpp"
+#include "multichanneldata/multichanneldata.hpp"
+
+namespace {
+
+// stream buffer over the record storage of a ring slot, so that data
+// packets are serialized directly into shared memory
+class RecordBuffer : public std::streambuf {
+  public:
+    void Reset(uint8_t *record, std::size_t size) {
+        char *p = reinterpret_cast<char *>(record);
+        setp(p, p + size);
+    }
+    std::size_t size() const { return pptr() - pbase(); }
+};
+
+void copy_string(char *dst, std::size_t n, const std::string &src) {
+    std::size_t len = std::min(src.size(), n - 1);
+    std::memcpy(dst, src.data(), len);
+    dst[len] = '\0';
+}
+
+} // namespace
+
+SharedMemorySink::SharedMemorySink() : IProcessor() {
+    add_option("name", segment_name_,
+               "Name of the shared memory segments. The ring of input slot k "
+               "is exported as /<name>.<k>. Defaults to the processor name.");
+    add_option("capacity", capacity_,
+               "Number of data packets held in each ring, rounded up to a "
+               "power of two. Readers that fall further behind lose "
+               "packets.");
+}
+
+void SharedMemorySink::CreatePorts() {
+    data_port_ =
+        create_input_port<AnyType>("data", AnyType::Capabilities(),
+                                   PortInPolicy(SlotRange(1, 256), false, 0));
+}
+
+void SharedMemorySink::describe(shmring::RingHeader &header,
+                                const AnyType::Data *prototype) const {
+    std::string datatype = "other";
+
+    auto multichannel = [&](auto x) {
+        using T = decltype(x);
+        auto data = dynamic_cast<const typename MultiChannelType<T>::Data *>(
+            prototype);
+        if (data == nullptr) {
+            return;
+        }
+        datatype = MultiChannelType<T>::datatype();
+        copy_string(header.sample_type, sizeof(header.sample_type),
+                    sampletype_to_string(sample_type_of<T>::value));
+        header.nchannels = data->nchannels();
+        header.nsamples = data->nsamples();
+        header.sample_rate = data->sample_rate();
+        header.sample_scale = data->sample_scale();
+    };
+    multichannel(double{});
+    multichannel(float{});
+    multichannel(int16_t{});
+
+    if (dynamic_cast<const EventType::Data *>(prototype) != nullptr) {
+        datatype = EventType::datatype();
+    }
+    copy_string(header.datatype, sizeof(header.datatype), datatype);
+
+    YAML::Node node;
+    prototype->YAMLDescription(node, Serialization::Format::FULL);
+    YAML::Emitter emit;
+    emit << YAML::Flow << node;
+    if (emit.size() >= sizeof(header.description)) {
+        LOG(WARNING) << name() << ": truncated description of "
+                     << "shared memory ring " << header.datatype << ".";
+    }
+    copy_string(header.description, sizeof(header.description),
+                emit.c_str());
+}
+
+void SharedMemorySink::Preprocess(ProcessingContext &context) {
+    std::string base = segment_name_().empty() ? name() : segment_name_();
+    rings_.clear();
+
+    for (SlotType k = 0; k < data_port_->number_of_slots(); ++k) {
+        auto prototype = data_port_->slot(k)->GetDataPrototype();
+
+        // records have a fixed size, which is taken from the prototype
+        std::ostringstream record;
+        prototype->SerializeBinary(record, Serialization::Format::FULL);
+
+        try {
+            rings_.push_back(std::make_unique<shmring::RingWriter>(
+                base + "." + std::to_string(k), capacity_(),
+                record.str().size()));
+        } catch (std::runtime_error &e) {
+            rings_.clear();
+            throw ProcessingPrepareError(e.what(), name());
+        }
+
+        describe(rings_.back()->header(), prototype);
+        rings_.back()->Open();
+
+        LOG(INFO) << name() << ": exporting stream " << k
+                  << " through shared memory ring " << rings_.back()->name()
+                  << " (" << rings_.back()->header().capacity
+                  << " packets of " << record.str().size() << " bytes).";
+    }
+
+    packetid_.assign(data_port_->number_of_slots(), 0);
+    ndropped_.assign(data_port_->number_of_slots(), 0);
+}
+
+void SharedMemorySink::Process(ProcessingContext &context) {
+    std::vector<typename AnyType::Data *> data;
+    RecordBuffer buffer;
+    std::ostream stream(&buffer);
+
+    while (!context.terminated()) {
+        for (int k = 0; k < data_port_->number_of_slots(); ++k) {
+            if (!data_port_->slot(k)->RetrieveDataAll(data)) {
+                break;
+            }
+
+            auto &ring = *rings_[k];
+            for (auto &it : data) {
+                // the writer never waits for readers, slow readers lose
+                // packets instead
+                buffer.Reset(ring.Claim(), ring.record_size());
+                stream.clear();
+                it->SerializeBinary(stream, Serialization::Format::FULL);
+                if (stream.good()) {
+                    ring.Publish(buffer.size());
+                } else {
+                    LOG_IF(WARNING, ndropped_[k] == 0)
+                        << name() << ": data packet of stream " << k
+                        << " does not fit in shared memory ring record.";
+                    ++ndropped_[k];
+                }
+                ++packetid_[k];
+            }
+            data_port_->slot(k)->ReleaseData();
+        }
+    }
+}
+
+void SharedMemorySink::Postprocess(ProcessingContext &context) {
+    for (SlotType k = 0; k < data_port_->number_of_slots(); ++k) {
+        LOG(UPDATE) << name() << ": stream " << k << ": exported "
+                    << packetid_[k] - ndropped_[k] << " of " << packetid_[k]
+                    << " data packets through shared memory.";
+    }
+    // closes the rings and removes the segments, readers that still have a
+    // ring mapped see it as closed
+    rings_.clear();
+}
+
+REGISTERPROCESSOR(SharedMemorySink)
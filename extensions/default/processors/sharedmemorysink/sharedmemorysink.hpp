@@ -0,0 +1,58 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "iprocessor.hpp"
+#include "options/options.hpp"
+#include "shmring/shmring.hpp"
+
+class SharedMemorySink : public IProcessor {
+    // CONSTRUCTOR and OVERLOADED METHODS
+  public:
+    SharedMemorySink();
+    void CreatePorts() override;
+    void Preprocess(ProcessingContext &context) override;
+    void Process(ProcessingContext &context) override;
+    void Postprocess(ProcessingContext &context) override;
+
+    // HELPER METHODS
+  protected:
+    void describe(shmring::RingHeader &header,
+                  const AnyType::Data *prototype) const;
+
+    // DATA PORTS
+  protected:
+    PortIn<AnyType> *data_port_;
+
+    // OPTIONS
+  protected:
+    options::String segment_name_{};
+    options::Value<unsigned int, false> capacity_{
+        1024, options::inrange<unsigned int>(2, 1 << 20)};
+
+    // VARIABLES
+  protected:
+    std::vector<std::unique_ptr<shmring::RingWriter>> rings_;
+    std::vector<uint64_t> packetid_;
+    std::vector<uint64_t> ndropped_;
+};
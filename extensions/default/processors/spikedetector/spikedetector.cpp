@@ -31,13 +31,29 @@ SpikeDetector::SpikeDetector() : IProcessor() {
                "with the upstream processor");
     add_option(PEAK_LIFETIME, initial_peak_lifetime_,
                "Peak life time in samples");
+    add_option("data type", sample_type_,
+               "Element type of the input samples (float64 or float32).");
 }
 
-void SpikeDetector::CreatePorts() {
-    data_in_port_ = create_input_port<MultiChannelType<double>>(
+template <typename T> void SpikeDetector::CreateInputPort() {
+    data_in_port_ = create_input_port<MultiChannelType<T>>(
         "data",
-        MultiChannelType<double>::Capabilities(ChannelRange(1, MAX_N_CHANNELS)),
+        typename MultiChannelType<T>::Capabilities(
+            ChannelRange(1, MAX_N_CHANNELS)),
         PortInPolicy(SlotRange(1)));
+}
+
+nsMultiChannel::Parameters SpikeDetector::input_parameters() {
+    nsMultiChannel::Parameters parameters;
+    dispatch_sample_type<double, float>(sample_type_(), [&](auto x) {
+        parameters = data_in_port<decltype(x)>()->streaminfo(0).parameters();
+    });
+    return parameters;
+}
+
+void SpikeDetector::CreatePorts() {
+    dispatch_sample_type<double, float>(
+        sample_type_(), [this](auto x) { CreateInputPort<decltype(x)>(); });
 
     data_out_port_spikes_ = create_output_port<SpikeType>(
         SPIKEDATA, SpikeType::Capabilities(ChannelRange(1, MAX_N_CHANNELS)),
@@ -56,12 +72,15 @@ void SpikeDetector::CreatePorts() {
 }
 
 void SpikeDetector::CompleteStreamInfo() {
-    double incoming_stream_rate = data_in_port_->streaminfo(0).stream_rate();
-    incoming_buffer_size_samples_ =
-        data_in_port_->slot(0)->streaminfo().parameters().nsamples;
+    double incoming_stream_rate = 0.0;
+    dispatch_sample_type<double, float>(sample_type_(), [&](auto x) {
+        incoming_stream_rate =
+            data_in_port<decltype(x)>()->streaminfo(0).stream_rate();
+    });
+    auto incoming = input_parameters();
+    incoming_buffer_size_samples_ = incoming.nsamples;
     double incoming_buffer_size_ms =
-        incoming_buffer_size_samples_ /
-        data_in_port_->slot(0)->streaminfo().parameters().sample_rate * 1000;
+        incoming_buffer_size_samples_ / incoming.sample_rate * 1000;
 
     try {
         double tmp = buffer_size_();
@@ -73,7 +92,7 @@ void SpikeDetector::CompleteStreamInfo() {
         throw ProcessingStreamInfoError(error.what(), name());
     }
 
-    n_channels_ = data_in_port_->slot(0)->streaminfo().parameters().nchannels;
+    n_channels_ = incoming.nchannels;
     auto parms = data_out_port_spikes_->streaminfo(0).parameters();
     parms.nchannels = n_channels_;
     parms.sample_rate = incoming_stream_rate;
@@ -86,18 +105,27 @@ void SpikeDetector::CompleteStreamInfo() {
 void SpikeDetector::Prepare(GlobalContext &context) {
     spike_detector_.reset(new dsp::algorithms::SpikeDetector(
         n_channels_, initial_threshold_(), initial_peak_lifetime_()));
-
-    if (invert_signal_()) {
-        inverted_signals_.reset(new MultiChannelType<double>::Data());
-        inverted_signals_->Initialize(
-            n_channels_, incoming_buffer_size_samples_,
-            data_in_port_->slot(0)->streaminfo().parameters().sample_rate);
-    }
 }
 
 void SpikeDetector::Process(ProcessingContext &context) {
-    MultiChannelType<double>::Data *data_in_;
-    MultiChannelType<double>::Data *signals = nullptr;
+    dispatch_sample_type<double, float>(sample_type_(), [&](auto x) {
+        ProcessSamples<decltype(x)>(context);
+    });
+}
+
+template <typename T>
+void SpikeDetector::ProcessSamples(ProcessingContext &context) {
+    auto in_port = data_in_port<T>();
+    typename MultiChannelType<T>::Data *data_in_;
+    typename MultiChannelType<T>::Data *signals = nullptr;
+
+    // local copy of the signal for detection on the inverted signal
+    std::unique_ptr<typename MultiChannelType<T>::Data> inverted_signals;
+    if (invert_signal_()) {
+        inverted_signals.reset(new typename MultiChannelType<T>::Data());
+        inverted_signals->Initialize(n_channels_, incoming_buffer_size_samples_,
+                                     input_parameters().sample_rate);
+    }
 
     size_t sample_buffer_counter = 0;
     decltype(data_in_->hardware_timestamp()) hw_timestamp = 0;
@@ -119,7 +147,7 @@ void SpikeDetector::Process(ProcessingContext &context) {
 
         // look for spikes
         while (sample_buffer_counter < n_incoming_) {
-            if (!data_in_port_->slot(0)->RetrieveData(data_in_)) {
+            if (!in_port->slot(0)->RetrieveData(data_in_)) {
                 break;
             }
 
@@ -137,12 +165,12 @@ void SpikeDetector::Process(ProcessingContext &context) {
                      ++sample) {
                     for (unsigned int channel = 0; channel < n_channels_;
                          ++channel) {
-                        inverted_signals_->set_data_sample(
+                        inverted_signals->set_data_sample(
                             sample, channel,
                             -data_in_->data_sample(sample, channel));
                     }
                 }
-                signals = inverted_signals_.get();
+                signals = inverted_signals.get();
             } else {
                 signals = data_in_;
             }
@@ -150,7 +178,7 @@ void SpikeDetector::Process(ProcessingContext &context) {
             // detect spikes sample by sample and collect each detected spike
             for (size_t sample = 0; sample < incoming_buffer_size_samples_;
                  ++sample) {
-                if (spike_detector_->is_spike<double *>(
+                if (spike_detector_->is_spike<T *>(
                         data_in_->sample_timestamp(sample),
                         signals->begin_sample(sample))) {
                     spike_data_out_->add_spike(
@@ -162,7 +190,7 @@ void SpikeDetector::Process(ProcessingContext &context) {
             ++sample_buffer_counter;
             spike_data_out_->set_hardware_timestamp(hw_timestamp);
             spike_data_out_->set_source_timestamp();
-            data_in_port_->slot(0)->ReleaseData();
+            in_port->slot(0)->ReleaseData();
         }
 
         // publish results on the two ports
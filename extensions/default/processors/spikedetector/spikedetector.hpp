@@ -39,9 +39,21 @@ class SpikeDetector : public IProcessor {
     void Process(ProcessingContext &context) override;
     void Postprocess(ProcessingContext &context) override;
 
+    // METHODS
+  protected:
+    template <typename T> void CreateInputPort();
+    template <typename T> void ProcessSamples(ProcessingContext &context);
+
+    template <typename T> PortIn<MultiChannelType<T>> *data_in_port() {
+        return static_cast<PortIn<MultiChannelType<T>> *>(data_in_port_);
+    }
+
+    // parameters of the incoming stream, independent of the element type
+    nsMultiChannel::Parameters input_parameters();
+
     // PORTS
   protected:
-    PortIn<MultiChannelType<double>> *data_in_port_;
+    IPortIn *data_in_port_; // element type selected by the data type option
     PortOut<SpikeType> *data_out_port_spikes_;
     PortOut<EventType> *data_out_port_events_;
 
@@ -58,7 +70,6 @@ class SpikeDetector : public IProcessor {
     uint64_t n_streamed_events_;
 
     std::unique_ptr<dsp::algorithms::SpikeDetector> spike_detector_;
-    std::unique_ptr<MultiChannelType<double>::Data> inverted_signals_;
 
     // CONSTANTS
   public:
@@ -76,4 +87,5 @@ class SpikeDetector : public IProcessor {
     options::Bool strict_time_bin_check_{true};
     options::Measurement<unsigned int, false> initial_peak_lifetime_{8,
                                                                      "sample"};
+    options::Value<SampleType, false> sample_type_{SampleType::FLOAT64};
 };
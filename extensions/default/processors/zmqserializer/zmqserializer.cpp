@@ -23,7 +23,6 @@
 #include <utility>
 
 #include "idata.hpp"
-#include "utilities/zmqutil.hpp"
 
 ZMQSerializer::ZMQSerializer() : IProcessor() {
     add_option("port", port_,
@@ -38,6 +37,21 @@ ZMQSerializer::ZMQSerializer() : IProcessor() {
     add_option("interleave", interleave_,
                "Interleave data streams from all input slots and stream to "
                "single network port.");
+
+    add_option("multipart", multipart_,
+               "Send all data packets that are available on a slot at once as "
+               "a single multipart message, with one part per packet.");
+}
+
+void ZMQSerializer::Configure(const GlobalContext &context) {
+    // packed blocks are delta encoded against the previous message of the
+    // stream, which a subscriber that joins late or misses a message (e.g.
+    // at the high-water mark) does not have
+    if (encoding_() == Serialization::Encoding::PACKED) {
+        throw ProcessingConfigureError(
+            "The packed encoding cannot be used for network streams.",
+            name());
+    }
 }
 
 void ZMQSerializer::CreatePorts() {
@@ -65,13 +79,17 @@ void ZMQSerializer::Preprocess(ProcessingContext &context) {
     }
 
     serializer_.reset(Serialization::serializer(encoding_(), format_()));
+    buffer_pool_.reset(new ZMQBufferPool());
     packetid_.assign(data_port_->number_of_slots(), 0);
 }
 
 void ZMQSerializer::Process(ProcessingContext &context) {
     std::vector<typename AnyType::Data *> data;
+    std::vector<ZMQBufferPool::Buffer *> batch;
     unsigned int idx = 0;
-    std::stringstream buffer;
+    // serializes directly into pooled message buffers, which are handed to
+    // zmq without copying
+    std::ostream stream(nullptr);
 
     while (!context.terminated()) {
         for (int k = 0; k < data_port_->number_of_slots(); ++k) {
@@ -84,23 +102,36 @@ void ZMQSerializer::Process(ProcessingContext &context) {
             }
 
             for (auto &it : data) {
-                buffer.str("");
-                buffer.clear();
+                auto buffer = buffer_pool_->Acquire();
+                stream.rdbuf(buffer);
+                stream.clear();
 
                 if (serializer_->Serialize(
-                        buffer, it, k, packetid_[k]++,
+                        stream, it, k, packetid_[k]++,
                         data_port_->slot(k)->upstream_address().processor(),
                         data_port_->slot(k)->upstream_address().port(),
                         data_port_->slot(k)->upstream_address().slot())) {
-                    if (!s_send(*(sockets_[idx]), buffer.str())) {
+                    if (multipart_()) {
+                        batch.push_back(buffer);
+                    } else if (!buffer_pool_->Send(*(sockets_[idx]), buffer)) {
                         LOG(DEBUG) << "failed to send zmq message.";
                     }
                 } else {
+                    buffer_pool_->Release(buffer);
                     LOG(WARNING)
                         << name() << ": Unable to serialize data stream " << k;
                 }
             }
             data_port_->slot(k)->ReleaseData();
+
+            for (std::size_t n = 0; n < batch.size(); ++n) {
+                if (!buffer_pool_->Send(*(sockets_[idx]), batch[n],
+                                        n + 1 < batch.size() ? ZMQ_SNDMORE
+                                                             : 0)) {
+                    LOG(DEBUG) << "failed to send zmq message part.";
+                }
+            }
+            batch.clear();
         }
     }
 }
@@ -109,6 +140,10 @@ void ZMQSerializer::Postprocess(ProcessingContext &context) {
     sockets_.clear();
     serializer_.reset();
 
+    LOG(DEBUG) << name() << ": allocated " << buffer_pool_->nallocated()
+               << " message buffers.";
+    buffer_pool_.reset();
+
     for (SlotType k = 0; k < data_port_->number_of_slots(); k++) {
         LOG(UPDATE) << name() << ": stream " << k
                     << ": received and serialized over network " << packetid_[k]
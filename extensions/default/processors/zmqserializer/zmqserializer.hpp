@@ -26,12 +26,14 @@
 #include "iprocessor.hpp"
 #include "options/options.hpp"
 #include "serializer.hpp"
+#include "utilities/zmqutil.hpp"
 #include "yaml-cpp/yaml.h"
 
 class ZMQSerializer : public IProcessor {
     // CONSTRUCTOR and OVERLOADED METHODS
   public:
     ZMQSerializer();
+    void Configure(const GlobalContext &context) override;
     void CreatePorts() override;
     void Preprocess(ProcessingContext &context) override;
     void Process(ProcessingContext &context) override;
@@ -49,10 +51,12 @@ class ZMQSerializer : public IProcessor {
     options::Value<Serialization::Format, false> format_{
         Serialization::Format::FULL};
     options::Bool interleave_{false};
+    options::Bool multipart_{false};
 
     // VARIABLES
   protected:
     std::vector<std::unique_ptr<zmq::socket_t>> sockets_;
     std::vector<uint64_t> packetid_;
     std::unique_ptr<Serialization::Serializer> serializer_;
+    std::unique_ptr<ZMQBufferPool> buffer_pool_;
 };
@@ -164,6 +164,10 @@ int main(int argc, char **argv) {
 
     std::cout << "filter description: " << filter->description() << std::endl;
     std::cout << "filter order: " << filter->order() << std::endl;
+    std::cout << "simd instruction set: "
+              << dsp::simd::instruction_set_to_string(
+                     dsp::simd::instruction_set())
+              << std::endl;
 
     // 1. filter input signal
     test_filter_signal(parser.get<std::string>("signal"),
@@ -21,6 +21,7 @@
 #include <iostream>
 
 #include "filesource.hpp"
+#include "packedfilesource.hpp"
 #include "ripplesource.hpp"
 #include "sinesource.hpp"
 #include "squaresource.hpp"
@@ -50,6 +51,9 @@ datasources_from_yaml(const YAML::Node &node) {
                 if (source_class == "nlx") {
                     sources.push_back(std::unique_ptr<DataSource>(
                         FileSource::from_yaml((*it)["options"])));
+                } else if (source_class == "packed") {
+                    sources.push_back(std::unique_ptr<DataSource>(
+                        PackedFileSource::from_yaml((*it)["options"])));
                 } else if (source_class == "noise") {
                     sources.push_back(std::unique_ptr<DataSource>(
                         WhiteNoiseSource::from_yaml((*it)["options"])));
@@ -0,0 +1,206 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "packedfilesource.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <regex>
+
+#include "utilities/string.hpp"
+
+PackedFileSource::PackedFileSource(std::string file, bool cycle,
+                                   bool convert_byte_order)
+    : file_(file), cycle_(cycle), convert_byte_order_(convert_byte_order) {
+    stream_.open(file_, std::ios::in | std::ios::binary);
+    if (!stream_) {
+        throw std::runtime_error("Unable to open file " + file_ +
+                                 ". Check if filepath is correct.\n");
+    }
+
+    ReadPreamble();
+
+    samples_.resize(nchannels_ * nsamples_);
+    timestamps_.resize(nsamples_);
+    counts_.resize(nchannels_);
+    next_sample_ = nsamples_;
+
+    record_.set_nchannels(nchannels_);
+    record_.set_convert_byte_order(convert_byte_order_);
+}
+
+void PackedFileSource::ReadPreamble() {
+    // the preamble is a single YAML document, terminated by "..."
+    std::string line;
+    std::string document;
+    std::getline(stream_, line);
+    if (line != "---") {
+        throw std::runtime_error("File " + file_ + " has no preamble.");
+    }
+    while (std::getline(stream_, line) && line != "...") {
+        document += line + "\n";
+    }
+    if (!stream_) {
+        throw std::runtime_error("Incomplete preamble in file " + file_ + ".");
+    }
+    data_start_ = stream_.tellg();
+
+    YAML::Node preamble = YAML::Load(document);
+    if (preamble["encoding"].as<std::string>("") != "PACKED" ||
+        preamble["format"].as<std::string>("") != "FULL") {
+        throw std::runtime_error("File " + file_ +
+                                 " is not a packed recording in full format.");
+    }
+
+    // each record is a sequence of fixed size header fields, followed by the
+    // encoded block of timestamps and samples
+    static const std::map<std::string, std::size_t> type_size{
+        {"uint8", 1},  {"int8", 1},   {"uint16", 2},  {"int16", 2},
+        {"uint32", 4}, {"int32", 4},  {"float32", 4}, {"uint64", 8},
+        {"int64", 8},  {"float64", 8}};
+    std::regex field("(\\S+) (\\S+) \\((\\d+)(?:,(\\d+))?\\)");
+    std::smatch match;
+    bool found = false;
+    for (const auto &it : preamble["data"]) {
+        std::string description = it.as<std::string>();
+        if (!std::regex_match(description, match, field)) {
+            throw std::runtime_error("Cannot parse data description \"" +
+                                     description + "\".");
+        }
+        if (match[1] == "signal") {
+            sample_type_ = match[2];
+            nchannels_ = std::stoul(match[3]);
+            nsamples_ = match[4].matched ? std::stoul(match[4]) : 1;
+            found = true;
+            break;
+        }
+        if (match[1] == "timestamps") {
+            continue;
+        }
+        auto size = type_size.find(match[2]);
+        if (size == type_size.end()) {
+            throw std::runtime_error("Unknown type in data description \"" +
+                                     description + "\".");
+        }
+        header_size_ += size->second * std::stoul(match[3]);
+    }
+
+    if (!found || nchannels_ == 0 || nsamples_ == 0) {
+        throw std::runtime_error("File " + file_ +
+                                 " does not contain multichannel data.");
+    }
+    if (sample_type_ != "float64" && sample_type_ != "float32" &&
+        sample_type_ != "int16") {
+        throw std::runtime_error("Unsupported sample type " + sample_type_ +
+                                 ".");
+    }
+    // int16 recordings of Neuralynx streams hold raw AD values
+    sample_scale_ = sample_type_ == "int16" ? nlx::NLX_AD_BIT_MICROVOLTS : 1.0;
+}
+
+std::string PackedFileSource::string() {
+    return "packed file \"" + file() + "\" (" + sample_type_ +
+           ", nchannels = " + std::to_string(nchannels_) +
+           ", nsamples = " + std::to_string(nsamples_) +
+           ", convert byte order = " + std::to_string(convert_byte_order_) +
+           ")";
+}
+
+std::string PackedFileSource::file() const { return file_; }
+
+template <typename T> bool PackedFileSource::DecodeRecord() {
+    std::vector<T> samples(samples_.size());
+    const uint8_t *end = block_.data() + block_.size();
+    if (decoder_.Decode(block_.data(), end, nchannels_, nsamples_,
+                        samples.data(), timestamps_.data()) != end) {
+        return false;
+    }
+    std::copy(samples.begin(), samples.end(), samples_.begin());
+    return true;
+}
+
+bool PackedFileSource::ReadRecord() {
+    uint32_t size;
+    stream_.ignore(header_size_);
+    stream_.read(reinterpret_cast<char *>(&size), sizeof(size));
+    if (!stream_) {
+        return false;
+    }
+    block_.resize(size);
+    stream_.read(reinterpret_cast<char *>(block_.data()), size);
+    if (!stream_) {
+        return false;
+    }
+
+    bool ok;
+    if (sample_type_ == "float64") {
+        ok = DecodeRecord<double>();
+    } else if (sample_type_ == "float32") {
+        ok = DecodeRecord<float>();
+    } else {
+        ok = DecodeRecord<int16_t>();
+    }
+    if (!ok) {
+        throw std::runtime_error("Corrupt record in file " + file_ + ".");
+    }
+    next_sample_ = 0;
+    return true;
+}
+
+int64_t PackedFileSource::Produce(char **data) {
+    if (next_sample_ == nsamples_ && !ReadRecord()) {
+        if (!cycle_) {
+            return 0;
+        }
+        stream_.clear();
+        stream_.seekg(data_start_);
+        decoder_.Reset();
+        if (!ReadRecord()) {
+            return 0;
+        }
+    }
+
+    const double *sample = samples_.data() + next_sample_ * nchannels_;
+    for (unsigned int c = 0; c < nchannels_; ++c) {
+        counts_[c] = static_cast<int32_t>(std::lround(
+            sample[c] * sample_scale_ / nlx::NLX_AD_BIT_MICROVOLTS));
+    }
+    record_.set_data(counts_);
+    record_.set_timestamp(timestamps_[next_sample_]);
+    ++next_sample_;
+
+    auto n = record_.ToNetworkBuffer(buffer_);
+    *data = buffer_.data();
+    return n;
+}
+
+YAML::Node PackedFileSource::to_yaml() const {
+    YAML::Node node;
+    node["file"] = file_;
+    node["cycle"] = cycle_;
+    node["convert_byte_order"] = convert_byte_order_;
+    return node;
+}
+
+PackedFileSource *PackedFileSource::from_yaml(const YAML::Node node) {
+    return new PackedFileSource(node["file"].as<std::string>(),
+                                node["cycle"].as<bool>(false),
+                                node["convert_byte_order"].as<bool>(true));
+}
@@ -0,0 +1,72 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "datasource.hpp"
+#include "utilities/samplecodec.hpp"
+
+// Replays a multichannel stream that was recorded by FileSerializer with the
+// packed encoding (format full, with preamble) as Neuralynx packets. Samples
+// are converted back to AD counts with the Neuralynx AD bit value, except for
+// int16 recordings, which already hold AD counts.
+class PackedFileSource : public DataSource {
+  public:
+    PackedFileSource(std::string file, bool cycle,
+                     bool convert_byte_order = true);
+
+    std::string string() override;
+    int64_t Produce(char **data) override;
+    YAML::Node to_yaml() const override;
+
+    static PackedFileSource *from_yaml(YAML::Node node);
+    std::string file() const;
+
+  protected:
+    void ReadPreamble();
+    // read and decode the next record, returns false at the end of the file
+    bool ReadRecord();
+    template <typename T> bool DecodeRecord();
+
+  protected:
+    std::string file_;
+    bool cycle_;
+    bool convert_byte_order_;
+    std::ifstream stream_;
+    std::streampos data_start_;
+
+    std::string sample_type_;
+    double sample_scale_ = 1.0; // value of one sample in microvolts
+    unsigned int nchannels_ = 0;
+    unsigned int nsamples_ = 0;
+    std::size_t header_size_ = 0;
+
+    SampleBlockDecoder decoder_;
+    std::vector<uint8_t> block_;
+    std::vector<double> samples_;
+    std::vector<uint64_t> timestamps_;
+    unsigned int next_sample_ = 0;
+
+    std::vector<int32_t> counts_;
+    std::vector<char> buffer_;
+};
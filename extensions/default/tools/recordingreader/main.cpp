@@ -0,0 +1,124 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "cmdline/cmdline.h"
+#include "recordingreader.hpp"
+
+void print_info(const RecordingReader &reader) {
+    if (reader.preamble()) {
+        std::cout << reader.preamble() << std::endl << "---" << std::endl;
+    }
+    std::cout << "chunks: " << reader.nchunks() << std::endl;
+    std::cout << "records: " << reader.nrecords() << std::endl;
+    if (reader.nchunks() > 0) {
+        std::cout << "timestamps: " << reader.chunk_info(0).first_timestamp
+                  << " - "
+                  << reader.chunk_info(reader.nchunks() - 1).last_timestamp
+                  << std::endl;
+    }
+}
+
+void print_chunks(const RecordingReader &reader) {
+    std::cout << "chunk\toffset\tpackets\trecords\ttimestamps" << std::endl;
+    for (std::size_t k = 0; k < reader.nchunks(); ++k) {
+        auto &info = reader.chunk_info(k);
+        std::cout << k << "\t" << info.offset << "\t" << info.first_packet
+                  << "\t" << info.nrecords << "\t" << info.first_timestamp
+                  << " - " << info.last_timestamp << std::endl;
+    }
+}
+
+// list (and optionally save) n records, starting at the first record with a
+// timestamp not smaller than the given timestamp
+void read_records(const RecordingReader &reader, uint64_t timestamp,
+                  uint64_t n, const std::string &output) {
+    std::ofstream out;
+    if (!output.empty()) {
+        out.open(output, std::ios::out | std::ios::binary);
+        if (!out) {
+            throw std::runtime_error("Unable to open " + output + ".");
+        }
+    }
+
+    std::size_t chunk = reader.FindChunk(timestamp);
+    if (chunk == reader.nchunks()) {
+        std::cout << "No records at or after timestamp " << timestamp << "."
+                  << std::endl;
+        return;
+    }
+
+    std::cout << "chunk\trecord\tpacket\ttimestamp\tsize" << std::endl;
+    for (; chunk < reader.nchunks() && n > 0; ++chunk) {
+        RecordingChunk records = reader.ReadChunk(chunk);
+        for (std::size_t k = records.Find(timestamp);
+             k < records.nrecords() && n > 0; ++k, --n) {
+            std::cout << chunk << "\t" << k << "\t" << records.packet(k)
+                      << "\t" << records.timestamp(k) << "\t"
+                      << records.size(k) << std::endl;
+            if (out.is_open()) {
+                out.write(records.data(k), records.size(k));
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    cmdline::parser parser;
+
+    parser.add<uint64_t>("timestamp", 't',
+                         "list records from this hardware timestamp on",
+                         false, 0);
+    parser.add<uint64_t>("nrecords", 'n', "number of records to list", false,
+                         10);
+    parser.add<std::string>(
+        "output", 'o', "save the serialized data of listed records to file",
+        false, "");
+    parser.add("chunks", 'c', "list the chunk index");
+    parser.footer("recording_file");
+
+    parser.parse_check(argc, argv);
+
+    if (parser.rest().size() != 1) {
+        std::cout << parser.usage() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        RecordingReader reader(parser.rest()[0]);
+
+        if (parser.exist("chunks")) {
+            print_chunks(reader);
+        } else if (parser.exist("timestamp")) {
+            read_records(reader, parser.get<uint64_t>("timestamp"),
+                         parser.get<uint64_t>("nrecords"),
+                         parser.get<std::string>("output"));
+        } else {
+            print_info(reader);
+        }
+    } catch (std::exception &e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
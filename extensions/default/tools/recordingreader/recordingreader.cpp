@@ -0,0 +1,210 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "recordingreader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+template <typename T> T load(const char *p, std::size_t index) {
+    T value;
+    memcpy(&value, p + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+void read_exact(int fd, void *buffer, std::size_t n, uint64_t offset,
+                const std::string &filename) {
+    char *p = static_cast<char *>(buffer);
+    while (n > 0) {
+        ssize_t rc = pread(fd, p, n, offset);
+        if (rc <= 0) {
+            throw std::runtime_error("Unable to read " + filename + ".");
+        }
+        p += rc;
+        n -= rc;
+        offset += rc;
+    }
+}
+
+} // namespace
+
+RecordingChunk::RecordingChunk(int fd, uint64_t offset, uint64_t size) {
+    // mappings have to start at a page boundary
+    uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t start = offset / page_size * page_size;
+    map_size_ = offset - start + size;
+    map_ = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, start);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        throw std::runtime_error(std::string("Unable to map chunk: ") +
+                                 strerror(errno));
+    }
+    madvise(map_, map_size_, MADV_WILLNEED);
+
+    const char *base = static_cast<const char *>(map_) + (offset - start);
+    memcpy(&header_, base, sizeof(header_));
+    uint64_t columns =
+        header_.nrecords * (2 * sizeof(uint64_t) + sizeof(uint32_t));
+    if (memcmp(header_.magic, CHUNK_MAGIC, sizeof(header_.magic)) != 0 ||
+        sizeof(header_) + columns + header_.data_size != size) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+        throw std::runtime_error("Corrupt chunk header.");
+    }
+
+    packets_ = base + sizeof(header_);
+    timestamps_ = packets_ + header_.nrecords * sizeof(uint64_t);
+    offsets_ = timestamps_ + header_.nrecords * sizeof(uint64_t);
+    data_ = offsets_ + header_.nrecords * sizeof(uint32_t);
+}
+
+RecordingChunk::RecordingChunk(RecordingChunk &&other)
+    : map_(other.map_), map_size_(other.map_size_), header_(other.header_),
+      packets_(other.packets_), timestamps_(other.timestamps_),
+      offsets_(other.offsets_), data_(other.data_) {
+    other.map_ = nullptr;
+}
+
+RecordingChunk::~RecordingChunk() {
+    if (map_ != nullptr) {
+        munmap(map_, map_size_);
+    }
+}
+
+uint64_t RecordingChunk::packet(std::size_t record) const {
+    return load<uint64_t>(packets_, record);
+}
+
+uint64_t RecordingChunk::timestamp(std::size_t record) const {
+    return load<uint64_t>(timestamps_, record);
+}
+
+uint32_t RecordingChunk::offset(std::size_t record) const {
+    return load<uint32_t>(offsets_, record);
+}
+
+const char *RecordingChunk::data(std::size_t record) const {
+    return data_ + offset(record);
+}
+
+std::size_t RecordingChunk::size(std::size_t record) const {
+    uint64_t end = record + 1 < header_.nrecords ? offset(record + 1)
+                                                  : header_.data_size;
+    return end - offset(record);
+}
+
+std::size_t RecordingChunk::Find(uint64_t timestamp) const {
+    std::size_t first = 0;
+    std::size_t count = header_.nrecords;
+    while (count > 0) {
+        std::size_t step = count / 2;
+        if (this->timestamp(first + step) < timestamp) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+RecordingReader::RecordingReader(const std::string &filename)
+    : filename_(filename) {
+    fd_ = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        throw std::runtime_error("Unable to open " + filename + ": " +
+                                 strerror(errno));
+    }
+
+    try {
+        struct stat st;
+        if (fstat(fd_, &st) != 0 ||
+            static_cast<uint64_t>(st.st_size) < sizeof(ChunkFooter)) {
+            throw std::runtime_error(filename + " is not a chunked recording.");
+        }
+        uint64_t file_size = st.st_size;
+
+        ChunkFooter footer;
+        read_exact(fd_, &footer, sizeof(footer), file_size - sizeof(footer),
+                   filename);
+        uint64_t index_size = footer.nchunks * sizeof(ChunkIndexEntry);
+        if (memcmp(footer.magic, CHUNK_INDEX_MAGIC, sizeof(footer.magic)) !=
+                0 ||
+            footer.version != CHUNKED_RECORDING_VERSION ||
+            index_size + sizeof(footer) > file_size ||
+            footer.index_offset > file_size - sizeof(footer) - index_size) {
+            throw std::runtime_error(
+                filename + " is not a chunked recording or is incomplete.");
+        }
+
+        uint64_t index_start = file_size - sizeof(footer) - index_size;
+        start_ = index_start - footer.index_offset;
+        chunks_end_ = footer.index_offset;
+        index_.resize(footer.nchunks);
+        read_exact(fd_, index_.data(), index_size, index_start, filename);
+
+        if (start_ > 0) {
+            std::string text(start_, '\0');
+            read_exact(fd_, &text[0], start_, 0, filename);
+            preamble_ = YAML::Load(text);
+        }
+    } catch (...) {
+        close(fd_);
+        throw;
+    }
+}
+
+RecordingReader::~RecordingReader() { close(fd_); }
+
+uint64_t RecordingReader::nrecords() const {
+    uint64_t n = 0;
+    for (auto &it : index_) {
+        n += it.nrecords;
+    }
+    return n;
+}
+
+std::size_t RecordingReader::FindChunk(uint64_t timestamp) const {
+    // first chunk that ends at or after the timestamp
+    auto it = std::lower_bound(index_.begin(), index_.end(), timestamp,
+                               [](const ChunkIndexEntry &entry, uint64_t t) {
+                                   return entry.last_timestamp < t;
+                               });
+    return it - index_.begin();
+}
+
+RecordingChunk RecordingReader::ReadChunk(std::size_t chunk) const {
+    const ChunkIndexEntry &entry = index_.at(chunk);
+    // the last chunk ends where the index starts
+    uint64_t end =
+        chunk + 1 < index_.size() ? index_[chunk + 1].offset : chunks_end_;
+    if (entry.offset >= end) {
+        throw std::runtime_error("Corrupt index in " + filename_ + ".");
+    }
+    return RecordingChunk(fd_, start_ + entry.offset, end - entry.offset);
+}
@@ -0,0 +1,100 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "utilities/chunkedrecording.hpp"
+#include "yaml-cpp/yaml.h"
+
+// Records of a single chunk, mapped into memory.
+class RecordingChunk {
+  public:
+    RecordingChunk(int fd, uint64_t offset, uint64_t size);
+    ~RecordingChunk();
+
+    RecordingChunk(RecordingChunk &&other);
+    RecordingChunk(const RecordingChunk &) = delete;
+    RecordingChunk &operator=(const RecordingChunk &) = delete;
+
+    uint32_t nrecords() const { return header_.nrecords; }
+    uint64_t first_timestamp() const { return header_.first_timestamp; }
+    uint64_t last_timestamp() const { return header_.last_timestamp; }
+
+    uint64_t packet(std::size_t record) const;
+    uint64_t timestamp(std::size_t record) const;
+
+    // serialized data of a record
+    const char *data(std::size_t record) const;
+    std::size_t size(std::size_t record) const;
+
+    // index of the first record with a timestamp not smaller than the given
+    // timestamp, or nrecords() if there is none (binary search, assumes
+    // increasing timestamps)
+    std::size_t Find(uint64_t timestamp) const;
+
+  protected:
+    uint32_t offset(std::size_t record) const;
+
+  protected:
+    void *map_ = nullptr;
+    std::size_t map_size_ = 0;
+    ChunkHeader header_;
+    const char *packets_;
+    const char *timestamps_;
+    const char *offsets_;
+    const char *data_;
+};
+
+// Random access reader for chunked recordings written by FileSerializer. The
+// index is loaded when the file is opened; chunks are mapped on demand.
+class RecordingReader {
+  public:
+    explicit RecordingReader(const std::string &filename);
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader &) = delete;
+    RecordingReader &operator=(const RecordingReader &) = delete;
+
+    // YAML preamble (null if the recording has none)
+    const YAML::Node &preamble() const { return preamble_; }
+
+    std::size_t nchunks() const { return index_.size(); }
+    const ChunkIndexEntry &chunk_info(std::size_t chunk) const {
+        return index_.at(chunk);
+    }
+    uint64_t nrecords() const;
+
+    // index of the chunk that holds the first record with a timestamp not
+    // smaller than the given timestamp, or nchunks() if there is none
+    std::size_t FindChunk(uint64_t timestamp) const;
+
+    RecordingChunk ReadChunk(std::size_t chunk) const;
+
+  protected:
+    std::string filename_;
+    int fd_ = -1;
+    uint64_t start_ = 0;      // file offset of the first chunk
+    uint64_t chunks_end_ = 0; // end of the last chunk relative to start_
+    YAML::Node preamble_;
+    std::vector<ChunkIndexEntry> index_;
+};
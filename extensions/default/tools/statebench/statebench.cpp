@@ -0,0 +1,177 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-core.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-core. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+// Microbenchmark of shared state reads. A number of reader threads
+// repeatedly read a state, while a writer thread optionally updates the
+// state as fast as it can. Reports the average cost of a single read for
+// the lock-free ReadableState (single atomic word and sequence lock), and
+// for a read that takes a spin lock around an atomic load, as shared states
+// used to do.
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cmdline/cmdline.h"
+#include "sharedstate.hpp"
+#include "utilities/time.hpp"
+
+// state that locks around every access, as a reference
+template <typename T> class LockedState {
+  public:
+    LockedState(T value) : value_(value) {}
+
+    T get() {
+        lock();
+        T value = value_;
+        unlock();
+        return value;
+    }
+
+    void set(T value) {
+        lock();
+        value_ = value;
+        unlock();
+    }
+
+  protected:
+    void lock() {
+        while (lock_.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+    void unlock() { lock_.clear(std::memory_order_release); }
+
+    T value_;
+    std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+};
+
+// expose the protected set method of a ReadableState, like a peer
+// WritableState would
+template <typename T> class Writer : public WritableState<T> {
+  public:
+    using WritableState<T>::WritableState;
+};
+
+template <typename STATE, typename T>
+double benchmark(std::string label, STATE &state, unsigned int nreaders,
+                 uint64_t nreads, bool writer) {
+    std::atomic<bool> stop(false);
+    std::atomic<unsigned int> ready(0);
+    std::vector<std::thread> readers;
+    std::vector<double> sums(nreaders, 0.);
+
+    std::thread writer_thread;
+    uint64_t nwrites = 0;
+    if (writer) {
+        writer_thread = std::thread([&]() {
+            T value = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                state.set(value);
+                value = value + 1;
+                ++nwrites;
+            }
+        });
+    }
+
+    auto start = Clock::now();
+
+    for (unsigned int r = 0; r < nreaders; ++r) {
+        readers.emplace_back([&, r]() {
+            ++ready;
+            while (ready.load() < nreaders) {
+            }
+            double sum = 0;
+            for (uint64_t k = 0; k < nreads; ++k) {
+                sum += static_cast<double>(state.get());
+            }
+            sums[r] = sum;
+        });
+    }
+
+    for (auto &it : readers) {
+        it.join();
+    }
+
+    auto stop_time = Clock::now();
+    stop.store(true);
+    if (writer_thread.joinable()) {
+        writer_thread.join();
+    }
+
+    double ns_per_read =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start)
+            .count() /
+        static_cast<double>(nreads);
+
+    std::cout << std::left << std::setw(40) << label << std::right
+              << std::fixed << std::setprecision(2) << std::setw(10)
+              << ns_per_read << " ns/read";
+    if (writer) {
+        std::cout << "  (" << nwrites << " writes)";
+    }
+    std::cout << std::endl;
+
+    return ns_per_read;
+}
+
+template <typename T>
+void run(std::string type, unsigned int nreaders, uint64_t nreads,
+         bool writer) {
+    LockedState<T> locked(0);
+    Writer<T> lockfree(0);
+
+    benchmark<LockedState<T>, T>("locked " + type, locked, nreaders, nreads,
+                                 writer);
+    benchmark<Writer<T>, T>(
+        std::string(std::atomic<T>::is_always_lock_free ? "atomic "
+                                                        : "seqlock ") +
+            type,
+        lockfree, nreaders, nreads, writer);
+}
+
+int main(int argc, char **argv) {
+    cmdline::parser parser;
+
+    parser.add<unsigned int>("readers", 'r', "number of reader threads", false,
+                             1);
+    parser.add<uint64_t>("nreads", 'n', "number of reads per reader", false,
+                         10000000);
+    parser.add("no_writer", 'x', "do not update the state while reading");
+
+    parser.parse_check(argc, argv);
+
+    unsigned int nreaders = parser.get<unsigned int>("readers");
+    uint64_t nreads = parser.get<uint64_t>("nreads");
+    bool writer = !parser.exist("no_writer");
+
+    std::cout << nreaders << " reader thread(s), " << nreads
+              << " reads per thread, "
+              << (writer ? "with" : "without") << " concurrent writer"
+              << std::endl;
+
+    run<bool>("bool", nreaders, nreads, writer);
+    run<double>("double", nreaders, nreads, writer);
+    run<long double>("long double", nreaders, nreads, writer);
+
+    return EXIT_SUCCESS;
+}